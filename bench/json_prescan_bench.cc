@@ -0,0 +1,93 @@
+/**
+ * Measures prescanJson() at each JsonScanLevel against a full jsoncpp parse of the same
+ * body, for a ~100 KB bulk array and for a hostile body (valid up to a bad byte near
+ * the end) that the prescan refuses and the parser only refuses after building most of
+ * the document.
+ *
+ * Usage: json_prescan_bench [iterations]
+ */
+
+#include <json/json.h>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include "utils/jsonprescan.h"
+
+namespace {
+std::string productJson(size_t i) {
+    return "{\"sku\":\"SKU-" + std::to_string(100000 + i) + "\",\"name\":\"Product " +
+           std::to_string(i) + "\",\"description\":\"A sturdy widget, in stock and ready\"," +
+           "\"category\":\"Electronics\",\"unit_price\":19.99,\"quantity_in_stock\":" +
+           std::to_string(i % 500) + ",\"reorder_threshold\":20,\"supplier_id\":1}";
+}
+
+std::string makeArray(size_t bytes) {
+    std::string body = "[" + productJson(0);
+    for (size_t i = 1; body.size() < bytes; ++i) {
+        body += ',';
+        body += productJson(i);
+    }
+    body += ']';
+    return body;
+}
+
+template <typename F>
+double megabytesPerSecond(size_t iterations, size_t bytes, F&& fn) {
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        fn();
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(iterations * bytes) / elapsed.count() / 1e6;
+}
+
+void run(const std::string& label, const std::string& body, size_t iterations) {
+    size_t sink = 0;
+    std::cout << label << " (" << body.size() << " bytes)\n";
+    const struct {
+        const char* name;
+        JsonScanLevel level;
+    } levels[] = {{"best", JsonScanLevel::Best},
+                  {"sse2", JsonScanLevel::Sse2},
+                  {"scalar", JsonScanLevel::Scalar}};
+    for (const auto& level : levels) {
+        JsonPrescanOptions options;
+        options.level = level.level;
+        JsonPrescan result;
+        const double rate = megabytesPerSecond(iterations, body.size(), [&]() {
+            sink += prescanJson(body, result, options) ? result.depth : result.errorOffset;
+        });
+        std::cout << "  prescan " << level.name << ": " << static_cast<uint64_t>(rate)
+                  << " MB/s\n";
+    }
+
+    Json::CharReaderBuilder builder;
+    std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+    const double parseRate = megabytesPerSecond(iterations, body.size(), [&]() {
+        Json::Value json;
+        std::string errors;
+        reader->parse(body.data(), body.data() + body.size(), &json, &errors);
+        sink += json.size() + errors.size();
+    });
+    std::cout << "  jsoncpp parse: " << static_cast<uint64_t>(parseRate) << " MB/s (checksum "
+              << sink << ")\n";
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    const size_t iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000;
+    const std::string valid = makeArray(100 * 1024);
+    JsonPrescan check;
+    if (!prescanJson(valid, check)) {
+        std::cerr << "benchmark body refused: " << check.error << std::endl;
+        return 1;
+    }
+    // A control character in the last string, after the rest of the array
+    std::string hostile = valid;
+    hostile[hostile.size() - 10] = '\x01';
+    run("valid bulk array", valid, iterations);
+    run("bad byte near the end", hostile, iterations);
+    return 0;
+}
@@ -0,0 +1,119 @@
+/**
+ * Compares Products::toJson() + jsoncpp serialization against the generated
+ * direct-to-buffer writer for the two shapes the API produces: a list page and a
+ * single product.
+ *
+ * Usage: json_writer_bench [rows]
+ */
+
+#include <json/json.h>
+#include <trantor/utils/Date.h>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "models/ModelJsonWriters.h"
+#include "utils/jsonwriter.h"
+
+using drogon_model::sqlite3::Products;
+
+namespace {
+std::vector<Products> makeProducts(size_t count) {
+    std::vector<Products> products;
+    products.reserve(count);
+    const auto now = trantor::Date::now();
+    for (size_t i = 0; i < count; ++i) {
+        Products p;
+        p.setProductId(static_cast<int64_t>(i + 1));
+        p.setSku("SKU-" + std::to_string(100000 + i));
+        p.setName("Product \"" + std::to_string(i) + "\"");
+        if (i % 3 != 0) {
+            p.setDescription("Line one\nLine two with unicode \xC3\xA9 and a tab\t");
+        }
+        p.setCategory(i % 2 ? "Electronics" : "Office");
+        p.setUnitPrice(9.99 + static_cast<double>(i % 1000));
+        p.setQuantityInStock(static_cast<int64_t>(i % 500));
+        p.setReorderThreshold(20);
+        p.setSupplierId(1);
+        if (i % 5 != 0) {
+            p.setWarehouseId(2);
+        }
+        p.setCreatedAt(now);
+        p.setUpdatedAt(now);
+        products.push_back(std::move(p));
+    }
+    return products;
+}
+
+Json::StreamWriterBuilder drogonWriterBuilder() {
+    // Same settings drogon applies in newHttpJsonResponse()
+    Json::StreamWriterBuilder builder;
+    builder["commentStyle"] = "None";
+    builder["indentation"] = "";
+    builder["emitUTF8"] = true;
+    return builder;
+}
+
+template <typename F>
+double rowsPerSecond(size_t rows, F&& fn) {
+    const auto start = std::chrono::steady_clock::now();
+    fn();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(rows) / elapsed.count();
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    const size_t rows = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    const auto products = makeProducts(rows);
+    const auto builder = drogonWriterBuilder();
+
+    // Sanity check: both paths must agree byte for byte
+    std::string direct;
+    appendJsonArray(direct, products);
+    Json::Value array(Json::arrayValue);
+    for (const auto& p : products) {
+        array.append(p.toJson());
+    }
+    if (direct != Json::writeString(builder, array)) {
+        std::cerr << "MISMATCH between appendJson() and toJson() output" << std::endl;
+        return 1;
+    }
+
+    size_t sink = 0;
+    const double listJsonValue = rowsPerSecond(rows, [&]() {
+        Json::Value page(Json::arrayValue);
+        for (const auto& p : products) {
+            page.append(p.toJson());
+        }
+        sink += Json::writeString(builder, page).size();
+    });
+    std::string buffer;
+    const double listDirect = rowsPerSecond(rows, [&]() {
+        buffer.clear();
+        appendJsonArray(buffer, products);
+        sink += buffer.size();
+    });
+    const double oneJsonValue = rowsPerSecond(rows, [&]() {
+        for (const auto& p : products) {
+            sink += Json::writeString(builder, p.toJson()).size();
+        }
+    });
+    const double oneDirect = rowsPerSecond(rows, [&]() {
+        for (const auto& p : products) {
+            buffer.clear();
+            appendJson(buffer, p);
+            sink += buffer.size();
+        }
+    });
+
+    std::cout << "rows: " << rows << " (checksum " << sink << ")\n";
+    std::cout << "list   toJson+jsoncpp: " << static_cast<uint64_t>(listJsonValue) << " rows/s\n";
+    std::cout << "list   appendJson:     " << static_cast<uint64_t>(listDirect) << " rows/s ("
+              << listDirect / listJsonValue << "x)\n";
+    std::cout << "getOne toJson+jsoncpp: " << static_cast<uint64_t>(oneJsonValue) << " rows/s\n";
+    std::cout << "getOne appendJson:     " << static_cast<uint64_t>(oneDirect) << " rows/s ("
+              << oneDirect / oneJsonValue << "x)\n";
+    return 0;
+}
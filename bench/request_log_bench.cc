@@ -0,0 +1,118 @@
+/**
+ * Measures what request logging adds to the validation path: the pre-routing work
+ * (route classification, one parse, field checks) for a ~600 byte POST /api/products
+ * body with no logging, with one RequestLog record per request, and with the synchronous
+ * LOG_INFO lines the validation used to write (up to six per request, to a file).
+ * Several threads log at once, as drogon's IO threads do.
+ *
+ * Usage: request_log_bench [requests per thread] [threads]
+ */
+
+#include <drogon/HttpRequest.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "models/ModelFieldRules.h"
+#include "plugins/RequestLog.h"
+#include "utils/requestjson.h"
+
+namespace {
+const std::string kBody =
+    "{\"sku\":\"SKU-100001\",\"name\":\"Product 1\",\"description\":\"" + std::string(450, 'd') +
+    "\",\"category\":\"Electronics\",\"unit_price\":19.99,\"quantity_in_stock\":20," +
+    "\"reorder_threshold\":20,\"supplier_id\":1,\"warehouse_id\":2}";
+
+enum class Mode { None, RingBuffer, Synchronous };
+
+/// Stand-in for a synchronous logger: format a line and write it under a lock
+struct SyncLog {
+    std::mutex mutex;
+    std::ofstream out{"request_log_bench_sync.log"};
+
+    void line(const std::string& text) {
+        std::lock_guard<std::mutex> lock(mutex);
+        out << text << '\n';
+        out.flush();
+    }
+};
+
+size_t validate(const drogon::HttpRequestPtr& req, Mode mode, RequestLog& log, SyncLog& sync) {
+    const auto kind = classifyRoute(req->getPath()).kind;
+    if (mode == Mode::Synchronous) {
+        sync.line("Validating POST " + req->getPath());
+        sync.line("Request body: " + std::to_string(req->getBody().size()) + " bytes");
+    }
+    const auto json = parseJsonBody(req->getBody());
+    std::string error;
+    const bool valid = json && validateFields(drogon_model::sqlite3::kProductsFieldRules, *json,
+                                              FieldCheck::Create, error);
+    if (mode == Mode::RingBuffer) {
+        log.write(RequestLogLevel::Info, RequestLogEvent::Passed, req, kind, 0);
+    } else if (mode == Mode::Synchronous) {
+        sync.line("Validating product creation data");
+        sync.line(valid ? "Validation passed" : "Validation failed: " + error);
+    }
+    return valid ? json->size() : 0;
+}
+
+double requestsPerSecond(Mode mode, size_t perThread, size_t threads, RequestLog& log,
+                         SyncLog& sync) {
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&]() {
+            auto req = drogon::HttpRequest::newHttpRequest();
+            req->setMethod(drogon::Post);
+            req->setPath("/api/products");
+            req->setBody(kBody);
+            size_t sink = 0;
+            for (size_t i = 0; i < perThread; ++i) {
+                sink += validate(req, mode, log, sync);
+            }
+            if (sink == 0) {
+                std::cerr << "benchmark body failed validation" << std::endl;
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(perThread * threads) / elapsed.count();
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    const size_t perThread = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 50000;
+    const size_t threads = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 4;
+
+    Json::Value config;
+    config["log_path"] = "request_log_bench.log";
+    config["capacity"] = 65536;
+    config["flush_interval_ms"] = 20;
+    RequestLog log;
+    log.initAndStart(config);
+    SyncLog sync;
+
+    const double none = requestsPerSecond(Mode::None, perThread, threads, log, sync);
+    const double ring = requestsPerSecond(Mode::RingBuffer, perThread, threads, log, sync);
+    const double synchronous = requestsPerSecond(Mode::Synchronous, perThread, threads, log, sync);
+    log.shutdown();
+
+    std::cout << threads << " threads, " << kBody.size() << " byte body\n";
+    std::cout << "  no logging:       " << static_cast<uint64_t>(none) << " requests/s\n";
+    std::cout << "  RequestLog:       " << static_cast<uint64_t>(ring) << " requests/s ("
+              << 100.0 * (none - ring) / none << "% slower)\n";
+    std::cout << "  synchronous logs: " << static_cast<uint64_t>(synchronous) << " requests/s ("
+              << 100.0 * (none - synchronous) / none << "% slower)\n";
+    std::cout << "  " << log.stats().toStyledString();
+    std::remove("request_log_bench.log");
+    std::remove("request_log_bench_sync.log");
+    return 0;
+}
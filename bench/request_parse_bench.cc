@@ -0,0 +1,108 @@
+/**
+ * Compares the three JSON parses a POST /api/products body used to go through
+ * (validateProductRequest's Json::Reader, ValidationMiddleware's CharReaderBuilder and
+ * the controller's getJsonObject()) against one parseRequestBody() whose document the
+ * later stages read back with requestJson(). Bodies of about 1 KB (one product) and
+ * 100 KB (a bulk array) are measured.
+ *
+ * Usage: request_parse_bench [iterations]
+ */
+
+#include <drogon/HttpRequest.h>
+#include <json/json.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include "utils/requestjson.h"
+
+namespace {
+std::string productJson(size_t i) {
+    return "{\"sku\":\"SKU-" + std::to_string(100000 + i) + "\",\"name\":\"Product " +
+           std::to_string(i) + "\",\"description\":\"" + std::string(850, 'd') +
+           "\",\"category\":\"Electronics\",\"unit_price\":19.99,\"quantity_in_stock\":" +
+           std::to_string(i % 500) + ",\"reorder_threshold\":20,\"supplier_id\":1," +
+           "\"warehouse_id\":2}";
+}
+
+/// One product for ~1 KB, or an array of them reaching @p bytes
+std::string makeBody(size_t bytes) {
+    std::string body = productJson(0);
+    if (body.size() >= bytes) {
+        return body;
+    }
+    body = "[" + body;
+    for (size_t i = 1; body.size() < bytes; ++i) {
+        body += ',';
+        body += productJson(i);
+    }
+    body += ']';
+    return body;
+}
+
+drogon::HttpRequestPtr makeRequest(const std::string& body) {
+    auto req = drogon::HttpRequest::newHttpRequest();
+    req->setMethod(drogon::Post);
+    req->setPath("/api/products");
+    req->setContentTypeCode(drogon::CT_APPLICATION_JSON);
+    req->setBody(body);
+    return req;
+}
+
+template <typename F>
+double requestsPerSecond(size_t iterations, F&& fn) {
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        fn();
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(iterations) / elapsed.count();
+}
+
+void run(const std::string& label, const std::string& body, size_t iterations) {
+    size_t sink = 0;
+    // A fresh request each time, since getJsonObject() and the attribute both cache
+    const double threeParses = requestsPerSecond(iterations, [&]() {
+        auto req = makeRequest(body);
+        const auto view = req->getBody();
+
+        Json::Value first;
+        Json::Reader reader;
+        reader.parse(std::string(view.data(), view.size()), first);
+
+        Json::Value second;
+        Json::CharReaderBuilder builder;
+        std::unique_ptr<Json::CharReader> charReader(builder.newCharReader());
+        std::string errors;
+        charReader->parse(view.data(), view.data() + view.size(), &second, &errors);
+
+        sink += first.size() + second.size() + req->getJsonObject()->size();
+    });
+    const double oneParse = requestsPerSecond(iterations, [&]() {
+        auto req = makeRequest(body);
+        sink += parseRequestBody(req)->size();
+        sink += requestJson(req)->size();
+        sink += requestJson(req)->size();
+    });
+
+    std::cout << label << " (" << body.size() << " bytes, checksum " << sink << ")\n";
+    std::cout << "  three parses: " << static_cast<uint64_t>(threeParses) << " requests/s\n";
+    std::cout << "  one parse:    " << static_cast<uint64_t>(oneParse) << " requests/s ("
+              << oneParse / threeParses << "x)\n";
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    const size_t iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+    const std::string small = makeBody(1024);
+    const std::string large = makeBody(100 * 1024);
+    if (!parseJsonBody(small) || !parseJsonBody(large)) {
+        std::cerr << "benchmark bodies are not valid JSON" << std::endl;
+        return 1;
+    }
+    run("1 KB body", small, iterations);
+    run("100 KB body", large, std::max<size_t>(1, iterations / 100));
+    return 0;
+}
@@ -0,0 +1,82 @@
+/**
+ * Compares the per-request route checks ValidationMiddleware used to run (a
+ * std::regex built and matched in isIdEndpoint(), validateId() and isUpdateEndpoint())
+ * against one classifyRoute() pass over the same paths.
+ *
+ * Usage: route_classifier_bench [requests]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <regex>
+#include <string>
+#include <vector>
+#include "utils/routeclassifier.h"
+
+namespace {
+const std::vector<std::string> kPaths = {
+    "/api/products",
+    "/api/products/42",
+    "/api/products/1234567/",
+    "/api/products/42/adjust",
+    "/api/products/reservations/77/commit",
+    "/api/products:batchGet",
+    "/api/suppliers/3",
+    "/api/purchase_orders",
+};
+
+// The checks as they were, each building its pattern on every call
+bool regexIsIdEndpoint(const std::string& path) {
+    std::regex idPattern("^/api/products/\\d+/?$");
+    return std::regex_match(path, idPattern);
+}
+
+bool regexValidateId(const std::string& id) {
+    std::regex idPattern("^[1-9]\\d*$");
+    return std::regex_match(id, idPattern) && id.length() <= 10;
+}
+
+bool regexIsUpdateEndpoint(const std::string& path) {
+    std::regex updatePattern("^/api/products/\\d+/?$");
+    return std::regex_match(path, updatePattern);
+}
+
+template <typename F>
+double nanosPerRequest(size_t requests, F&& fn) {
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < requests; ++i) {
+        fn(kPaths[i % kPaths.size()]);
+    }
+    const std::chrono::duration<double, std::nano> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count() / static_cast<double>(requests);
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    const size_t requests = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+
+    size_t sink = 0;
+    const double regexNs = nanosPerRequest(requests, [&](const std::string& path) {
+        if (regexIsIdEndpoint(path)) {
+            const size_t slash = path.find_last_of('/', path.size() - 2);
+            std::string id = path.substr(slash + 1);
+            if (!id.empty() && id.back() == '/') {
+                id.pop_back();
+            }
+            sink += regexValidateId(id);
+        }
+        sink += regexIsUpdateEndpoint(path);
+    });
+    const double classifierNs = nanosPerRequest(requests, [&](const std::string& path) {
+        const RouteMatch match = classifyRoute(path);
+        sink += static_cast<size_t>(match.kind) + static_cast<size_t>(match.id);
+    });
+
+    std::cout << "requests: " << requests << " (checksum " << sink << ")\n";
+    std::cout << "std::regex per check: " << regexNs << " ns/request\n";
+    std::cout << "classifyRoute():      " << classifierNs << " ns/request ("
+              << regexNs / classifierNs << "x)\n";
+    return 0;
+}
@@ -8,70 +8,2080 @@
 #include "ProductsController.h"
 #include <drogon/orm/Exception.h>
 #include <drogon/orm/Mapper.h>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <cstdio>
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
+#include "db/productinsert.h"
+#include "models/ModelFieldRules.h"
+#include "models/ModelJsonWriters.h"
 #include "models/Products.h"
+#include "plugins/IdempotencyStore.h"
+#include "plugins/LowStockIndex.h"
+#include "plugins/ProductCache.h"
+#include "plugins/ResponseCache.h"
+#include "plugins/StockDeltaBuffer.h"
+#include "plugins/StockReservations.h"
+#include "plugins/WriteCoalescer.h"
+#include "utils/jsonwriter.h"
+#include "utils/pagination.h"
+#include "utils/projection.h"
+#include "utils/requestjson.h"
+#include "utils/rowversion.h"
+#include "validation.h"
+
+namespace {
+/// Rows fetched per keyset query while streaming an export
+constexpr size_t kExportChunkRows = 500;
+
+/// Keys per IN (...) query of a batch get, well under SQLite's bound parameter limit
+constexpr size_t kBatchGetChunkKeys = 500;
+
+/// Largest "adjustments" array accepted by POST /api/products/adjust
+constexpr size_t kMaxBatchAdjustments = 1000;
+
+/// Largest |delta| of one stock adjustment; keeps quantity arithmetic far from overflow
+constexpr int64_t kMaxStockDelta = 1000000000;
+
+/**
+ * Apply a stock delta in one statement. The guard makes an oversell impossible without
+ * reading the row first: concurrent adjustments serialize on the write and each sees
+ * the quantity the previous one left. Binds: delta, product_id, and delta plus the
+ * product's guardPendingStock(), which the stored quantity does not include yet.
+ */
+constexpr const char* kAdjustStockSql =
+    "update products set quantity_in_stock = quantity_in_stock + ?, "
+    "updated_at = CURRENT_TIMESTAMP, version = version + 1 "
+    "where product_id = ? and quantity_in_stock + ? >= 0 returning *";
+
+/// Rough per-row size used to pre-size list bodies
+constexpr size_t kProductJsonSizeHint = 320;
+
+enum class ExportFormat { NdJson, Csv };
+
+/// Wrap an already-serialized JSON body; same headers as newHttpJsonResponse()
+HttpResponsePtr newJsonBodyResponse(std::string&& body, HttpStatusCode code) {
+    auto resp = HttpResponse::newHttpResponse();
+    resp->setStatusCode(code);
+    resp->setContentTypeCode(CT_APPLICATION_JSON);
+    resp->setBody(std::move(body));
+    return resp;
+}
+
+/// The read-through cache, or nullptr when the plugin is not enabled in config.json
+ProductCache* productCache() {
+    static ProductCache* cache = drogon::app().getPlugin<ProductCache>();
+    return cache;
+}
+
+/// The versioned body cache, or nullptr when the plugin is not enabled in config.json
+ResponseCache* responseCache() {
+    static ResponseCache* cache = drogon::app().getPlugin<ResponseCache>();
+    return cache;
+}
+
+/// The low-stock watchlist, or nullptr when the plugin is not enabled in config.json
+LowStockIndex* lowStockIndex() {
+    static LowStockIndex* index = drogon::app().getPlugin<LowStockIndex>();
+    return index;
+}
+
+/// The Idempotency-Key replay table, or nullptr when the plugin is not enabled in config.json
+IdempotencyStore* idempotencyStore() {
+    static IdempotencyStore* store = drogon::app().getPlugin<IdempotencyStore>();
+    return store;
+}
+
+/// Checkout stock holds, or nullptr when the plugin is not enabled in config.json
+StockReservations* stockReservations() {
+    static StockReservations* reservations = drogon::app().getPlugin<StockReservations>();
+    return reservations;
+}
+
+/// Write-behind stock counters, or nullptr when the plugin is not enabled in config.json
+StockDeltaBuffer* stockDeltaBuffer() {
+    static StockDeltaBuffer* deltas = drogon::app().getPlugin<StockDeltaBuffer>();
+    return deltas;
+}
+
+/// Stock adjustments StockDeltaBuffer has accepted but not yet written to SQLite
+int64_t pendingStock(int64_t productId) {
+    auto* deltas = stockDeltaBuffer();
+    return deltas ? deltas->pending(productId) : 0;
+}
+
+/**
+ * Pending stock a guarded UPDATE may count on: decrements only. A flush can commit a
+ * pending restock between binding the statement and running it, and it must not count
+ * twice; restocks count for direct writes once flushed.
+ */
+int64_t guardPendingStock(int64_t productId) {
+    return std::min<int64_t>(pendingStock(productId), 0);
+}
+
+/**
+ * @brief Announce a direct decrement of a write-behind product to StockDeltaBuffer
+ *
+ * Call before binding the guarded UPDATE. @return true if endDirectStockWrite() must
+ * follow once the write has committed (after onProductWritten()) or failed.
+ */
+bool beginDirectStockWrite(int64_t productId, int64_t delta) {
+    auto* deltas = stockDeltaBuffer();
+    if (!deltas || delta >= 0 || !deltas->covers(productId)) {
+        return false;
+    }
+    deltas->beginDirectWrite(productId, delta);
+    return true;
+}
+
+void endDirectStockWrite(int64_t productId, int64_t delta) {
+    if (auto* deltas = stockDeltaBuffer()) {
+        deltas->endDirectWrite(productId, delta);
+    }
+}
+
+/// Add the pending delta to a row read from SQLite; false if there is none to add
+bool mergePendingStock(drogon_model::sqlite3::Products& product, int64_t productId) {
+    if (!product.getQuantityInStock()) {
+        // Not among the requested fields
+        return false;
+    }
+    const int64_t pending = pendingStock(productId);
+    if (pending == 0) {
+        return false;
+    }
+    product.setQuantityInStock(product.getValueOfQuantityInStock() + pending);
+    return true;
+}
+
+/// @p rows with pending deltas merged, copied into @p merged only if any product has one
+const drogon_model::sqlite3::Products* withPendingStock(
+    const drogon_model::sqlite3::Products* rows,
+    size_t count,
+    std::vector<drogon_model::sqlite3::Products>& merged) {
+    if (!stockDeltaBuffer()) {
+        return rows;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        const int64_t productId = rows[i].getValueOfProductId();
+        if (pendingStock(productId) == 0) {
+            continue;
+        }
+        if (merged.empty()) {
+            merged.assign(rows, rows + count);
+        }
+        mergePendingStock(merged[i], productId);
+    }
+    return merged.empty() ? rows : merged.data();
+}
+
+/// Group commit for single creates, or nullptr when the plugin is not enabled in config.json
+WriteCoalescer* writeCoalescer() {
+    static WriteCoalescer* coalescer = drogon::app().getPlugin<WriteCoalescer>();
+    return coalescer;
+}
+
+/// Must run after every successful write that touches @p productId
+void onProductWritten(int64_t productId) {
+    if (auto* cache = productCache()) {
+        cache->invalidate(productId);
+    }
+    if (auto* cache = responseCache()) {
+        cache->bumpProductsVersion();
+    }
+}
+
+/**
+ * Same as above for writes that know the committed row, which keeps the watchlist current.
+ * @p version is the row's version column, or 0 for an insert: a fresh row has no older
+ * report to lose against. Writers finish out of order, so an older row is ignored.
+ */
+void onProductWritten(const drogon_model::sqlite3::Products& product, int64_t version) {
+    const int64_t productId = product.getValueOfProductId();
+    onProductWritten(productId);
+    if (auto* deltas = stockDeltaBuffer()) {
+        deltas->updateCommitted(productId, product.getValueOfQuantityInStock(), version);
+    }
+    // The watchlist and the holds follow the stock including what is still pending
+    const int64_t pending = pendingStock(productId);
+    if (auto* index = lowStockIndex()) {
+        const drogon_model::sqlite3::Products* row = &product;
+        drogon_model::sqlite3::Products merged;
+        if (pending != 0) {
+            merged = product;
+            merged.setQuantityInStock(product.getValueOfQuantityInStock() + pending);
+            row = &merged;
+        }
+        // Write-behind products are tracked, so their buffered adjustments can move them
+        auto* deltas = stockDeltaBuffer();
+        if (deltas && deltas->covers(productId)) {
+            index->track(*row, version);
+        } else {
+            index->update(*row, version);
+        }
+    }
+    if (auto* reservations = stockReservations()) {
+        reservations->updateStock(productId, product.getValueOfQuantityInStock() + pending,
+                                  version);
+    }
+}
+
+/// Must run after a product has been deleted
+void onProductDeleted(int64_t productId) {
+    onProductWritten(productId);
+    if (auto* index = lowStockIndex()) {
+        index->remove(productId);
+    }
+    if (auto* reservations = stockReservations()) {
+        reservations->removeProduct(productId);
+    }
+    if (auto* deltas = stockDeltaBuffer()) {
+        deltas->remove(productId);
+    }
+}
+
+/// Response-cache state captured when a read starts
+struct CachedRead {
+    ResponseCache* cache{nullptr};
+    std::string key;
+    std::string etag;
+    uint64_t version{0};
+};
+
+/**
+ * @brief Answer a product read from the response cache if possible
+ *
+ * Sends a 304 when If-None-Match carries the current ETag, or the cached body if
+ * one exists for the current version. Otherwise fills @p read so the caller can
+ * store what it produces with respondCached(). "*" is only answered from a cached
+ * body, since nothing else shows that the resource exists yet.
+ *
+ * @return true if the request has been answered
+ */
+bool tryServeCached(const HttpRequestPtr& req,
+                    const std::function<void(const HttpResponsePtr&)>& callback,
+                    CachedRead& read) {
+    read.cache = responseCache();
+    if (!read.cache) {
+        return false;
+    }
+    // Captured before the query runs: a write that lands meanwhile bumps the version,
+    // so whatever we read is never served under the newer one
+    read.version = read.cache->productsVersion();
+    read.key = ResponseCache::cacheKey(req);
+    read.etag = read.cache->makeEtag(read.version, read.key);
+
+    const std::string& ifNoneMatch = req->getHeader("if-none-match");
+    if (ResponseCache::etagMatches(ifNoneMatch, read.etag, false)) {
+        callback(read.cache->newNotModifiedResponse(read.etag));
+        return true;
+    }
+    ResponseCache::EntryPtr entry;
+    if (read.cache->find(read.key, read.version, entry)) {
+        // Single-product bodies are stored under their row ETag instead
+        if (ResponseCache::etagMatches(ifNoneMatch, entry->etag, true)) {
+            callback(read.cache->newNotModifiedResponse(entry->etag));
+            return true;
+        }
+        callback(read.cache->newResponse(*entry, req));
+        return true;
+    }
+    return false;
+}
+
+/// Send a freshly serialized 200 body, caching it under the version in @p read
+void respondCached(const HttpRequestPtr& req, const CachedRead& read, std::string&& body,
+                   std::vector<std::pair<std::string, std::string>>&& headers,
+                   const std::function<void(const HttpResponsePtr&)>& callback) {
+    if (!read.cache) {
+        auto resp = newJsonBodyResponse(std::move(body), k200OK);
+        if (!read.etag.empty()) {
+            resp->addHeader("ETag", read.etag);
+        }
+        for (const auto& [name, value] : headers) {
+            resp->addHeader(name, value);
+        }
+        callback(resp);
+        return;
+    }
+    auto entry = std::make_shared<ResponseCache::Entry>();
+    entry->version = read.version;
+    entry->etag = read.etag;
+    entry->body = std::move(body);
+    entry->headers = std::move(headers);
+    // The body exists now, so "*" can match; a listed tag was already checked up front
+    if (ResponseCache::etagMatches(req->getHeader("if-none-match"), read.etag, true)) {
+        callback(read.cache->newNotModifiedResponse(read.etag));
+    } else {
+        callback(read.cache->newResponse(*entry, req));
+    }
+    read.cache->store(read.key, std::move(entry));
+}
+
+/**
+ * @brief Send one full product row under its row ETag
+ *
+ * The row ETag replaces the table-wide one in @p read, so a client can revalidate
+ * with If-None-Match and send the same tag as If-Match on its next update.
+ */
+void respondVersionedRow(const HttpRequestPtr& req, CachedRead read,
+                         const drogon_model::sqlite3::Products& product, int64_t version,
+                         const std::function<void(const HttpResponsePtr&)>& callback) {
+    if (pendingStock(product.getValueOfProductId()) != 0) {
+        // The version only moves when the delta is flushed, so the row ETag would name
+        // two different bodies; keep the table-wide one
+        auto merged = product;
+        mergePendingStock(merged, product.getValueOfProductId());
+        std::string body;
+        body.reserve(kProductJsonSizeHint);
+        appendJson(body, merged);
+        respondCached(req, read, std::move(body), {}, callback);
+        return;
+    }
+    read.etag = makeRowEtag(product.getValueOfProductId(), version);
+    if (ResponseCache::etagMatches(req->getHeader("if-none-match"), read.etag, true)) {
+        if (read.cache) {
+            callback(read.cache->newNotModifiedResponse(read.etag));
+            return;
+        }
+        auto resp = HttpResponse::newHttpResponse();
+        resp->setStatusCode(k304NotModified);
+        resp->addHeader("ETag", read.etag);
+        callback(resp);
+        return;
+    }
+    std::string body;
+    body.reserve(kProductJsonSizeHint);
+    appendJson(body, product);
+    respondCached(req, read, std::move(body), {}, callback);
+}
+
+/// A full products row with its version column, which the generated model does not map
+ProductCache::EntryPtr readVersionedRow(const drogon::orm::Row& row) {
+    auto entry = std::make_shared<ProductCache::Entry>();
+    entry->product = drogon_model::sqlite3::Products(row);
+    entry->version = row["version"].as<int64_t>();
+    return entry;
+}
+
+/// Bind column @p index of @p product as set by updateByJson(), NULL when it has no value
+void bindProductColumn(drogon::orm::internal::SqlBinder& binder,
+                       const drogon_model::sqlite3::Products& product,
+                       size_t index) {
+    auto bind = [&binder](const auto& value) {
+        if (value) {
+            binder << *value;
+        } else {
+            binder << nullptr;
+        }
+    };
+    const std::string& name = drogon_model::sqlite3::Products::getColumnName(index);
+    if (name == "sku") {
+        bind(product.getSku());
+    } else if (name == "name") {
+        bind(product.getName());
+    } else if (name == "description") {
+        bind(product.getDescription());
+    } else if (name == "category") {
+        bind(product.getCategory());
+    } else if (name == "unit_price") {
+        bind(product.getUnitPrice());
+    } else if (name == "quantity_in_stock") {
+        bind(product.getQuantityInStock());
+    } else if (name == "reorder_threshold") {
+        bind(product.getReorderThreshold());
+    } else if (name == "supplier_id") {
+        bind(product.getSupplierId());
+    } else if (name == "warehouse_id") {
+        bind(product.getWarehouseId());
+    } else if (name == "created_at") {
+        bind(product.getCreatedAt());
+    } else if (name == "updated_at") {
+        bind(product.getUpdatedAt());
+    } else {
+        binder << nullptr;
+    }
+}
+
+/**
+ * @brief "select <selectList> from products where <criteria>", ready for a raw binder
+ *
+ * Criteria renders its placeholders as $?; SQLite takes ?. Bind the arguments with
+ * criteria.outputArgs().
+ */
+std::string selectProductsWhere(const std::string& selectList,
+                                const drogon::orm::Criteria& criteria) {
+    std::string sql = "select " + selectList + " from " +
+                      drogon_model::sqlite3::Products::tableName + " where " +
+                      criteria.criteriaString();
+    for (size_t pos = sql.find("$?"); pos != std::string::npos; pos = sql.find("$?", pos)) {
+        sql.replace(pos, 2, "?");
+    }
+    return sql;
+}
+
+/**
+ * @brief Parse ?fields= into a Products column mask, answering 400 itself on failure
+ *
+ * Without the parameter the mask selects every column.
+ */
+bool parseProductFields(const HttpRequestPtr& req,
+                        const std::function<void(const HttpResponsePtr&)>& callback,
+                        uint64_t& mask) {
+    std::string error;
+    if (parseFieldMask<drogon_model::sqlite3::Products>(req->getParameter("fields"), mask,
+                                                        error)) {
+        return true;
+    }
+    Json::Value response;
+    response["error"] = "Invalid fields parameter";
+    response["message"] = error;
+    Json::Value& valid = response["valid_fields"];
+    for (size_t i = 0; i < drogon_model::sqlite3::Products::getColumnNumber(); ++i) {
+        valid.append(drogon_model::sqlite3::Products::getColumnName(i));
+    }
+    auto resp = HttpResponse::newHttpJsonResponse(response);
+    resp->setStatusCode(k400BadRequest);
+    callback(resp);
+    return false;
+}
+
+/// The min_qty, max_qty and below_reorder filters of a product list
+struct QuantityFilter {
+    int64_t minQty{0};
+    int64_t maxQty{0};
+    bool hasMinQty{false};
+    bool hasMaxQty{false};
+    bool belowReorder{false};
+    /// Write-behind products were selected regardless of quantity; test rows with matches()
+    bool recheck{false};
+
+    bool active() const { return hasMinQty || hasMaxQty || belowReorder; }
+
+    /// Whether @p product, with its pending delta merged, passes the filters
+    bool matches(const drogon_model::sqlite3::Products& product) const {
+        const int64_t quantity = product.getValueOfQuantityInStock();
+        return (!hasMinQty || quantity >= minQty) && (!hasMaxQty || quantity <= maxQty) &&
+               (!belowReorder || quantity <= product.getValueOfReorderThreshold());
+    }
+};
+
+/**
+ * @brief Build the WHERE criteria of a product list from its filter parameters
+ *
+ * Always contains the keyset condition product_id > @p afterId. Each filter maps
+ * onto an index created in initializeDatabase(); every secondary index in SQLite
+ * ends in the rowid, so equality filters still seek straight to the cursor.
+ *
+ * SQLite lags StockDeltaBuffer by the pending deltas, so the quantity filters let
+ * write-behind products through and set @p quantity.recheck; the caller drops the rows
+ * that fail matches() once their pending delta is merged.
+ *
+ * @return false with @p error set if a filter value is malformed
+ */
+bool buildProductFilter(const HttpRequestPtr& req, int64_t afterId,
+                        drogon::orm::Criteria& criteria, QuantityFilter& quantity,
+                        std::string& error) {
+    using Cols = drogon_model::sqlite3::Products::Cols;
+    using drogon::orm::CompareOperator;
+    using drogon::orm::Criteria;
+
+    int64_t supplierId = 0, warehouseId = 0, minQty = 0, maxQty = 0;
+    bool hasSupplier = false, hasWarehouse = false, hasMinQty = false, hasMaxQty = false;
+    bool belowReorder = false;
+    if (!parseIntParameter(req->getParameter("supplier_id"), "supplier_id", supplierId,
+                           hasSupplier, error) ||
+        !parseIntParameter(req->getParameter("warehouse_id"), "warehouse_id", warehouseId,
+                           hasWarehouse, error) ||
+        !parseIntParameter(req->getParameter("min_qty"), "min_qty", minQty, hasMinQty, error) ||
+        !parseIntParameter(req->getParameter("max_qty"), "max_qty", maxQty, hasMaxQty, error) ||
+        !parseBoolParameter(req->getParameter("below_reorder"), "below_reorder", belowReorder,
+                            error)) {
+        return false;
+    }
+    quantity = QuantityFilter();
+    quantity.minQty = minQty;
+    quantity.maxQty = maxQty;
+    quantity.hasMinQty = hasMinQty;
+    quantity.hasMaxQty = hasMaxQty;
+    quantity.belowReorder = belowReorder;
+    if (hasMinQty && hasMaxQty && minQty > maxQty) {
+        error = "min_qty must not exceed max_qty";
+        return false;
+    }
+
+    criteria = Criteria(Cols::_product_id, CompareOperator::GT, afterId);
+    const auto& category = req->getParameter("category");
+    if (!category.empty()) {
+        criteria = criteria && Criteria(Cols::_category, CompareOperator::EQ, category);
+    }
+    if (hasSupplier) {
+        criteria = criteria && Criteria(Cols::_supplier_id, CompareOperator::EQ, supplierId);
+    }
+    if (hasWarehouse) {
+        criteria = criteria && Criteria(Cols::_warehouse_id, CompareOperator::EQ, warehouseId);
+    }
+    if (!quantity.active()) {
+        return true;
+    }
+
+    Criteria stock;
+    if (hasMinQty) {
+        stock = Criteria(Cols::_quantity_in_stock, CompareOperator::GE, minQty);
+    }
+    if (hasMaxQty) {
+        Criteria atMost(Cols::_quantity_in_stock, CompareOperator::LE, maxQty);
+        stock = stock ? stock && atMost : atMost;
+    }
+    if (belowReorder) {
+        // Spelled exactly like the WHERE of idx_products_at_reorder so the partial index applies
+        Criteria atReorder(drogon::orm::CustomSql("quantity_in_stock <= reorder_threshold"));
+        stock = stock ? stock && atReorder : atReorder;
+    }
+    auto* deltas = stockDeltaBuffer();
+    // const so the std::vector overload of Criteria builds the IN list
+    const std::vector<int64_t> covered =
+        deltas ? deltas->coveredProducts() : std::vector<int64_t>();
+    if (!covered.empty()) {
+        stock = stock || Criteria(Cols::_product_id, CompareOperator::In, covered);
+        quantity.recheck = true;
+    }
+    criteria = criteria && stock;
+    return true;
+}
+
+void appendCsvField(std::string& out, const std::string& value) {
+    if (value.find_first_of(",\"\r\n") == std::string::npos) {
+        out += value;
+        return;
+    }
+    out += '"';
+    for (char c : value) {
+        if (c == '"') {
+            out += '"';
+        }
+        out += c;
+    }
+    out += '"';
+}
+
+void appendCsvRow(std::string& out, const drogon_model::sqlite3::Products& product) {
+    const Json::Value json = product.toJson();
+    const size_t columns = drogon_model::sqlite3::Products::getColumnNumber();
+    for (size_t i = 0; i < columns; ++i) {
+        if (i > 0) {
+            out += ',';
+        }
+        const Json::Value& field = json[drogon_model::sqlite3::Products::getColumnName(i)];
+        if (field.isNull()) {
+            continue;
+        }
+        if (field.isDouble()) {
+            char buf[32];
+            std::snprintf(buf, sizeof(buf), "%.15g", field.asDouble());
+            out += buf;
+        } else {
+            appendCsvField(out, field.asString());
+        }
+    }
+    out += "\r\n";
+}
+
+/// A batch get in flight: the request keys, their lookups, and the rows found so far
+struct BatchGetState {
+    bool bySku{false};
+    std::vector<int64_t> ids;  // request order, duplicates kept
+    std::vector<std::string> skus;
+    std::vector<drogon::orm::Criteria> chunks;
+    std::unordered_map<int64_t, uint64_t> fillTokens;
+    std::unordered_map<int64_t, ProductCache::ProductPtr> foundById;
+    std::unordered_map<std::string, ProductCache::ProductPtr> foundBySku;
+    std::function<void(const HttpResponsePtr&)> callback;
+};
+
+/// Answer a batch get once every chunk has been fetched, one result per key in request order
+void finishBatchGet(const BatchGetState& state) {
+    const size_t count = state.bySku ? state.skus.size() : state.ids.size();
+    std::string body;
+    body.reserve(count * kProductJsonSizeHint + 16);
+    appendJsonRaw(body, "{\"results\":[");
+    for (size_t i = 0; i < count; ++i) {
+        if (i > 0) {
+            body += ',';
+        }
+        ProductCache::ProductPtr product;
+        if (state.bySku) {
+            auto it = state.foundBySku.find(state.skus[i]);
+            if (it != state.foundBySku.end()) {
+                product = it->second;
+            }
+        } else {
+            auto it = state.foundById.find(state.ids[i]);
+            if (it != state.foundById.end()) {
+                product = it->second;
+            }
+        }
+        appendJsonRaw(body, "{\"found\":");
+        appendJsonBool(body, product != nullptr);
+        if (state.bySku) {
+            appendJsonRaw(body, ",\"sku\":");
+            appendJsonString(body, state.skus[i]);
+        } else {
+            appendJsonRaw(body, ",\"id\":");
+            appendJsonInt(body, state.ids[i]);
+        }
+        if (product) {
+            appendJsonRaw(body, ",\"product\":");
+            if (pendingStock(product->getValueOfProductId()) == 0) {
+                appendJson(body, *product);
+            } else {
+                auto merged = *product;
+                mergePendingStock(merged, merged.getValueOfProductId());
+                appendJson(body, merged);
+            }
+        }
+        body += '}';
+    }
+    appendJsonRaw(body, "]}");
+    state.callback(newJsonBodyResponse(std::move(body), k200OK));
+}
+
+/// Fetch chunk @p chunk of a batch get, then the next one, and finally answer
+void runBatchGet(const std::shared_ptr<BatchGetState>& state, size_t chunk) {
+    if (chunk == state->chunks.size()) {
+        finishBatchGet(*state);
+        return;
+    }
+    // Raw select rather than the Mapper, which would drop the version the cache keeps
+    auto binder = *drogon::app().getDbClient() << selectProductsWhere("*", state->chunks[chunk]);
+    state->chunks[chunk].outputArgs(binder);
+    binder >> [state, chunk](const drogon::orm::Result& result) {
+        auto* cache = productCache();
+        for (const auto& row : result) {
+            auto entry = readVersionedRow(row);
+            const int64_t productId = entry->product.getValueOfProductId();
+            ProductCache::ProductPtr product(entry, &entry->product);
+            if (state->bySku) {
+                state->foundBySku[product->getValueOfSku()] = std::move(product);
+                continue;
+            }
+            if (cache) {
+                cache->fill(productId, std::move(entry), state->fillTokens[productId]);
+            }
+            state->foundById[productId] = std::move(product);
+        }
+        runBatchGet(state, chunk + 1);
+    };
+    binder >> [state](const drogon::orm::DrogonDbException& e) {
+        Json::Value error;
+        error["error"] = "Failed to retrieve products";
+        error["message"] = e.base().what();
+        auto resp = HttpResponse::newHttpJsonResponse(error);
+        resp->setStatusCode(k500InternalServerError);
+        state->callback(resp);
+    };
+}
+
+/// A bulk insert in flight; one transaction for all of its INSERT statements
+struct BulkInsertState {
+    std::vector<Json::Value> items;
+    /// product_id per item once inserted, 0 while pending or if its SKU already existed
+    std::vector<int64_t> ids;
+    std::unordered_map<std::string, size_t> indexBySku;
+    std::shared_ptr<drogon::orm::Transaction> transaction;
+    std::function<void(const HttpResponsePtr&)> callback;
+};
+
+/// Report the outcome of every item once the bulk transaction has committed
+void finishBulkInsert(const BulkInsertState& state) {
+    size_t created = 0;
+    std::string results;
+    results.reserve(state.items.size() * 48);
+    for (size_t i = 0; i < state.items.size(); ++i) {
+        if (i > 0) {
+            results += ',';
+        }
+        appendJsonRaw(results, "{\"index\":");
+        appendJsonInt(results, static_cast<int64_t>(i));
+        if (state.ids[i] != 0) {
+            ++created;
+            drogon_model::sqlite3::Products product(state.items[i]);
+            product.setProductId(state.ids[i]);
+            onProductWritten(product, 0);
+            appendJsonRaw(results, ",\"product_id\":");
+            appendJsonInt(results, state.ids[i]);
+            appendJsonRaw(results, ",\"status\":\"created\"}");
+        } else {
+            appendJsonRaw(results, ",\"sku\":");
+            appendJsonString(results, state.items[i]["sku"].asString());
+            appendJsonRaw(results, ",\"status\":\"conflict\"}");
+        }
+    }
+    std::string body;
+    body.reserve(results.size() + 64);
+    appendJsonRaw(body, "{\"conflicts\":");
+    appendJsonInt(body, static_cast<int64_t>(state.items.size() - created));
+    appendJsonRaw(body, ",\"created\":");
+    appendJsonInt(body, static_cast<int64_t>(created));
+    appendJsonRaw(body, ",\"results\":[");
+    body += results;
+    appendJsonRaw(body, "]}");
+    state.callback(newJsonBodyResponse(std::move(body), created > 0 ? k201Created : k200OK));
+}
+
+/**
+ * @brief Insert the next kProductInsertRowsPerStatement items with one multi-row INSERT,
+ * then recurse
+ *
+ * ON CONFLICT(sku) DO NOTHING keeps a duplicate SKU from aborting the batch; RETURNING
+ * tells us which rows went in. When every chunk is done the transaction is released,
+ * which commits it, and the response is sent from the commit callback.
+ */
+void insertBulkChunk(const std::shared_ptr<BulkInsertState>& state, size_t begin) {
+    if (begin >= state->items.size()) {
+        state->transaction->setCommitCallback([state](bool committed) {
+            if (committed) {
+                finishBulkInsert(*state);
+                return;
+            }
+            Json::Value error;
+            error["error"] = "Failed to create products";
+            error["message"] = "Transaction commit failed";
+            auto resp = HttpResponse::newHttpJsonResponse(error);
+            resp->setStatusCode(k500InternalServerError);
+            state->callback(resp);
+        });
+        state->transaction.reset();
+        return;
+    }
+    const size_t end = std::min(state->items.size(), begin + kProductInsertRowsPerStatement);
+
+    auto binder = *state->transaction << buildProductInsertSql(end - begin);
+    for (size_t i = begin; i < end; ++i) {
+        bindProductInsertRow(binder, state->items[i]);
+    }
+    binder >> [state, end](const drogon::orm::Result& result) {
+        // RETURNING order is unspecified, so rows are matched back by their unique SKU
+        for (const auto& row : result) {
+            auto it = state->indexBySku.find(row["sku"].as<std::string>());
+            if (it != state->indexBySku.end()) {
+                state->ids[it->second] = row["product_id"].as<int64_t>();
+            }
+        }
+        insertBulkChunk(state, end);
+    };
+    binder >> [state](const drogon::orm::DrogonDbException& e) {
+        state->transaction->rollback();
+        Json::Value error;
+        error["error"] = "Failed to create products";
+        error["message"] = e.base().what();
+        auto resp = HttpResponse::newHttpJsonResponse(error);
+        resp->setStatusCode(k500InternalServerError);
+        state->callback(resp);
+    };
+}
+
+/// Idempotency-Key of a write; store is nullptr when the write is not keyed
+struct IdempotentWrite {
+    IdempotencyStore* store{nullptr};
+    std::string key;
+    std::string fingerprint;
+};
+
+/// The stored response for a retried key, or 422 if the key was first used for another request
+HttpResponsePtr replayResponse(const IdempotencyStore::Response& stored,
+                               const std::string& fingerprint) {
+    if (stored.fingerprint != fingerprint) {
+        Json::Value error;
+        error["error"] = "Idempotency-Key reused";
+        error["message"] = "This Idempotency-Key was already used for a different request";
+        auto resp = HttpResponse::newHttpJsonResponse(error);
+        resp->setStatusCode(k422UnprocessableEntity);
+        return resp;
+    }
+    auto resp = newJsonBodyResponse(std::string(stored.body),
+                                    static_cast<HttpStatusCode>(stored.status));
+    resp->addHeader("Idempotent-Replayed", "true");
+    return resp;
+}
+
+/**
+ * @brief Read the Idempotency-Key of a write and answer retries from memory
+ * @return false if @p callback has been answered (replay or bad key) and the write must not run
+ */
+bool checkIdempotencyKey(const HttpRequestPtr& req,
+                         const std::function<void(const HttpResponsePtr&)>& callback,
+                         IdempotentWrite& write) {
+    const std::string& key = req->getHeader("Idempotency-Key");
+    auto* store = idempotencyStore();
+    if (key.empty() || !store) {
+        return true;
+    }
+    if (key.size() > IdempotencyStore::kMaxKeyLength) {
+        Json::Value error;
+        error["error"] = "Invalid Idempotency-Key";
+        error["message"] = "Idempotency-Key must be at most " +
+                           std::to_string(IdempotencyStore::kMaxKeyLength) + " characters";
+        auto resp = HttpResponse::newHttpJsonResponse(error);
+        resp->setStatusCode(k400BadRequest);
+        callback(resp);
+        return false;
+    }
+    write.store = store;
+    write.key = key;
+    write.fingerprint = IdempotencyStore::fingerprint(req);
+    IdempotencyStore::ResponsePtr stored;
+    if (store->find(key, stored)) {
+        callback(replayResponse(*stored, write.fingerprint));
+        return false;
+    }
+    return true;
+}
+
+/// Answer a keyed write whose key was already claimed, from the idempotency_keys table
+void replayStoredResponse(const IdempotentWrite& write,
+                          const std::function<void(const HttpResponsePtr&)>& callback) {
+    drogon::app().getDbClient()->execSqlAsync(
+        "select fingerprint, status, body from idempotency_keys where idempotency_key = ?",
+        [write, callback](const drogon::orm::Result& result) {
+            if (result.empty() || result[0]["status"].as<int>() == 0) {
+                // Claimed by a write that is still running, or rolled back in the meantime
+                Json::Value error;
+                error["error"] = "Idempotency-Key in use";
+                error["message"] = "A request with this Idempotency-Key is in progress; retry later";
+                auto resp = HttpResponse::newHttpJsonResponse(error);
+                resp->setStatusCode(k409Conflict);
+                callback(resp);
+                return;
+            }
+            auto stored = std::make_shared<IdempotencyStore::Response>();
+            stored->fingerprint = result[0]["fingerprint"].as<std::string>();
+            stored->status = result[0]["status"].as<int>();
+            stored->body = result[0]["body"].as<std::string>();
+            write.store->remember(write.key, stored);
+            callback(replayResponse(*stored, write.fingerprint));
+        },
+        [callback](const drogon::orm::DrogonDbException& e) {
+            Json::Value error;
+            error["error"] = "Failed to read Idempotency-Key";
+            error["message"] = e.base().what();
+            auto resp = HttpResponse::newHttpJsonResponse(error);
+            resp->setStatusCode(k500InternalServerError);
+            callback(resp);
+        },
+        write.key);
+}
+
+/**
+ * Hands a write's response to runWriteTransaction(). 2xx responses are committed and
+ * @p afterCommit (cache hooks) runs once they are durable; anything else rolls back.
+ * The write must not keep the transaction after calling it, since releasing it commits.
+ */
+using WriteFinish =
+    std::function<void(const HttpResponsePtr& resp, std::function<void()>&& afterCommit)>;
+using WriteBody = std::function<void(const std::shared_ptr<drogon::orm::Transaction>&, WriteFinish)>;
+
+/// A transaction opened by runWriteTransaction()
+struct WriteTransactionState {
+    IdempotentWrite idempotency;
+    std::shared_ptr<drogon::orm::Transaction> transaction;
+    std::function<void(const HttpResponsePtr&)> callback;
+};
+
+void commitWrite(const std::shared_ptr<WriteTransactionState>& state,
+                 const HttpResponsePtr& resp,
+                 std::function<void()>&& afterCommit) {
+    state->transaction->setCommitCallback(
+        [state, resp, afterCommit = std::move(afterCommit)](bool committed) {
+            if (!committed) {
+                Json::Value error;
+                error["error"] = "Write failed";
+                error["message"] = "Transaction commit failed";
+                auto failed = HttpResponse::newHttpJsonResponse(error);
+                failed->setStatusCode(k500InternalServerError);
+                state->callback(failed);
+                return;
+            }
+            if (afterCommit) {
+                afterCommit();
+            }
+            if (state->idempotency.store) {
+                auto stored = std::make_shared<IdempotencyStore::Response>();
+                stored->fingerprint = state->idempotency.fingerprint;
+                stored->status = static_cast<int>(resp->getStatusCode());
+                stored->body = std::string(resp->getBody());
+                state->idempotency.store->remember(state->idempotency.key, std::move(stored));
+            }
+            state->callback(resp);
+        });
+    state->transaction.reset();
+}
+
+/**
+ * @brief Run @p write in one transaction and send its response once it has committed
+ *
+ * With an Idempotency-Key the key is claimed first in the same transaction and the
+ * 2xx response is stored next to it before commit, so the write and its replay record
+ * are durable together. If the key is already taken the transaction rolls back and
+ * the stored response is replayed. Failed writes roll back the claim as well, so the
+ * client can retry with the same key.
+ */
+void runWriteTransaction(const IdempotentWrite& idempotency,
+                         std::function<void(const HttpResponsePtr&)>&& callback,
+                         WriteBody&& write) {
+    auto state = std::make_shared<WriteTransactionState>();
+    state->idempotency = idempotency;
+    state->callback = std::move(callback);
+
+    WriteFinish finish = [state](const HttpResponsePtr& resp, std::function<void()>&& afterCommit) {
+        const int code = static_cast<int>(resp->getStatusCode());
+        if (code < 200 || code >= 300) {
+            state->transaction->rollback();
+            state->transaction.reset();
+            state->callback(resp);
+            return;
+        }
+        if (!state->idempotency.store) {
+            commitWrite(state, resp, std::move(afterCommit));
+            return;
+        }
+        auto transaction = state->transaction;
+        transaction->execSqlAsync(
+            "update idempotency_keys set status = ?, body = ? where idempotency_key = ?",
+            [state, resp, afterCommit = std::move(afterCommit)](
+                const drogon::orm::Result&) mutable {
+                commitWrite(state, resp, std::move(afterCommit));
+            },
+            [state](const drogon::orm::DrogonDbException& e) {
+                state->transaction->rollback();
+                state->transaction.reset();
+                Json::Value error;
+                error["error"] = "Write failed";
+                error["message"] = e.base().what();
+                auto failed = HttpResponse::newHttpJsonResponse(error);
+                failed->setStatusCode(k500InternalServerError);
+                state->callback(failed);
+            },
+            code,
+            std::string(resp->getBody()),
+            state->idempotency.key);
+    };
+
+    drogon::app().getDbClient()->newTransactionAsync(
+        [state, finish = std::move(finish), write = std::move(write)](
+            const std::shared_ptr<drogon::orm::Transaction>& transaction) {
+            auto fail = [state](const std::string& message) {
+                Json::Value error;
+                error["error"] = "Write failed";
+                error["message"] = message;
+                auto resp = HttpResponse::newHttpJsonResponse(error);
+                resp->setStatusCode(k500InternalServerError);
+                state->callback(resp);
+            };
+            if (!transaction) {
+                fail("Could not start a transaction");
+                return;
+            }
+            state->transaction = transaction;
+            if (!state->idempotency.store) {
+                write(transaction, finish);
+                return;
+            }
+            transaction->execSqlAsync(
+                state->idempotency.store->claimSql(),
+                [state, finish, write](const drogon::orm::Result& result) {
+                    if (result.affectedRows() == 0) {
+                        state->transaction->rollback();
+                        state->transaction.reset();
+                        replayStoredResponse(state->idempotency, state->callback);
+                        return;
+                    }
+                    write(state->transaction, finish);
+                },
+                [state, fail](const drogon::orm::DrogonDbException& e) {
+                    state->transaction->rollback();
+                    state->transaction.reset();
+                    fail(e.base().what());
+                },
+                state->idempotency.key,
+                state->idempotency.fingerprint);
+        });
+}
+
+/// Read a stock delta: a non-zero integer within kMaxStockDelta
+bool parseStockDelta(const Json::Value& value, int64_t& delta, std::string& error) {
+    if (!value.isInt64()) {
+        error = "delta must be an integer";
+        return false;
+    }
+    delta = value.asInt64();
+    if (delta == 0 || delta > kMaxStockDelta || delta < -kMaxStockDelta) {
+        error = "delta must be non-zero and at most " + std::to_string(kMaxStockDelta) +
+                " in magnitude";
+        return false;
+    }
+    return true;
+}
+
+void appendAdjustResult(std::string& out, const drogon_model::sqlite3::Products& product,
+                        int64_t delta) {
+    appendJsonRaw(out, "{\"delta\":");
+    appendJsonInt(out, delta);
+    appendJsonRaw(out, ",\"product_id\":");
+    appendJsonInt(out, product.getValueOfProductId());
+    appendJsonRaw(out, ",\"quantity_in_stock\":");
+    appendJsonInt(out,
+                  product.getValueOfQuantityInStock() + pendingStock(product.getValueOfProductId()));
+    appendJsonRaw(out, "}");
+}
+
+/**
+ * @brief Answer an adjustment whose guarded UPDATE matched no row
+ *
+ * Only this failure path reads the row, to tell a missing product (404) from
+ * insufficient stock (409). @p extra is merged into the error body.
+ */
+template <typename Client>
+void rejectStockAdjustment(Client& client,
+                           int64_t productId,
+                           int64_t delta,
+                           Json::Value extra,
+                           std::function<void(const HttpResponsePtr&)> callback) {
+    client.execSqlAsync(
+        "select quantity_in_stock from products where product_id = ?",
+        [productId, delta, extra, callback](const drogon::orm::Result& result) {
+            Json::Value error = extra;
+            HttpStatusCode code = k404NotFound;
+            if (result.empty()) {
+                error["error"] = "Product not found";
+            } else {
+                code = k409Conflict;
+                error["error"] = "Insufficient stock";
+                error["quantity_in_stock"] = static_cast<Json::Int64>(
+                    result[0]["quantity_in_stock"].as<int64_t>() + pendingStock(productId));
+                error["delta"] = static_cast<Json::Int64>(delta);
+            }
+            error["product_id"] = static_cast<Json::Int64>(productId);
+            auto resp = HttpResponse::newHttpJsonResponse(error);
+            resp->setStatusCode(code);
+            callback(resp);
+        },
+        [callback](const drogon::orm::DrogonDbException& e) {
+            Json::Value error;
+            error["error"] = "Failed to adjust stock";
+            error["message"] = e.base().what();
+            auto resp = HttpResponse::newHttpJsonResponse(error);
+            resp->setStatusCode(k500InternalServerError);
+            callback(resp);
+        },
+        productId);
+}
+
+/// A batch of stock adjustments applied all-or-nothing in one transaction
+struct AdjustBatchState {
+    std::vector<std::pair<int64_t, int64_t>> adjustments;  // (product_id, delta)
+    /// Committed row after each adjustment, in request order, and its version column
+    std::vector<drogon_model::sqlite3::Products> rows;
+    std::vector<int64_t> versions;
+    /// Decrements announced to StockDeltaBuffer, ended once the batch is answered
+    std::vector<std::pair<int64_t, int64_t>> announced;
+    std::shared_ptr<drogon::orm::Transaction> transaction;
+    WriteFinish finish;
+};
+
+/// Release the batch's transaction and hand @p resp to runWriteTransaction()
+void finishBatchAdjustment(const std::shared_ptr<AdjustBatchState>& state,
+                           const HttpResponsePtr& resp,
+                           std::function<void()>&& afterCommit) {
+    state->transaction.reset();
+    state->finish(resp, std::move(afterCommit));
+}
+
+/**
+ * @brief Apply adjustment @p index, then recurse
+ *
+ * Each adjustment is one guarded UPDATE. The first one that cannot be applied rolls the
+ * whole batch back, so an order is either picked completely or not at all.
+ */
+void applyBatchAdjustment(const std::shared_ptr<AdjustBatchState>& state, size_t index) {
+    if (index == state->adjustments.size()) {
+        std::string body;
+        body.reserve(state->rows.size() * 64 + 16);
+        appendJsonRaw(body, "{\"results\":[");
+        for (size_t i = 0; i < state->rows.size(); ++i) {
+            if (i > 0) {
+                body += ',';
+            }
+            appendAdjustResult(body, state->rows[i], state->adjustments[i].second);
+        }
+        appendJsonRaw(body, "]}");
+        finishBatchAdjustment(state, newJsonBodyResponse(std::move(body), k200OK), [state]() {
+            for (size_t i = 0; i < state->rows.size(); ++i) {
+                onProductWritten(state->rows[i], state->versions[i]);
+            }
+        });
+        return;
+    }
+    const auto [productId, delta] = state->adjustments[index];
+    state->transaction->execSqlAsync(
+        kAdjustStockSql,
+        [state, index, productId = productId, delta = delta](const drogon::orm::Result& result) {
+            if (result.empty()) {
+                Json::Value extra;
+                extra["index"] = static_cast<Json::UInt64>(index);
+                rejectStockAdjustment(*state->transaction, productId, delta, extra,
+                                      [state](const HttpResponsePtr& resp) {
+                                          finishBatchAdjustment(state, resp, nullptr);
+                                      });
+                return;
+            }
+            state->rows.emplace_back(result[0]);
+            state->versions.push_back(result[0]["version"].as<int64_t>());
+            applyBatchAdjustment(state, index + 1);
+        },
+        [state](const drogon::orm::DrogonDbException& e) {
+            Json::Value error;
+            error["error"] = "Failed to adjust stock";
+            error["message"] = e.base().what();
+            auto resp = HttpResponse::newHttpJsonResponse(error);
+            resp->setStatusCode(k500InternalServerError);
+            finishBatchAdjustment(state, resp, nullptr);
+        },
+        delta,
+        productId,
+        delta + guardPendingStock(productId));
+}
+
+/// A PUT /api/products/by-sku in flight; one transaction for all of its statements
+struct UpsertState {
+    std::vector<Json::Value> items;
+    std::unordered_map<std::string, size_t> indexBySku;
+    /// Highest product_id before the upsert; AUTOINCREMENT ids above it were inserted
+    int64_t maxIdBefore{0};
+    /// Row written for each item; product_id stays unset for unchanged items
+    std::vector<drogon_model::sqlite3::Products> rows;
+    /// Version column of each row written
+    std::vector<int64_t> versions;
+    std::shared_ptr<drogon::orm::Transaction> transaction;
+    WriteFinish finish;
+};
+
+/// Report inserted/updated/unchanged per item and hand the response to runWriteTransaction()
+void finishUpsert(const std::shared_ptr<UpsertState>& state) {
+    size_t inserted = 0;
+    size_t updated = 0;
+    std::string results;
+    results.reserve(state->items.size() * 64);
+    for (size_t i = 0; i < state->items.size(); ++i) {
+        if (i > 0) {
+            results += ',';
+        }
+        appendJsonRaw(results, "{\"index\":");
+        appendJsonInt(results, static_cast<int64_t>(i));
+        appendJsonRaw(results, ",\"sku\":");
+        appendJsonString(results, state->items[i]["sku"].asString());
+        const auto productId = state->rows[i].getProductId();
+        if (!productId) {
+            appendJsonRaw(results, ",\"status\":\"unchanged\"}");
+            continue;
+        }
+        const bool isInsert = *productId > state->maxIdBefore;
+        ++(isInsert ? inserted : updated);
+        appendJsonRaw(results, ",\"product_id\":");
+        appendJsonInt(results, *productId);
+        appendJsonRaw(results, isInsert ? ",\"status\":\"inserted\"}" : ",\"status\":\"updated\"}");
+    }
+    std::string body;
+    body.reserve(results.size() + 80);
+    appendJsonRaw(body, "{\"inserted\":");
+    appendJsonInt(body, static_cast<int64_t>(inserted));
+    appendJsonRaw(body, ",\"results\":[");
+    body += results;
+    appendJsonRaw(body, "],\"unchanged\":");
+    appendJsonInt(body, static_cast<int64_t>(state->items.size() - inserted - updated));
+    appendJsonRaw(body, ",\"updated\":");
+    appendJsonInt(body, static_cast<int64_t>(updated));
+    appendJsonRaw(body, "}");
+
+    state->transaction.reset();
+    state->finish(newJsonBodyResponse(std::move(body), k200OK), [state]() {
+        for (size_t i = 0; i < state->rows.size(); ++i) {
+            if (state->rows[i].getProductId()) {
+                onProductWritten(state->rows[i], state->versions[i]);
+            }
+        }
+    });
+}
+
+/**
+ * @brief Upsert the next kProductInsertRowsPerStatement items with one multi-row
+ * statement, then recurse
+ */
+void upsertChunk(const std::shared_ptr<UpsertState>& state, size_t begin) {
+    if (begin >= state->items.size()) {
+        finishUpsert(state);
+        return;
+    }
+    const size_t end = std::min(state->items.size(), begin + kProductInsertRowsPerStatement);
+
+    auto binder = *state->transaction << buildProductUpsertSql(end - begin);
+    for (size_t i = begin; i < end; ++i) {
+        bindProductInsertRow(binder, state->items[i]);
+    }
+    binder >> [state, end](const drogon::orm::Result& result) {
+        // RETURNING order is unspecified, so rows are matched back by their unique SKU
+        for (const auto& row : result) {
+            auto it = state->indexBySku.find(row["sku"].as<std::string>());
+            if (it != state->indexBySku.end()) {
+                state->rows[it->second] = drogon_model::sqlite3::Products(row);
+                state->versions[it->second] = row["version"].as<int64_t>();
+            }
+        }
+        upsertChunk(state, end);
+    };
+    binder >> [state](const drogon::orm::DrogonDbException& e) {
+        Json::Value error;
+        error["error"] = "Failed to upsert products";
+        error["message"] = e.base().what();
+        auto resp = HttpResponse::newHttpJsonResponse(error);
+        resp->setStatusCode(k500InternalServerError);
+        state->transaction.reset();
+        state->finish(resp, nullptr);
+    };
+}
+
+/**
+ * @brief Push-side state of a streaming catalog export
+ *
+ * Every keyset chunk is queried with execSqlAsync, so no IO thread waits on SQLite.
+ * A chunk is handed to the response stream as soon as its rows arrive and the query
+ * for the next one is issued right after, so SQLite reads ahead while the previous
+ * chunk is being written out. Chunks are sent in order because the next query only
+ * starts once the previous chunk is queued; the export stops when the client leaves.
+ */
+class ProductExportStream : public std::enable_shared_from_this<ProductExportStream> {
+  public:
+    ProductExportStream(drogon::orm::DbClientPtr dbClient, ExportFormat format,
+                        drogon::ResponseStreamPtr stream)
+        : dbClient_(std::move(dbClient)), format_(format), stream_(std::move(stream)) {}
+
+    void start() {
+        if (format_ == ExportFormat::Csv) {
+            std::string header;
+            const size_t columns = drogon_model::sqlite3::Products::getColumnNumber();
+            for (size_t i = 0; i < columns; ++i) {
+                if (i > 0) {
+                    header += ',';
+                }
+                header += drogon_model::sqlite3::Products::getColumnName(i);
+            }
+            header += "\r\n";
+            if (!stream_->send(header)) {
+                return;
+            }
+        }
+        fetchNextChunk();
+    }
+
+  private:
+    void fetchNextChunk() {
+        static const std::string sql = "select * from " +
+                                       drogon_model::sqlite3::Products::tableName +
+                                       " where product_id > ? order by product_id limit ?";
+        auto self = shared_from_this();
+        dbClient_->execSqlAsync(
+            sql, [self](const drogon::orm::Result& result) { self->sendChunk(result); },
+            [self](const drogon::orm::DrogonDbException& e) {
+                // Headers are already on the wire, so all we can do is cut the stream short
+                LOG_ERROR << "Product export aborted after id " << self->lastId_ << ": "
+                          << e.base().what();
+                self->stream_->close();
+            },
+            lastId_, static_cast<int64_t>(kExportChunkRows));
+    }
+
+    void sendChunk(const drogon::orm::Result& result) {
+        std::string chunk;
+        chunk.reserve(result.size() * kProductJsonSizeHint);
+        for (const auto& row : result) {
+            drogon_model::sqlite3::Products product(row);
+            lastId_ = product.getValueOfProductId();
+            mergePendingStock(product, lastId_);
+            if (format_ == ExportFormat::Csv) {
+                appendCsvRow(chunk, product);
+            } else {
+                appendJson(chunk, product);
+                chunk += '\n';
+            }
+        }
+        if (!chunk.empty() && !stream_->send(chunk)) {
+            return;  // connection closed by the peer
+        }
+        if (result.size() < kExportChunkRows) {
+            stream_->close();
+            return;
+        }
+        fetchNextChunk();
+    }
+
+    drogon::orm::DbClientPtr dbClient_;
+    ExportFormat format_;
+    drogon::ResponseStreamPtr stream_;
+    int64_t lastId_{0};
+};
+
+/// The reservation plugin if it can answer; otherwise answers 503 itself and returns nullptr
+StockReservations* readyReservations(
+    const std::function<void(const HttpResponsePtr&)>& callback) {
+    auto* reservations = stockReservations();
+    if (reservations && reservations->ready()) {
+        return reservations;
+    }
+    Json::Value response;
+    response["error"] = "Reservations unavailable";
+    response["message"] =
+        reservations ? "Stock levels are still loading" : "StockReservations is not enabled";
+    auto resp = HttpResponse::newHttpJsonResponse(response);
+    resp->setStatusCode(k503ServiceUnavailable);
+    callback(resp);
+    return nullptr;
+}
+
+/// Answer a reservation call that did not succeed
+void rejectReservation(StockReservations::Status status,
+                       const std::function<void(const HttpResponsePtr&)>& callback) {
+    Json::Value error;
+    HttpStatusCode code = k404NotFound;
+    switch (status) {
+        case StockReservations::Status::NotReady:
+            code = k503ServiceUnavailable;
+            error["error"] = "Reservations unavailable";
+            error["message"] = "Stock levels are still loading";
+            break;
+        case StockReservations::Status::UnknownProduct:
+            error["error"] = "Product not found";
+            break;
+        case StockReservations::Status::InsufficientStock:
+            code = k409Conflict;
+            error["error"] = "Insufficient stock";
+            break;
+        default:
+            error["error"] = "Reservation not found";
+            error["message"] =
+                "The reservation does not exist, has expired, or is being committed";
+            break;
+    }
+    auto resp = HttpResponse::newHttpJsonResponse(error);
+    resp->setStatusCode(code);
+    callback(resp);
+}
+
+void appendAvailability(std::string& out, int64_t productId,
+                        const StockReservations::Availability& availability) {
+    appendJsonRaw(out, "{\"available\":");
+    appendJsonInt(out, availability.available);
+    appendJsonRaw(out, ",\"product_id\":");
+    appendJsonInt(out, productId);
+    appendJsonRaw(out, ",\"quantity_in_stock\":");
+    appendJsonInt(out, availability.inStock);
+    appendJsonRaw(out, ",\"reserved\":");
+    appendJsonInt(out, availability.reserved);
+    out += '}';
+}
+
+/// Apply an unkeyed stock adjustment with the guarded UPDATE
+void adjustStockDirect(int64_t productId,
+                       int64_t delta,
+                       std::function<void(const HttpResponsePtr&)> callback) {
+    auto dbClient = drogon::app().getDbClient();
+    const bool announced = beginDirectStockWrite(productId, delta);
+    dbClient->execSqlAsync(
+        kAdjustStockSql,
+        [dbClient, callback, productId, delta, announced](const drogon::orm::Result& result) {
+            if (result.empty()) {
+                if (announced) {
+                    endDirectStockWrite(productId, delta);
+                }
+                rejectStockAdjustment(*dbClient, productId, delta, Json::Value(), callback);
+                return;
+            }
+            drogon_model::sqlite3::Products product(result[0]);
+            onProductWritten(product, result[0]["version"].as<int64_t>());
+            if (announced) {
+                endDirectStockWrite(productId, delta);
+            }
+            std::string body;
+            appendAdjustResult(body, product, delta);
+            callback(newJsonBodyResponse(std::move(body), k200OK));
+        },
+        [callback, productId, delta, announced](const drogon::orm::DrogonDbException& e) {
+            if (announced) {
+                endDirectStockWrite(productId, delta);
+            }
+            Json::Value error;
+            error["error"] = "Failed to adjust stock";
+            error["message"] = e.base().what();
+            auto resp = HttpResponse::newHttpJsonResponse(error);
+            resp->setStatusCode(k500InternalServerError);
+            callback(resp);
+        },
+        delta,
+        productId,
+        delta + guardPendingStock(productId));
+}
+
+/// 409 for a buffered adjustment refused by StockDeltaBuffer; @p extra is merged in
+HttpResponsePtr insufficientStockResponse(int64_t productId,
+                                          int64_t delta,
+                                          int64_t quantity,
+                                          Json::Value extra) {
+    extra["error"] = "Insufficient stock";
+    extra["quantity_in_stock"] = static_cast<Json::Int64>(quantity);
+    extra["delta"] = static_cast<Json::Int64>(delta);
+    extra["product_id"] = static_cast<Json::Int64>(productId);
+    auto resp = HttpResponse::newHttpJsonResponse(extra);
+    resp->setStatusCode(k409Conflict);
+    return resp;
+}
+
+HttpResponsePtr productNotFoundResponse(int64_t productId, Json::Value extra) {
+    extra["error"] = "Product not found";
+    extra["product_id"] = static_cast<Json::Int64>(productId);
+    auto resp = HttpResponse::newHttpJsonResponse(extra);
+    resp->setStatusCode(k404NotFound);
+    return resp;
+}
+
+using StockDeltaDone = std::function<void(StockDeltaBuffer::Status, int64_t quantity)>;
+
+/**
+ * @brief add() a stock delta through StockDeltaBuffer and follow it in caches and indexes
+ *
+ * Only the first adjustment of a product since startup reads SQLite, for the committed
+ * row. @p done gets the add() status and quantity; UnknownProduct means the product
+ * does not exist, NotReady that the caller should write directly instead.
+ */
+void addStockDelta(StockDeltaBuffer& deltas,
+                   int64_t productId,
+                   int64_t delta,
+                   StockDeltaDone done,
+                   bool primed = false) {
+    int64_t quantity = 0;
+    const auto status = deltas.add(productId, delta, quantity);
+    if (status == StockDeltaBuffer::Status::Ok) {
+        if (auto* cache = responseCache()) {
+            cache->bumpProductsVersion();
+        }
+        if (auto* reservations = stockReservations()) {
+            reservations->updateStock(productId, quantity);
+        }
+        if (auto* index = lowStockIndex()) {
+            index->updateStock(productId, quantity);
+        }
+    }
+    // UnknownProduct after the read below: deleted between the read and the retry
+    if (status != StockDeltaBuffer::Status::UnknownProduct || primed) {
+        done(status, quantity);
+        return;
+    }
+
+    // Not read yet: fetch the committed row, then try once more
+    drogon::app().getDbClient()->execSqlAsync(
+        "select * from products where product_id = ?",
+        [&deltas, productId, delta, done](const drogon::orm::Result& result) {
+            if (result.empty()) {
+                done(StockDeltaBuffer::Status::UnknownProduct, 0);
+                return;
+            }
+            drogon_model::sqlite3::Products product(result[0]);
+            deltas.prime(productId, product.getValueOfQuantityInStock());
+            if (auto* index = lowStockIndex()) {
+                product.setQuantityInStock(product.getValueOfQuantityInStock() +
+                                           deltas.pending(productId));
+                index->track(product);
+            }
+            addStockDelta(deltas, productId, delta, done, true);
+        },
+        [done](const drogon::orm::DrogonDbException& e) {
+            LOG_WARN << "Stock read for write-behind failed, writing directly: "
+                     << e.base().what();
+            done(StockDeltaBuffer::Status::NotReady, 0);
+        },
+        productId);
+}
+
+/// Apply an unkeyed stock adjustment through StockDeltaBuffer
+void adjustStockWriteBehind(StockDeltaBuffer& deltas,
+                            int64_t productId,
+                            int64_t delta,
+                            std::function<void(const HttpResponsePtr&)> callback) {
+    addStockDelta(
+        deltas, productId, delta,
+        [productId, delta, callback](StockDeltaBuffer::Status status, int64_t quantity) {
+            switch (status) {
+                case StockDeltaBuffer::Status::Ok: {
+                    std::string body;
+                    appendJsonRaw(body, "{\"delta\":");
+                    appendJsonInt(body, delta);
+                    appendJsonRaw(body, ",\"product_id\":");
+                    appendJsonInt(body, productId);
+                    appendJsonRaw(body, ",\"quantity_in_stock\":");
+                    appendJsonInt(body, quantity);
+                    body += '}';
+                    callback(newJsonBodyResponse(std::move(body), k200OK));
+                    return;
+                }
+                case StockDeltaBuffer::Status::InsufficientStock:
+                    callback(insufficientStockResponse(productId, delta, quantity, Json::Value()));
+                    return;
+                case StockDeltaBuffer::Status::UnknownProduct:
+                    callback(productNotFoundResponse(productId, Json::Value()));
+                    return;
+                case StockDeltaBuffer::Status::NotReady:
+                    adjustStockDirect(productId, delta, callback);
+                    return;
+            }
+        });
+}
+
+void appendCommitResult(std::string& out,
+                        const StockReservations::Hold& hold,
+                        int64_t quantityInStock) {
+    appendJsonRaw(out, "{\"product_id\":");
+    appendJsonInt(out, hold.productId);
+    appendJsonRaw(out, ",\"quantity\":");
+    appendJsonInt(out, hold.quantity);
+    appendJsonRaw(out, ",\"quantity_in_stock\":");
+    appendJsonInt(out, quantityInStock);
+    appendJsonRaw(out, ",\"reservation_id\":");
+    appendJsonInt(out, static_cast<int64_t>(hold.id));
+    out += '}';
+}
+
+/// Write a reservation's decrement with the guarded UPDATE
+void commitReservationDirect(StockReservations* reservations,
+                             const StockReservations::Hold& hold,
+                             std::function<void(const HttpResponsePtr&)> callback) {
+    // The held units are still counted as reserved while the decrement is written, so
+    // no other reservation can take them in the meantime
+    const int64_t delta = -hold.quantity;
+    const int64_t productId = hold.productId;
+    const bool announced = beginDirectStockWrite(productId, delta);
+    auto dbClient = drogon::app().getDbClient();
+    dbClient->execSqlAsync(
+        kAdjustStockSql,
+        [dbClient, callback, reservations, hold, productId, delta, announced](
+            const drogon::orm::Result& result) {
+            if (result.empty()) {
+                if (announced) {
+                    endDirectStockWrite(productId, delta);
+                }
+                // Stock was taken outside the reservations; this hold can never be honoured
+                reservations->finishCommit(hold.id, false);
+                reservations->release(hold.id);
+                Json::Value extra;
+                extra["reservation_id"] = static_cast<Json::UInt64>(hold.id);
+                rejectStockAdjustment(*dbClient, productId, delta, extra, callback);
+                return;
+            }
+            drogon_model::sqlite3::Products product(result[0]);
+            // Stock first, then the hold: availability is understated for a moment, never
+            // overstated
+            onProductWritten(product, result[0]["version"].as<int64_t>());
+            if (announced) {
+                endDirectStockWrite(productId, delta);
+            }
+            reservations->finishCommit(hold.id, true);
+            std::string body;
+            appendCommitResult(body, hold,
+                               product.getValueOfQuantityInStock() + pendingStock(productId));
+            callback(newJsonBodyResponse(std::move(body), k200OK));
+        },
+        [callback, reservations, hold, productId, delta, announced](
+            const drogon::orm::DrogonDbException& e) {
+            if (announced) {
+                endDirectStockWrite(productId, delta);
+            }
+            // Still held; the client may retry the commit or release the hold
+            reservations->finishCommit(hold.id, false);
+            Json::Value error;
+            error["error"] = "Failed to commit reservation";
+            error["message"] = e.base().what();
+            auto resp = HttpResponse::newHttpJsonResponse(error);
+            resp->setStatusCode(k500InternalServerError);
+            callback(resp);
+        },
+        delta,
+        productId,
+        delta + guardPendingStock(productId));
+}
+
+/**
+ * @brief Commit a reservation of a write-behind product through StockDeltaBuffer
+ *
+ * The decrement is checked like an unkeyed adjustment, pending restocks included, and
+ * the buffer's flush writes it.
+ */
+void commitReservationWriteBehind(StockDeltaBuffer& deltas,
+                                  StockReservations* reservations,
+                                  const StockReservations::Hold& hold,
+                                  std::function<void(const HttpResponsePtr&)> callback) {
+    addStockDelta(
+        deltas, hold.productId, -hold.quantity,
+        [reservations, hold, callback](StockDeltaBuffer::Status status, int64_t quantity) {
+            Json::Value extra;
+            extra["reservation_id"] = static_cast<Json::UInt64>(hold.id);
+            switch (status) {
+                case StockDeltaBuffer::Status::Ok: {
+                    // add() has already reported the decremented stock to the reservations
+                    reservations->finishCommit(hold.id, true);
+                    std::string body;
+                    appendCommitResult(body, hold, quantity);
+                    callback(newJsonBodyResponse(std::move(body), k200OK));
+                    return;
+                }
+                case StockDeltaBuffer::Status::InsufficientStock:
+                    reservations->finishCommit(hold.id, false);
+                    reservations->release(hold.id);
+                    callback(insufficientStockResponse(hold.productId, -hold.quantity, quantity,
+                                                       extra));
+                    return;
+                case StockDeltaBuffer::Status::UnknownProduct:
+                    reservations->finishCommit(hold.id, false);
+                    reservations->release(hold.id);
+                    callback(productNotFoundResponse(hold.productId, extra));
+                    return;
+                case StockDeltaBuffer::Status::NotReady:
+                    commitReservationDirect(reservations, hold, callback);
+                    return;
+            }
+        });
+}
+}  // namespace
+
+void ProductsController::onStockFlushed(const drogon_model::sqlite3::Products& product,
+                                        int64_t version) {
+    onProductWritten(product, version);
+}
 
 void ProductsController::getOne(const HttpRequestPtr& req,
                                 std::function<void(const HttpResponsePtr&)>&& callback,
                                 std::string&& id) {
     try {
         auto dbClient = drogon::app().getDbClient();
-        auto mapper = drogon::orm::Mapper<drogon_model::sqlite3::Products>(dbClient);
 
         int64_t productId = std::stoll(id);
-        mapper.findByPrimaryKey(
-            productId,
-            [callback](drogon_model::sqlite3::Products product) {
-                Json::Value response = product.toJson();
-                auto resp = HttpResponse::newHttpJsonResponse(response);
-                resp->setStatusCode(k200OK);
-                callback(resp);
+
+        uint64_t fieldMask = 0;
+        if (!parseProductFields(req, callback, fieldMask)) {
+            return;
+        }
+        const bool projected =
+            fieldMask != allColumnsMask<drogon_model::sqlite3::Products>();
+
+        CachedRead read;
+        if (tryServeCached(req, callback, read)) {
+            return;
+        }
+
+        auto* cache = productCache();
+        uint64_t fillToken = 0;
+        if (cache) {
+            ProductCache::EntryPtr cached;
+            if (cache->find(productId, cached)) {
+                if (!projected) {
+                    respondVersionedRow(req, read, cached->product, cached->version, callback);
+                    return;
+                }
+                auto product = cached->product;
+                mergePendingStock(product, productId);
+                std::string body;
+                body.reserve(kProductJsonSizeHint);
+                appendJson(body, product, fieldMask);
+                respondCached(req, read, std::move(body), {}, callback);
+                return;
+            }
+            fillToken = cache->fillToken(productId);
+        }
+
+        if (projected) {
+            // Narrowed rows are never put in the product cache, which holds full rows only
+            dbClient->execSqlAsync(
+                "select " + projectionSelectList<drogon_model::sqlite3::Products>(fieldMask) +
+                    " from " + drogon_model::sqlite3::Products::tableName +
+                    " where product_id = ?",
+                [req, callback, read, fieldMask,
+                 productId](const drogon::orm::Result& result) {
+                    if (result.empty()) {
+                        Json::Value error;
+                        error["error"] = "Product not found";
+                        auto resp = HttpResponse::newHttpJsonResponse(error);
+                        resp->setStatusCode(k404NotFound);
+                        callback(resp);
+                        return;
+                    }
+                    drogon_model::sqlite3::Products product;
+                    readProjectedRow(result[0], fieldMask, product);
+                    mergePendingStock(product, productId);
+                    std::string body;
+                    appendJson(body, product, fieldMask);
+                    respondCached(req, read, std::move(body), {}, callback);
+                },
+                [callback](const drogon::orm::DrogonDbException& e) {
+                    Json::Value error;
+                    error["error"] = "Failed to retrieve product";
+                    error["message"] = e.base().what();
+                    auto resp = HttpResponse::newHttpJsonResponse(error);
+                    resp->setStatusCode(k500InternalServerError);
+                    callback(resp);
+                },
+                productId);
+            return;
+        }
+
+        // select * rather than the Mapper's column list, so the version comes along
+        dbClient->execSqlAsync(
+            "select * from " + drogon_model::sqlite3::Products::tableName +
+                " where product_id = ?",
+            [req, callback, read, cache, productId,
+             fillToken](const drogon::orm::Result& result) {
+                if (result.empty()) {
+                    Json::Value error;
+                    error["error"] = "Product not found";
+                    auto resp = HttpResponse::newHttpJsonResponse(error);
+                    resp->setStatusCode(k404NotFound);
+                    callback(resp);
+                    return;
+                }
+                auto entry = readVersionedRow(result[0]);
+                respondVersionedRow(req, read, entry->product, entry->version, callback);
+                if (cache) {
+                    cache->fill(productId, std::move(entry), fillToken);
+                }
             },
             [callback](const drogon::orm::DrogonDbException& e) {
                 Json::Value error;
-                error["error"] = "Product not found";
+                error["error"] = "Failed to retrieve product";
                 error["message"] = e.base().what();
                 auto resp = HttpResponse::newHttpJsonResponse(error);
-                resp->setStatusCode(k404NotFound);
+                resp->setStatusCode(k500InternalServerError);
                 callback(resp);
-            });
+            },
+            productId);
     } catch (const std::exception& e) {
         Json::Value error;
-        error["error"] = "Invalid product ID";
+        error["error"] = "Invalid product ID";
+        auto resp = HttpResponse::newHttpJsonResponse(error);
+        resp->setStatusCode(k400BadRequest);
+        callback(resp);
+    }
+}
+
+void ProductsController::get(const HttpRequestPtr& req,
+                             std::function<void(const HttpResponsePtr&)>&& callback) {
+    size_t limit = 0;
+    int64_t afterId = 0;
+    std::string error;
+    if (!parsePageLimit(req->getParameter("limit"), limit, error) ||
+        !decodeProductCursor(req->getParameter("after"), afterId, error)) {
+        Json::Value response;
+        response["error"] = "Invalid pagination parameters";
+        response["message"] = error;
+        auto resp = HttpResponse::newHttpJsonResponse(response);
+        resp->setStatusCode(k400BadRequest);
+        callback(resp);
+        return;
+    }
+
+    drogon::orm::Criteria criteria;
+    QuantityFilter quantity;
+    if (!buildProductFilter(req, afterId, criteria, quantity, error)) {
+        Json::Value response;
+        response["error"] = "Invalid filter parameters";
+        response["message"] = error;
+        auto resp = HttpResponse::newHttpJsonResponse(response);
+        resp->setStatusCode(k400BadRequest);
+        callback(resp);
+        return;
+    }
+
+    uint64_t fieldMask = 0;
+    if (!parseProductFields(req, callback, fieldMask)) {
+        return;
+    }
+
+    CachedRead read;
+    if (tryServeCached(req, callback, read)) {
+        return;
+    }
+
+    auto dbClient = drogon::app().getDbClient();
+    auto onError = [callback](const drogon::orm::DrogonDbException& e) {
+        Json::Value error;
+        error["error"] = "Failed to retrieve products";
+        error["message"] = e.base().what();
+        auto resp = HttpResponse::newHttpJsonResponse(error);
+        resp->setStatusCode(k500InternalServerError);
+        callback(resp);
+    };
+
+    if (fieldMask != allColumnsMask<drogon_model::sqlite3::Products>()) {
+        // product_id is always read (bit 0) so the cursor can be built, but only
+        // emitted when it was asked for
+        uint64_t selectMask = fieldMask | 1;
+        if (quantity.recheck) {
+            // QuantityFilter::matches() reads both, whether or not they are emitted
+            using Products = drogon_model::sqlite3::Products;
+            selectMask |= columnMask<Products>(Products::Cols::_quantity_in_stock) |
+                          columnMask<Products>(Products::Cols::_reorder_threshold);
+        }
+        // Same statement the Mapper would issue, minus the unrequested columns
+        std::string sql =
+            selectProductsWhere(projectionSelectList<drogon_model::sqlite3::Products>(selectMask),
+                                criteria) +
+            " order by product_id limit ?";
+        auto binder = *dbClient << std::move(sql);
+        criteria.outputArgs(binder);
+        binder << static_cast<int64_t>(limit + 1);
+        binder >> [req, callback, read, limit, fieldMask, selectMask,
+                   quantity](const drogon::orm::Result& result) {
+            std::string body;
+            body += '[';
+            drogon_model::sqlite3::Products product;
+            size_t scanned = 0, emitted = 0;
+            while (scanned < result.size() && emitted < limit) {
+                product = drogon_model::sqlite3::Products();
+                readProjectedRow(result[scanned++], selectMask, product);
+                mergePendingStock(product, product.getValueOfProductId());
+                if (quantity.recheck && !quantity.matches(product)) {
+                    continue;
+                }
+                if (emitted++ > 0) {
+                    body += ',';
+                }
+                appendJson(body, product, fieldMask);
+            }
+            body += ']';
+            std::vector<std::pair<std::string, std::string>> headers;
+            // The cursor follows the last row read, so dropped rows are not read again
+            if (scanned < result.size() || result.size() > limit) {
+                headers.emplace_back("X-Next-Cursor",
+                                     encodeProductCursor(product.getValueOfProductId()));
+            }
+            respondCached(req, read, std::move(body), std::move(headers), callback);
+        };
+        binder >> std::move(onError);
+        return;
+    }
+
+    auto mapper = drogon::orm::Mapper<drogon_model::sqlite3::Products>(dbClient);
+
+    // Keyset pagination over the rowid: one extra row tells us whether another page exists
+    mapper.orderBy(drogon_model::sqlite3::Products::Cols::_product_id)
+        .limit(limit + 1)
+        .findBy(
+            criteria,
+            [req, callback, read, limit, quantity](
+                const std::vector<drogon_model::sqlite3::Products>& products) {
+                std::vector<drogon_model::sqlite3::Products> merged;
+                const drogon_model::sqlite3::Products* page =
+                    withPendingStock(products.data(), products.size(), merged);
+                size_t count = std::min(products.size(), limit);
+                size_t scanned = count;
+                std::vector<drogon_model::sqlite3::Products> matching;
+                if (quantity.recheck) {
+                    // Rows a pending delta moved out of the quantity range drop out of the page
+                    for (scanned = 0; scanned < products.size() && matching.size() < limit;
+                         ++scanned) {
+                        if (quantity.matches(page[scanned])) {
+                            matching.push_back(page[scanned]);
+                        }
+                    }
+                    page = matching.data();
+                    count = matching.size();
+                }
+                std::string body;
+                body.reserve(count * kProductJsonSizeHint + 2);
+                appendJsonArray(body, page, count);
+                std::vector<std::pair<std::string, std::string>> headers;
+                // The cursor follows the last row read, so dropped rows are not read again
+                if (scanned < products.size() || products.size() > limit) {
+                    headers.emplace_back(
+                        "X-Next-Cursor",
+                        encodeProductCursor(products[scanned - 1].getValueOfProductId()));
+                }
+                respondCached(req, read, std::move(body), std::move(headers), callback);
+            },
+            std::move(onError));
+}
+
+void ProductsController::exportCatalog(const HttpRequestPtr& req,
+                                       std::function<void(const HttpResponsePtr&)>&& callback) {
+    const auto& formatParam = req->getParameter("format");
+    if (!formatParam.empty() && formatParam != "ndjson" && formatParam != "csv") {
+        Json::Value error;
+        error["error"] = "Invalid export format";
+        error["message"] = "format must be one of: ndjson, csv";
+        auto resp = HttpResponse::newHttpJsonResponse(error);
+        resp->setStatusCode(k400BadRequest);
+        callback(resp);
+        return;
+    }
+    const bool csv = formatParam == "csv";
+
+    const auto format = csv ? ExportFormat::Csv : ExportFormat::NdJson;
+    auto resp = HttpResponse::newAsyncStreamResponse(
+        [dbClient = drogon::app().getDbClient(), format](drogon::ResponseStreamPtr stream) {
+            std::make_shared<ProductExportStream>(dbClient, format, std::move(stream))->start();
+        });
+    if (csv) {
+        resp->setContentTypeCode(CT_TEXT_CSV);
+        resp->addHeader("Content-Disposition", "attachment; filename=\"products.csv\"");
+    } else {
+        resp->setContentTypeString("application/x-ndjson");
+    }
+    callback(resp);
+}
+
+void ProductsController::lowStock(const HttpRequestPtr& req,
+                                  std::function<void(const HttpResponsePtr&)>&& callback) {
+    size_t limit = 0;
+    std::string error;
+    if (!parsePageLimit(req->getParameter("limit"), limit, error)) {
+        Json::Value response;
+        response["error"] = "Invalid limit";
+        response["message"] = error;
+        auto resp = HttpResponse::newHttpJsonResponse(response);
+        resp->setStatusCode(k400BadRequest);
+        callback(resp);
+        return;
+    }
+
+    auto* index = lowStockIndex();
+    if (!index || !index->ready()) {
+        Json::Value response;
+        response["error"] = "Low-stock index unavailable";
+        response["message"] = index ? "The index is still loading" : "LowStockIndex is not enabled";
+        auto resp = HttpResponse::newHttpJsonResponse(response);
+        resp->setStatusCode(k503ServiceUnavailable);
+        callback(resp);
+        return;
+    }
+
+    // Entries already count the pending write-behind deltas: onProductWritten() merges
+    // them and every buffered adjustment moves its product through updateStock()
+    std::string body;
+    body += '[';
+    bool first = true;
+    for (const auto& entry : index->lowest(limit)) {
+        if (!first) {
+            body += ',';
+        }
+        first = false;
+        // Keys in the same sorted order as the model writers
+        appendJsonRaw(body, "{\"name\":");
+        appendJsonString(body, entry.name);
+        appendJsonRaw(body, ",\"product_id\":");
+        appendJsonInt(body, entry.productId);
+        appendJsonRaw(body, ",\"quantity_in_stock\":");
+        appendJsonInt(body, entry.quantityInStock);
+        appendJsonRaw(body, ",\"reorder_threshold\":");
+        appendJsonInt(body, entry.reorderThreshold);
+        appendJsonRaw(body, ",\"shortfall\":");
+        appendJsonInt(body, entry.reorderThreshold - entry.quantityInStock);
+        appendJsonRaw(body, ",\"sku\":");
+        appendJsonString(body, entry.sku);
+        body += '}';
+    }
+    body += ']';
+    callback(newJsonBodyResponse(std::move(body), k200OK));
+}
+
+void ProductsController::batchGet(const HttpRequestPtr& req,
+                                  std::function<void(const HttpResponsePtr&)>&& callback) {
+    auto badRequest = [&callback](const std::string& message) {
+        Json::Value error;
+        error["error"] = "Invalid batch get request";
+        error["message"] = message;
         auto resp = HttpResponse::newHttpJsonResponse(error);
         resp->setStatusCode(k400BadRequest);
         callback(resp);
-    }
-}
+    };
 
-void ProductsController::get(const HttpRequestPtr& req,
-                             std::function<void(const HttpResponsePtr&)>&& callback) {
-    auto dbClient = drogon::app().getDbClient();
-    auto mapper = drogon::orm::Mapper<drogon_model::sqlite3::Products>(dbClient);
+    auto json = requestJson(req);
+    if (!json || !json->isObject() || json->isMember("ids") == json->isMember("skus")) {
+        badRequest("Body must be an object with either an \"ids\" or a \"skus\" array");
+        return;
+    }
+    auto state = std::make_shared<BatchGetState>();
+    state->bySku = json->isMember("skus");
+    const Json::Value& keys = (*json)[state->bySku ? "skus" : "ids"];
+    if (!keys.isArray() || keys.empty() || keys.size() > kMaxPageLimit) {
+        badRequest(std::string(state->bySku ? "skus" : "ids") + " must be an array of 1 to " +
+                   std::to_string(kMaxPageLimit) + " entries");
+        return;
+    }
 
-    mapper.findAll(
-        [callback](const std::vector<drogon_model::sqlite3::Products>& products) {
-            Json::Value response(Json::arrayValue);
-            for (const auto& product : products) {
-                response.append(product.toJson());
+    // Only distinct keys that the product cache cannot answer go to SQLite
+    auto* cache = productCache();
+    std::vector<int64_t> missingIds;
+    std::vector<std::string> missingSkus;
+    std::unordered_set<std::string> seenSkus;
+    for (const auto& key : keys) {
+        if (state->bySku) {
+            if (!key.isString()) {
+                badRequest("skus must contain only strings");
+                return;
             }
-            auto resp = HttpResponse::newHttpJsonResponse(response);
-            resp->setStatusCode(k200OK);
-            callback(resp);
-        },
-        [callback](const drogon::orm::DrogonDbException& e) {
-            Json::Value error;
-            error["error"] = "Failed to retrieve products";
-            error["message"] = e.base().what();
-            auto resp = HttpResponse::newHttpJsonResponse(error);
-            resp->setStatusCode(k500InternalServerError);
-            callback(resp);
-        });
+            state->skus.push_back(key.asString());
+            if (seenSkus.insert(state->skus.back()).second) {
+                missingSkus.push_back(state->skus.back());
+            }
+        } else {
+            if (!key.isInt64()) {
+                badRequest("ids must contain only integers");
+                return;
+            }
+            const int64_t productId = key.asInt64();
+            state->ids.push_back(productId);
+            if (state->foundById.count(productId) || state->fillTokens.count(productId)) {
+                continue;
+            }
+            ProductCache::EntryPtr cached;
+            if (cache && cache->find(productId, cached)) {
+                state->foundById.emplace(productId,
+                                         ProductCache::ProductPtr(cached, &cached->product));
+                continue;
+            }
+            state->fillTokens.emplace(productId, cache ? cache->fillToken(productId) : 0);
+            missingIds.push_back(productId);
+        }
+    }
+    for (size_t begin = 0; begin < missingIds.size(); begin += kBatchGetChunkKeys) {
+        const size_t end = std::min(missingIds.size(), begin + kBatchGetChunkKeys);
+        const std::vector<int64_t> chunk(missingIds.begin() + begin, missingIds.begin() + end);
+        state->chunks.emplace_back(drogon_model::sqlite3::Products::Cols::_product_id,
+                                   drogon::orm::CompareOperator::In, chunk);
+    }
+    for (size_t begin = 0; begin < missingSkus.size(); begin += kBatchGetChunkKeys) {
+        const size_t end = std::min(missingSkus.size(), begin + kBatchGetChunkKeys);
+        const std::vector<std::string> chunk(missingSkus.begin() + begin,
+                                             missingSkus.begin() + end);
+        state->chunks.emplace_back(drogon_model::sqlite3::Products::Cols::_sku,
+                                   drogon::orm::CompareOperator::In, chunk);
+    }
+    state->callback = std::move(callback);
+    runBatchGet(state, 0);
 }
+
 void ProductsController::create(const HttpRequestPtr& req,
                                 std::function<void(const HttpResponsePtr&)>&& callback) {
     try {
-        auto json = req->getJsonObject();
+        auto json = requestJson(req);
         if (!json) {
             Json::Value error;
             error["error"] = "Invalid JSON";
@@ -81,6 +2091,88 @@ void ProductsController::create(const HttpRequestPtr& req,
             return;
         }
 
+        IdempotentWrite idempotency;
+        if (!checkIdempotencyKey(req, callback, idempotency)) {
+            return;
+        }
+        if (idempotency.store) {
+            // Keyed creates commit alone, together with the key's record
+            drogon_model::sqlite3::Products product(*json);
+            runWriteTransaction(
+                idempotency, std::move(callback),
+                [product](const std::shared_ptr<drogon::orm::Transaction>& transaction,
+                          WriteFinish finish) {
+                    drogon::orm::Mapper<drogon_model::sqlite3::Products> mapper(transaction);
+                    mapper.insert(
+                        product,
+                        [finish](drogon_model::sqlite3::Products newProduct) {
+                            std::string body;
+                            body.reserve(kProductJsonSizeHint);
+                            appendJson(body, newProduct);
+                            finish(newJsonBodyResponse(std::move(body), k201Created),
+                                   [newProduct]() { onProductWritten(newProduct, 0); });
+                        },
+                        [finish](const drogon::orm::DrogonDbException& e) {
+                            Json::Value error;
+                            error["error"] = "Failed to create product";
+                            error["message"] = e.base().what();
+                            auto resp = HttpResponse::newHttpJsonResponse(error);
+                            resp->setStatusCode(k500InternalServerError);
+                            finish(resp, nullptr);
+                        });
+                });
+            return;
+        }
+
+        // Inserts with a client-chosen product_id keep the direct path; the coalescer
+        // only writes the columns SQLite does not assign itself
+        auto* coalescer = writeCoalescer();
+        if (coalescer && !json->isMember("product_id")) {
+            std::string message;
+            if (!json->isObject() ||
+                !drogon_model::sqlite3::Products::validateJsonForCreation(*json, message)) {
+                Json::Value error;
+                error["error"] = "Invalid product data";
+                error["message"] = json->isObject() ? message : "Product must be a JSON object";
+                auto resp = HttpResponse::newHttpJsonResponse(error);
+                resp->setStatusCode(k400BadRequest);
+                callback(resp);
+                return;
+            }
+            Json::Value product = *json;
+            coalescer->submit(
+                std::move(product),
+                [callback = std::move(callback),
+                 json](const WriteCoalescer::Outcome& outcome) {
+                    if (outcome.status == WriteCoalescer::Outcome::Status::Created) {
+                        drogon_model::sqlite3::Products newProduct(*json);
+                        newProduct.setProductId(outcome.productId);
+                        onProductWritten(newProduct, 0);
+                        std::string body;
+                        body.reserve(kProductJsonSizeHint);
+                        appendJson(body, newProduct);
+                        callback(newJsonBodyResponse(std::move(body), k201Created));
+                        return;
+                    }
+                    Json::Value error;
+                    if (outcome.status == WriteCoalescer::Outcome::Status::Conflict) {
+                        error["error"] = "Product already exists";
+                        error["message"] =
+                            "A product with sku " + (*json)["sku"].asString() + " already exists";
+                    } else {
+                        error["error"] = "Failed to create product";
+                        error["message"] = outcome.message;
+                    }
+                    auto resp = HttpResponse::newHttpJsonResponse(error);
+                    resp->setStatusCode(
+                        outcome.status == WriteCoalescer::Outcome::Status::Conflict
+                            ? k409Conflict
+                            : k500InternalServerError);
+                    callback(resp);
+                });
+            return;
+        }
+
         auto dbClient = drogon::app().getDbClient();
         auto mapper = drogon::orm::Mapper<drogon_model::sqlite3::Products>(dbClient);
 
@@ -89,10 +2181,11 @@ void ProductsController::create(const HttpRequestPtr& req,
         mapper.insert(
             product,
             [callback](drogon_model::sqlite3::Products newProduct) {
-                Json::Value response = newProduct.toJson();
-                auto resp = HttpResponse::newHttpJsonResponse(response);
-                resp->setStatusCode(k201Created);
-                callback(resp);
+                onProductWritten(newProduct, 0);
+                std::string body;
+                body.reserve(kProductJsonSizeHint);
+                appendJson(body, newProduct);
+                callback(newJsonBodyResponse(std::move(body), k201Created));
             },
             [callback](const drogon::orm::DrogonDbException& e) {
                 Json::Value error;
@@ -111,9 +2204,217 @@ void ProductsController::create(const HttpRequestPtr& req,
         callback(resp);
     }
 }
+void ProductsController::createBulk(const HttpRequestPtr& req,
+                                    std::function<void(const HttpResponsePtr&)>&& callback) {
+    auto json = requestJson(req);
+    if (!json || !json->isArray() || json->empty() || json->size() > kMaxBulkItems) {
+        Json::Value error;
+        error["error"] = "Invalid bulk request";
+        error["message"] =
+            "Body must be an array of 1 to " + std::to_string(kMaxBulkItems) + " products";
+        auto resp = HttpResponse::newHttpJsonResponse(error);
+        resp->setStatusCode(k400BadRequest);
+        callback(resp);
+        return;
+    }
+
+    // Every item is validated before anything is written, so a bad item never leaves
+    // half a batch behind
+    auto state = std::make_shared<BulkInsertState>();
+    state->items.reserve(json->size());
+    Json::Value errors(Json::arrayValue);
+    for (Json::ArrayIndex i = 0; i < json->size(); ++i) {
+        const Json::Value& item = (*json)[i];
+        std::string message;
+        if (!item.isObject()) {
+            message = "Product must be a JSON object";
+        } else if (validateProductData(item, message) &&
+                   drogon_model::sqlite3::Products::validateJsonForCreation(item, message) &&
+                   !state->indexBySku.emplace(item["sku"].asString(), i).second) {
+            message = "Duplicate sku in request: " + item["sku"].asString();
+        }
+        if (!message.empty()) {
+            Json::Value itemError;
+            itemError["index"] = i;
+            itemError["message"] = message;
+            errors.append(itemError);
+        }
+        state->items.push_back(item);
+    }
+    if (!errors.empty()) {
+        Json::Value error;
+        error["error"] = "Invalid product data";
+        error["items"] = errors;
+        auto resp = HttpResponse::newHttpJsonResponse(error);
+        resp->setStatusCode(k400BadRequest);
+        callback(resp);
+        return;
+    }
+    state->ids.assign(state->items.size(), 0);
+    state->callback = std::move(callback);
+
+    drogon::app().getDbClient()->newTransactionAsync(
+        [state](const std::shared_ptr<drogon::orm::Transaction>& transaction) {
+            if (!transaction) {
+                Json::Value error;
+                error["error"] = "Failed to create products";
+                error["message"] = "Could not start a transaction";
+                auto resp = HttpResponse::newHttpJsonResponse(error);
+                resp->setStatusCode(k500InternalServerError);
+                state->callback(resp);
+                return;
+            }
+            state->transaction = transaction;
+            insertBulkChunk(state, 0);
+        });
+}
+
 void ProductsController::updateOne(const HttpRequestPtr& req,
                                    std::function<void(const HttpResponsePtr&)>&& callback,
-                                   std::string&& id) {}
+                                   std::string&& id) {
+    auto badRequest = [&callback](const std::string& message) {
+        Json::Value error;
+        error["error"] = "Invalid product data";
+        error["message"] = message;
+        auto resp = HttpResponse::newHttpJsonResponse(error);
+        resp->setStatusCode(k400BadRequest);
+        callback(resp);
+    };
+
+    int64_t productId = 0;
+    try {
+        productId = std::stoll(id);
+    } catch (const std::exception& e) {
+        Json::Value error;
+        error["error"] = "Invalid product ID";
+        auto resp = HttpResponse::newHttpJsonResponse(error);
+        resp->setStatusCode(k400BadRequest);
+        callback(resp);
+        return;
+    }
+
+    auto json = requestJson(req);
+    if (!json || !json->isObject()) {
+        badRequest("Body must be a JSON object");
+        return;
+    }
+    // PUT and PATCH both update only the fields present in the body
+    if (json->isMember("product_id") &&
+        (!(*json)["product_id"].isInt64() || (*json)["product_id"].asInt64() != productId)) {
+        badRequest("product_id cannot be changed");
+        return;
+    }
+    std::string error;
+    if (!validateFields(drogon_model::sqlite3::kProductsFieldRules, *json, FieldCheck::Update,
+                        error, UnknownFields::Reject)) {
+        badRequest(error);
+        return;
+    }
+    Json::Value fields = *json;
+    fields["product_id"] = static_cast<Json::Int64>(productId);
+
+    // updateByJson() converts the supplied values to their column types; only those
+    // columns are written
+    drogon_model::sqlite3::Products product;
+    try {
+        product.updateByJson(fields);
+    } catch (const std::exception& e) {
+        badRequest(e.what());
+        return;
+    }
+
+    // If-Match turns the update into a compare-and-set on the row version. Both forms are
+    // a single UPDATE ... RETURNING, so the write holds no lock beyond its own statement.
+    bool anyVersion = false;
+    std::vector<int64_t> versions;
+    const bool conditional =
+        parseIfMatch(req->getHeader("if-match"), productId, anyVersion, versions);
+    std::string sql = "update " + drogon_model::sqlite3::Products::tableName + " set ";
+    std::vector<size_t> columns;
+    for (size_t i = 0; i < drogon_model::sqlite3::Products::getColumnNumber(); ++i) {
+        const std::string& name = drogon_model::sqlite3::Products::getColumnName(i);
+        // The timestamps are the server's; validateFields() refuses them from the client
+        if (name != "product_id" && name != "created_at" && name != "updated_at" &&
+            fields.isMember(name)) {
+            sql += name + " = ?, ";
+            columns.push_back(i);
+        }
+    }
+    sql += "updated_at = CURRENT_TIMESTAMP, version = version + 1 where product_id = ?";
+    if (conditional && !anyVersion) {
+        // A header naming no version of this row leaves "in ()", which matches nothing
+        sql += " and version in (";
+        for (size_t i = 0; i < versions.size(); ++i) {
+            sql += i == 0 ? "?" : ",?";
+        }
+        sql += ')';
+    }
+    sql += " returning *";
+
+    auto dbClient = drogon::app().getDbClient();
+    auto onError = [callback](const drogon::orm::DrogonDbException& e) {
+        Json::Value error;
+        error["error"] = "Failed to update product";
+        error["message"] = e.base().what();
+        auto resp = HttpResponse::newHttpJsonResponse(error);
+        resp->setStatusCode(k500InternalServerError);
+        callback(resp);
+    };
+    auto binder = *dbClient << std::move(sql);
+    for (size_t column : columns) {
+        bindProductColumn(binder, product, column);
+    }
+    binder << productId;
+    for (int64_t version : versions) {
+        binder << version;
+    }
+    binder >> [callback, dbClient, productId, conditional,
+               onError](const drogon::orm::Result& result) {
+        if (!result.empty()) {
+            auto entry = readVersionedRow(result[0]);
+            onProductWritten(entry->product, entry->version);
+            std::string body;
+            body.reserve(kProductJsonSizeHint);
+            appendJson(body, entry->product);
+            auto resp = newJsonBodyResponse(std::move(body), k200OK);
+            resp->addHeader("ETag", makeRowEtag(productId, entry->version));
+            callback(resp);
+            return;
+        }
+        if (!conditional) {
+            Json::Value error;
+            error["error"] = "Product not found";
+            auto resp = HttpResponse::newHttpJsonResponse(error);
+            resp->setStatusCode(k404NotFound);
+            callback(resp);
+            return;
+        }
+        // Nothing matched: either the row is gone or another writer got there first
+        dbClient->execSqlAsync(
+            "select version from " + drogon_model::sqlite3::Products::tableName +
+                " where product_id = ?",
+            [callback, productId](const drogon::orm::Result& current) {
+                Json::Value error;
+                if (current.empty()) {
+                    error["error"] = "Product not found";
+                    auto resp = HttpResponse::newHttpJsonResponse(error);
+                    resp->setStatusCode(k404NotFound);
+                    callback(resp);
+                    return;
+                }
+                error["error"] = "Precondition failed";
+                error["message"] = "Product has been modified since the If-Match version";
+                auto resp = HttpResponse::newHttpJsonResponse(error);
+                resp->setStatusCode(k412PreconditionFailed);
+                resp->addHeader("ETag",
+                                makeRowEtag(productId, current[0]["version"].as<int64_t>()));
+                callback(resp);
+            },
+            onError,
+            productId);
+    };
+    binder >> std::move(onError);
+}
 
 /*
 void ProductsController::update(const HttpRequestPtr &req,
@@ -124,4 +2425,428 @@ void ProductsController::update(const HttpRequestPtr &req,
 
 void ProductsController::deleteOne(const HttpRequestPtr& req,
                                    std::function<void(const HttpResponsePtr&)>&& callback,
-                                   std::string&& id) {}
+                                   std::string&& id) {
+    int64_t productId = 0;
+    try {
+        productId = std::stoll(id);
+    } catch (const std::exception& e) {
+        Json::Value error;
+        error["error"] = "Invalid product ID";
+        auto resp = HttpResponse::newHttpJsonResponse(error);
+        resp->setStatusCode(k400BadRequest);
+        callback(resp);
+        return;
+    }
+
+    auto dbClient = drogon::app().getDbClient();
+    auto mapper = drogon::orm::Mapper<drogon_model::sqlite3::Products>(dbClient);
+    mapper.deleteByPrimaryKey(
+        productId,
+        [callback, productId](size_t count) {
+            if (count == 0) {
+                Json::Value error;
+                error["error"] = "Product not found";
+                auto resp = HttpResponse::newHttpJsonResponse(error);
+                resp->setStatusCode(k404NotFound);
+                callback(resp);
+                return;
+            }
+            onProductDeleted(productId);
+            auto resp = HttpResponse::newHttpResponse();
+            resp->setStatusCode(k204NoContent);
+            callback(resp);
+        },
+        [callback](const drogon::orm::DrogonDbException& e) {
+            Json::Value error;
+            error["error"] = "Failed to delete product";
+            error["message"] = e.base().what();
+            auto resp = HttpResponse::newHttpJsonResponse(error);
+            resp->setStatusCode(k500InternalServerError);
+            callback(resp);
+        });
+}
+
+void ProductsController::adjustStock(const HttpRequestPtr& req,
+                                     std::function<void(const HttpResponsePtr&)>&& callback,
+                                     std::string&& id) {
+    auto badRequest = [&callback](const std::string& message) {
+        Json::Value error;
+        error["error"] = "Invalid adjustment";
+        error["message"] = message;
+        auto resp = HttpResponse::newHttpJsonResponse(error);
+        resp->setStatusCode(k400BadRequest);
+        callback(resp);
+    };
+
+    int64_t productId = 0;
+    try {
+        productId = std::stoll(id);
+    } catch (const std::exception& e) {
+        badRequest("Invalid product ID");
+        return;
+    }
+    auto json = requestJson(req);
+    if (!json || !json->isObject()) {
+        badRequest("Body must be a JSON object with an integer delta");
+        return;
+    }
+    int64_t delta = 0;
+    std::string message;
+    if (!parseStockDelta((*json)["delta"], delta, message)) {
+        badRequest(message);
+        return;
+    }
+
+    IdempotentWrite idempotency;
+    if (!checkIdempotencyKey(req, callback, idempotency)) {
+        return;
+    }
+    if (idempotency.store) {
+        // Keyed: the same guarded statement, in a transaction with the key's record
+        const bool announced = beginDirectStockWrite(productId, delta);
+        auto answer = [announced, productId, delta, callback = std::move(callback)](
+                          const HttpResponsePtr& resp) {
+            if (announced) {
+                endDirectStockWrite(productId, delta);
+            }
+            callback(resp);
+        };
+        runWriteTransaction(
+            idempotency, std::move(answer),
+            [productId, delta](const std::shared_ptr<drogon::orm::Transaction>& transaction,
+                               WriteFinish finish) {
+                transaction->execSqlAsync(
+                    kAdjustStockSql,
+                    [transaction, finish, productId, delta](const drogon::orm::Result& result) {
+                        if (result.empty()) {
+                            rejectStockAdjustment(*transaction, productId, delta, Json::Value(),
+                                                  [finish](const HttpResponsePtr& resp) {
+                                                      finish(resp, nullptr);
+                                                  });
+                            return;
+                        }
+                        drogon_model::sqlite3::Products product(result[0]);
+                        const int64_t version = result[0]["version"].as<int64_t>();
+                        std::string body;
+                        appendAdjustResult(body, product, delta);
+                        finish(newJsonBodyResponse(std::move(body), k200OK),
+                               [product, version]() { onProductWritten(product, version); });
+                    },
+                    [finish](const drogon::orm::DrogonDbException& e) {
+                        Json::Value error;
+                        error["error"] = "Failed to adjust stock";
+                        error["message"] = e.base().what();
+                        auto resp = HttpResponse::newHttpJsonResponse(error);
+                        resp->setStatusCode(k500InternalServerError);
+                        finish(resp, nullptr);
+                    },
+                    delta,
+                    productId,
+                    delta + guardPendingStock(productId));
+            });
+        return;
+    }
+
+    auto* deltas = stockDeltaBuffer();
+    if (deltas && deltas->covers(productId)) {
+        adjustStockWriteBehind(*deltas, productId, delta, std::move(callback));
+        return;
+    }
+    adjustStockDirect(productId, delta, std::move(callback));
+}
+
+void ProductsController::adjustStockBatch(const HttpRequestPtr& req,
+                                          std::function<void(const HttpResponsePtr&)>&& callback) {
+    auto json = requestJson(req);
+    const Json::Value* adjustments = json && json->isObject() ? &(*json)["adjustments"] : nullptr;
+    if (!adjustments || !adjustments->isArray() || adjustments->empty() ||
+        adjustments->size() > kMaxBatchAdjustments) {
+        Json::Value error;
+        error["error"] = "Invalid adjustment";
+        error["message"] = "Body must be {\"adjustments\": [...]} with 1 to " +
+                           std::to_string(kMaxBatchAdjustments) + " items";
+        auto resp = HttpResponse::newHttpJsonResponse(error);
+        resp->setStatusCode(k400BadRequest);
+        callback(resp);
+        return;
+    }
+
+    auto state = std::make_shared<AdjustBatchState>();
+    state->adjustments.reserve(adjustments->size());
+    Json::Value errors(Json::arrayValue);
+    for (Json::ArrayIndex i = 0; i < adjustments->size(); ++i) {
+        const Json::Value& item = (*adjustments)[i];
+        int64_t delta = 0;
+        std::string message;
+        if (!item.isObject() || !item["product_id"].isInt64()) {
+            message = "product_id must be an integer";
+        } else if (parseStockDelta(item["delta"], delta, message)) {
+            state->adjustments.emplace_back(item["product_id"].asInt64(), delta);
+            continue;
+        }
+        Json::Value itemError;
+        itemError["index"] = i;
+        itemError["message"] = message;
+        errors.append(itemError);
+    }
+    if (!errors.empty()) {
+        Json::Value error;
+        error["error"] = "Invalid adjustment";
+        error["items"] = errors;
+        auto resp = HttpResponse::newHttpJsonResponse(error);
+        resp->setStatusCode(k400BadRequest);
+        callback(resp);
+        return;
+    }
+    state->rows.reserve(state->adjustments.size());
+    state->versions.reserve(state->adjustments.size());
+
+    IdempotentWrite idempotency;
+    if (!checkIdempotencyKey(req, callback, idempotency)) {
+        return;
+    }
+    for (const auto& [productId, delta] : state->adjustments) {
+        if (beginDirectStockWrite(productId, delta)) {
+            state->announced.emplace_back(productId, delta);
+        }
+    }
+    // The response is sent after onProductWritten() on success, and on every failure
+    auto answer = [state, callback = std::move(callback)](const HttpResponsePtr& resp) {
+        for (const auto& [productId, delta] : state->announced) {
+            endDirectStockWrite(productId, delta);
+        }
+        state->announced.clear();
+        callback(resp);
+    };
+    runWriteTransaction(idempotency, std::move(answer),
+                        [state](const std::shared_ptr<drogon::orm::Transaction>& transaction,
+                                WriteFinish finish) {
+                            state->transaction = transaction;
+                            state->finish = std::move(finish);
+                            applyBatchAdjustment(state, 0);
+                        });
+}
+
+void ProductsController::upsertBySku(const HttpRequestPtr& req,
+                                     std::function<void(const HttpResponsePtr&)>&& callback) {
+    auto json = requestJson(req);
+    if (!json || !json->isArray() || json->empty() || json->size() > kMaxBulkItems) {
+        Json::Value error;
+        error["error"] = "Invalid upsert request";
+        error["message"] =
+            "Body must be an array of 1 to " + std::to_string(kMaxBulkItems) + " products";
+        auto resp = HttpResponse::newHttpJsonResponse(error);
+        resp->setStatusCode(k400BadRequest);
+        callback(resp);
+        return;
+    }
+
+    // Any item may turn into an insert, so every item needs the creation fields
+    auto state = std::make_shared<UpsertState>();
+    state->items.reserve(json->size());
+    Json::Value errors(Json::arrayValue);
+    for (Json::ArrayIndex i = 0; i < json->size(); ++i) {
+        const Json::Value& item = (*json)[i];
+        std::string message;
+        if (!item.isObject()) {
+            message = "Product must be a JSON object";
+        } else if (validateProductData(item, message) &&
+                   drogon_model::sqlite3::Products::validateJsonForCreation(item, message) &&
+                   !state->indexBySku.emplace(item["sku"].asString(), i).second) {
+            message = "Duplicate sku in request: " + item["sku"].asString();
+        }
+        if (!message.empty()) {
+            Json::Value itemError;
+            itemError["index"] = i;
+            itemError["message"] = message;
+            errors.append(itemError);
+        }
+        state->items.push_back(item);
+    }
+    if (!errors.empty()) {
+        Json::Value error;
+        error["error"] = "Invalid product data";
+        error["items"] = errors;
+        auto resp = HttpResponse::newHttpJsonResponse(error);
+        resp->setStatusCode(k400BadRequest);
+        callback(resp);
+        return;
+    }
+    state->rows.resize(state->items.size());
+    state->versions.resize(state->items.size());
+
+    runWriteTransaction(
+        IdempotentWrite(), std::move(callback),
+        [state](const std::shared_ptr<drogon::orm::Transaction>& transaction, WriteFinish finish) {
+            state->transaction = transaction;
+            state->finish = std::move(finish);
+            state->transaction->execSqlAsync(
+                "select coalesce(max(product_id), 0) as max_id from products",
+                [state](const drogon::orm::Result& result) {
+                    state->maxIdBefore = result[0]["max_id"].as<int64_t>();
+                    upsertChunk(state, 0);
+                },
+                [state](const drogon::orm::DrogonDbException& e) {
+                    Json::Value error;
+                    error["error"] = "Failed to upsert products";
+                    error["message"] = e.base().what();
+                    auto resp = HttpResponse::newHttpJsonResponse(error);
+                    resp->setStatusCode(k500InternalServerError);
+                    state->transaction.reset();
+                    state->finish(resp, nullptr);
+                });
+        });
+}
+
+void ProductsController::availability(const HttpRequestPtr& req,
+                                      std::function<void(const HttpResponsePtr&)>&& callback,
+                                      std::string&& id) {
+    int64_t productId = 0;
+    try {
+        productId = std::stoll(id);
+    } catch (const std::exception& e) {
+        Json::Value error;
+        error["error"] = "Invalid product ID";
+        auto resp = HttpResponse::newHttpJsonResponse(error);
+        resp->setStatusCode(k400BadRequest);
+        callback(resp);
+        return;
+    }
+    auto* reservations = readyReservations(callback);
+    if (!reservations) {
+        return;
+    }
+    StockReservations::Availability availability;
+    const auto status = reservations->availability(productId, availability);
+    if (status != StockReservations::Status::Ok) {
+        rejectReservation(status, callback);
+        return;
+    }
+    std::string body;
+    appendAvailability(body, productId, availability);
+    callback(newJsonBodyResponse(std::move(body), k200OK));
+}
+
+void ProductsController::reserve(const HttpRequestPtr& req,
+                                 std::function<void(const HttpResponsePtr&)>&& callback,
+                                 std::string&& id) {
+    auto badRequest = [&callback](const std::string& message) {
+        Json::Value error;
+        error["error"] = "Invalid reservation";
+        error["message"] = message;
+        auto resp = HttpResponse::newHttpJsonResponse(error);
+        resp->setStatusCode(k400BadRequest);
+        callback(resp);
+    };
+
+    int64_t productId = 0;
+    try {
+        productId = std::stoll(id);
+    } catch (const std::exception& e) {
+        badRequest("Invalid product ID");
+        return;
+    }
+    auto json = requestJson(req);
+    if (!json || !json->isObject()) {
+        badRequest("Body must be a JSON object with an integer quantity");
+        return;
+    }
+    const Json::Value& quantity = (*json)["quantity"];
+    if (!quantity.isInt64() || quantity.asInt64() <= 0 || quantity.asInt64() > kMaxStockDelta) {
+        badRequest("quantity must be an integer from 1 to " + std::to_string(kMaxStockDelta));
+        return;
+    }
+    auto* reservations = readyReservations(callback);
+    if (!reservations) {
+        return;
+    }
+    const Json::Value& ttl = (*json)["ttl_seconds"];
+    if (!ttl.isNull() &&
+        (!ttl.isInt64() || ttl.asInt64() <= 0 || ttl.asInt64() > reservations->maxTtlSeconds())) {
+        badRequest("ttl_seconds must be an integer from 1 to " +
+                   std::to_string(reservations->maxTtlSeconds()));
+        return;
+    }
+
+    StockReservations::Hold hold;
+    const int64_t ttlSeconds = ttl.isNull() ? 0 : ttl.asInt64();
+    const auto status = reservations->reserve(productId, quantity.asInt64(), ttlSeconds, hold);
+    if (status != StockReservations::Status::Ok) {
+        rejectReservation(status, callback);
+        return;
+    }
+    std::string body;
+    appendJsonRaw(body, "{\"expires_at\":");
+    appendJsonInt(body, hold.expiresAtMs / 1000);
+    appendJsonRaw(body, ",\"product_id\":");
+    appendJsonInt(body, hold.productId);
+    appendJsonRaw(body, ",\"quantity\":");
+    appendJsonInt(body, hold.quantity);
+    appendJsonRaw(body, ",\"reservation_id\":");
+    appendJsonInt(body, static_cast<int64_t>(hold.id));
+    body += '}';
+    callback(newJsonBodyResponse(std::move(body), k201Created));
+}
+
+void ProductsController::commitReservation(
+    const HttpRequestPtr& req,
+    std::function<void(const HttpResponsePtr&)>&& callback,
+    std::string&& id) {
+    int64_t holdId = 0;
+    try {
+        holdId = std::stoll(id);
+    } catch (const std::exception& e) {
+        Json::Value error;
+        error["error"] = "Invalid reservation ID";
+        auto resp = HttpResponse::newHttpJsonResponse(error);
+        resp->setStatusCode(k400BadRequest);
+        callback(resp);
+        return;
+    }
+    auto* reservations = readyReservations(callback);
+    if (!reservations) {
+        return;
+    }
+    StockReservations::Hold hold;
+    const auto status = reservations->beginCommit(static_cast<uint64_t>(holdId), hold);
+    if (status != StockReservations::Status::Ok) {
+        rejectReservation(status, callback);
+        return;
+    }
+
+    auto* deltas = stockDeltaBuffer();
+    if (deltas && deltas->covers(hold.productId)) {
+        commitReservationWriteBehind(*deltas, reservations, hold, std::move(callback));
+        return;
+    }
+    commitReservationDirect(reservations, hold, std::move(callback));
+}
+
+void ProductsController::releaseReservation(
+    const HttpRequestPtr& req,
+    std::function<void(const HttpResponsePtr&)>&& callback,
+    std::string&& id) {
+    int64_t holdId = 0;
+    try {
+        holdId = std::stoll(id);
+    } catch (const std::exception& e) {
+        Json::Value error;
+        error["error"] = "Invalid reservation ID";
+        auto resp = HttpResponse::newHttpJsonResponse(error);
+        resp->setStatusCode(k400BadRequest);
+        callback(resp);
+        return;
+    }
+    auto* reservations = readyReservations(callback);
+    if (!reservations) {
+        return;
+    }
+    const auto status = reservations->release(static_cast<uint64_t>(holdId));
+    if (status != StockReservations::Status::Ok) {
+        rejectReservation(status, callback);
+        return;
+    }
+    auto resp = HttpResponse::newHttpResponse();
+    resp->setStatusCode(k204NoContent);
+    callback(resp);
+}
@@ -9,6 +9,13 @@
 
 #include <drogon/HttpController.h>
 using namespace drogon;
+
+namespace drogon_model {
+namespace sqlite3 {
+class Products;
+}  // namespace sqlite3
+}  // namespace drogon_model
+
 /**
  * @brief this class is created by the drogon_ctl command (drogon_ctl create controller -r
  * ProductsController). this class is a restful API controller.
@@ -17,10 +24,21 @@ class ProductsController : public drogon::HttpController<ProductsController> {
   public:
     METHOD_LIST_BEGIN
     // use METHOD_ADD to add your custom processing function here;
+    METHOD_ADD(ProductsController::exportCatalog, "/export", Get, Options);
+    METHOD_ADD(ProductsController::lowStock, "/low-stock", Get, Options);
     METHOD_ADD(ProductsController::getOne, "/{1}", Get, Options);
     METHOD_ADD(ProductsController::get, "", Get, Options);
     METHOD_ADD(ProductsController::create, "", Post, Options);
-    METHOD_ADD(ProductsController::updateOne, "/{1}", Put, Options);
+    METHOD_ADD(ProductsController::createBulk, "/bulk", Post, Options);
+    METHOD_ADD(ProductsController::upsertBySku, "/by-sku", Put, Options);
+    METHOD_ADD(ProductsController::batchGet, ":batchGet", Post, Options);
+    METHOD_ADD(ProductsController::adjustStockBatch, "/adjust", Post, Options);
+    METHOD_ADD(ProductsController::adjustStock, "/{1}/adjust", Post, Options);
+    METHOD_ADD(ProductsController::availability, "/{1}/availability", Get, Options);
+    METHOD_ADD(ProductsController::reserve, "/{1}/reservations", Post, Options);
+    METHOD_ADD(ProductsController::commitReservation, "/reservations/{1}/commit", Post, Options);
+    METHOD_ADD(ProductsController::releaseReservation, "/reservations/{1}", Delete, Options);
+    METHOD_ADD(ProductsController::updateOne, "/{1}", Put, Patch, Options);
     // METHOD_ADD(ProductsController::update,"",Put,Options);
     METHOD_ADD(ProductsController::deleteOne, "/{1}", Delete, Options);
     METHOD_LIST_END
@@ -32,7 +50,45 @@ class ProductsController : public drogon::HttpController<ProductsController> {
     void deleteOne(const HttpRequestPtr& req,
                    std::function<void(const HttpResponsePtr&)>&& callback, std::string&& id);
     void get(const HttpRequestPtr& req, std::function<void(const HttpResponsePtr&)>&& callback);
+    /// Stream the whole catalog as NDJSON (default) or CSV (?format=csv)
+    void exportCatalog(const HttpRequestPtr& req,
+                       std::function<void(const HttpResponsePtr&)>&& callback);
+    /// Products at or below their reorder threshold, most urgent first (?limit=N)
+    void lowStock(const HttpRequestPtr& req,
+                  std::function<void(const HttpResponsePtr&)>&& callback);
+    /// Resolve up to 1000 products by id or SKU in request order
+    void batchGet(const HttpRequestPtr& req,
+                  std::function<void(const HttpResponsePtr&)>&& callback);
     void create(const HttpRequestPtr& req, std::function<void(const HttpResponsePtr&)>&& callback);
+    /// Create many products in one transaction, reporting created/conflict per item
+    void createBulk(const HttpRequestPtr& req,
+                    std::function<void(const HttpResponsePtr&)>&& callback);
+    /// Insert or update many products keyed by SKU in one transaction
+    void upsertBySku(const HttpRequestPtr& req,
+                     std::function<void(const HttpResponsePtr&)>&& callback);
+    /// Add {"delta": n} to quantity_in_stock unless it would go below zero
+    void adjustStock(const HttpRequestPtr& req,
+                     std::function<void(const HttpResponsePtr&)>&& callback, std::string&& id);
+    /// Apply {"adjustments": [{"product_id", "delta"}, ...]} all-or-nothing
+    void adjustStockBatch(const HttpRequestPtr& req,
+                          std::function<void(const HttpResponsePtr&)>&& callback);
+    /// in_stock, reserved and available = in_stock - reserved, answered from memory
+    void availability(const HttpRequestPtr& req,
+                      std::function<void(const HttpResponsePtr&)>&& callback, std::string&& id);
+    /// Hold {"quantity": n} for a few minutes ("ttl_seconds") without writing the table
+    void reserve(const HttpRequestPtr& req, std::function<void(const HttpResponsePtr&)>&& callback,
+                 std::string&& id);
+    /// Turn a hold into a real stock decrement
+    void commitReservation(const HttpRequestPtr& req,
+                           std::function<void(const HttpResponsePtr&)>&& callback,
+                           std::string&& id);
+    /// Give the held units back
+    void releaseReservation(const HttpRequestPtr& req,
+                            std::function<void(const HttpResponsePtr&)>&& callback,
+                            std::string&& id);
+
+    /// Keep caches and indexes current after StockDeltaBuffer writes a product's stock
+    static void onStockFlushed(const drogon_model::sqlite3::Products& product, int64_t version);
 
     //    void update(const HttpRequestPtr &req,
     //                std::function<void(const HttpResponsePtr &)> &&callback);
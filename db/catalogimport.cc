@@ -0,0 +1,310 @@
+#include "catalogimport.h"
+#include <drogon/orm/Exception.h>
+#include <json/json.h>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "middleware/ValidationMiddleware.h"
+#include "models/Products.h"
+#include "utils/csvreader.h"
+
+namespace {
+/// Columns taken from the input; a missing product_id lets SQLite assign one
+const std::vector<std::string> kImportColumns = {"product_id",
+                                                 "sku",
+                                                 "name",
+                                                 "description",
+                                                 "category",
+                                                 "unit_price",
+                                                 "quantity_in_stock",
+                                                 "reorder_threshold",
+                                                 "supplier_id",
+                                                 "warehouse_id"};
+
+/// SQLite's default SQLITE_MAX_VARIABLE_NUMBER before 3.32
+constexpr size_t kSqliteMaxParameters = 999;
+const size_t kRowsPerStatement = kSqliteMaxParameters / kImportColumns.size();
+
+bool isIntegerColumn(const std::string& column) {
+    return column == "product_id" || column == "quantity_in_stock" ||
+           column == "reorder_threshold" || column == "supplier_id" ||
+           column == "warehouse_id";
+}
+
+/// Store a CSV field with the JSON type of its column; empty fields stay absent (NULL)
+void setCsvField(Json::Value& row, const std::string& column, const std::string& text) {
+    if (text.empty()) {
+        return;
+    }
+    char* end = nullptr;
+    if (isIntegerColumn(column)) {
+        const long long value = std::strtoll(text.c_str(), &end, 10);
+        if (*end == '\0') {
+            row[column] = static_cast<Json::Int64>(value);
+            return;
+        }
+    } else if (column == "unit_price") {
+        const double value = std::strtod(text.c_str(), &end);
+        if (*end == '\0' && std::isfinite(value)) {
+            row[column] = value;
+            return;
+        }
+    }
+    // Strings, and numbers that did not parse (validation reports those)
+    row[column] = text;
+}
+
+std::string buildInsertSql(size_t rows) {
+    std::string sql = "insert into " + drogon_model::sqlite3::Products::tableName + " (";
+    for (size_t c = 0; c < kImportColumns.size(); ++c) {
+        sql += c == 0 ? "" : ",";
+        sql += kImportColumns[c];
+    }
+    sql += ") values ";
+    for (size_t r = 0; r < rows; ++r) {
+        sql += r == 0 ? "(" : ",(";
+        for (size_t c = 0; c < kImportColumns.size(); ++c) {
+            sql += c == 0 ? "?" : ",?";
+        }
+        sql += ')';
+    }
+    // Rows whose sku or product_id already exist are skipped, which makes re-runs safe
+    sql += " on conflict do nothing";
+    return sql;
+}
+
+class CatalogImporter {
+  public:
+    CatalogImporter(drogon::orm::DbClientPtr clientPtr, const CatalogImportOptions& options)
+        : clientPtr_(std::move(clientPtr)),
+          options_(options),
+          fullStatementSql_(buildInsertSql(kRowsPerStatement)),
+          start_(std::chrono::steady_clock::now()) {
+        pending_.reserve(kRowsPerStatement);
+    }
+
+    void begin() {
+        // Bulk-load settings for this connection only: no fsync, journal and temp
+        // tables in memory, a large page cache, and no other writers meanwhile
+        clientPtr_->execSqlSync("PRAGMA synchronous = OFF");
+        clientPtr_->execSqlSync("PRAGMA journal_mode = MEMORY");
+        clientPtr_->execSqlSync("PRAGMA temp_store = MEMORY");
+        clientPtr_->execSqlSync("PRAGMA cache_size = -262144");
+        clientPtr_->execSqlSync("PRAGMA locking_mode = EXCLUSIVE");
+        clientPtr_->execSqlSync("BEGIN");
+    }
+
+    void add(Json::Value&& row, size_t line) {
+        ++rowsRead_;
+        std::string error;
+        if (!ValidationMiddleware::validateProductData(row, error) ||
+            !drogon_model::sqlite3::Products::validateJsonForCreation(row, error)) {
+            reject(line, error);
+            return;
+        }
+        pending_.push_back(std::move(row));
+        if (pending_.size() == kRowsPerStatement) {
+            flushPending();
+        }
+        if (rowsInTransaction_ >= options_.transactionRows) {
+            clientPtr_->execSqlSync("COMMIT");
+            reportProgress();
+            clientPtr_->execSqlSync("BEGIN");
+            rowsInTransaction_ = 0;
+        }
+    }
+
+    void reject(size_t line, const std::string& message) {
+        ++rejected_;
+        if (rejected_ <= options_.maxReportedRejects) {
+            std::cerr << "rejected line " << line << ": " << message << "\n";
+        } else if (rejected_ == options_.maxReportedRejects + 1) {
+            std::cerr << "further rejected rows are only counted\n";
+        }
+    }
+
+    void finish() {
+        flushPending();
+        clientPtr_->execSqlSync("COMMIT");
+        clientPtr_->execSqlSync("PRAGMA locking_mode = NORMAL");
+
+        const double seconds = elapsedSeconds();
+        std::cout << "import finished: " << rowsRead_ << " rows read, " << inserted_
+                  << " inserted, " << (rowsRead_ - rejected_ - inserted_)
+                  << " skipped as existing, " << rejected_ << " rejected in " << seconds
+                  << " s (" << static_cast<uint64_t>(seconds > 0 ? rowsRead_ / seconds : 0)
+                  << " rows/s)" << std::endl;
+    }
+
+    size_t rejected() const {
+        return rejected_;
+    }
+
+  private:
+    void flushPending() {
+        if (pending_.empty()) {
+            return;
+        }
+        std::string sql = pending_.size() == kRowsPerStatement
+                              ? fullStatementSql_
+                              : buildInsertSql(pending_.size());
+        size_t inserted = 0;
+        {
+            auto binder = *clientPtr_ << std::move(sql);
+            for (const auto& row : pending_) {
+                for (const auto& column : kImportColumns) {
+                    const Json::Value& value = row[column];
+                    if (value.isNull()) {
+                        binder << nullptr;
+                    } else if (isIntegerColumn(column)) {
+                        binder << static_cast<int64_t>(value.asInt64());
+                    } else if (column == "unit_price") {
+                        binder << value.asDouble();
+                    } else {
+                        binder << value.asString();
+                    }
+                }
+            }
+            binder << drogon::orm::Mode::Blocking;
+            binder >> [&inserted](const drogon::orm::Result& result) {
+                inserted = result.affectedRows();
+            };
+            binder.exec();
+        }
+        inserted_ += inserted;
+        rowsInTransaction_ += pending_.size();
+        pending_.clear();
+    }
+
+    void reportProgress() const {
+        const double seconds = elapsedSeconds();
+        std::cout << rowsRead_ << " rows read, " << inserted_ << " inserted ("
+                  << static_cast<uint64_t>(seconds > 0 ? rowsRead_ / seconds : 0) << " rows/s)"
+                  << std::endl;
+    }
+
+    double elapsedSeconds() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+    }
+
+    drogon::orm::DbClientPtr clientPtr_;
+    const CatalogImportOptions& options_;
+    const std::string fullStatementSql_;
+    const std::chrono::steady_clock::time_point start_;
+    std::vector<Json::Value> pending_;
+    size_t rowsInTransaction_{0};
+    size_t rowsRead_{0};
+    size_t inserted_{0};
+    size_t rejected_{0};
+};
+
+bool importCsv(std::istream& in, CatalogImporter& importer) {
+    CsvReader reader(in);
+    std::vector<std::string> fields;
+    if (!reader.next(fields)) {
+        std::cerr << "empty CSV file" << std::endl;
+        return false;
+    }
+    // Header row: map input positions to the columns we import, ignore the rest
+    std::vector<std::pair<size_t, std::string>> columns;
+    for (size_t i = 0; i < fields.size(); ++i) {
+        for (const auto& column : kImportColumns) {
+            if (fields[i] == column) {
+                columns.emplace_back(i, column);
+            }
+        }
+    }
+    if (columns.empty()) {
+        std::cerr << "CSV header names none of the product columns" << std::endl;
+        return false;
+    }
+
+    while (reader.next(fields)) {
+        if (fields.size() == 1 && fields[0].empty()) {
+            continue;  // blank line
+        }
+        Json::Value row(Json::objectValue);
+        for (const auto& [index, column] : columns) {
+            if (index < fields.size()) {
+                setCsvField(row, column, fields[index]);
+            }
+        }
+        importer.add(std::move(row), reader.recordLine());
+    }
+    return true;
+}
+
+bool importNdJson(std::istream& in, CatalogImporter& importer) {
+    Json::CharReaderBuilder builder;
+    std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+    std::string line;
+    size_t lineNumber = 0;
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty()) {
+            continue;
+        }
+        Json::Value row;
+        std::string errors;
+        if (!reader->parse(line.data(), line.data() + line.size(), &row, &errors) ||
+            !row.isObject()) {
+            importer.reject(lineNumber, "Invalid JSON object");
+            continue;
+        }
+        // Export lines carry the timestamps; the import lets SQLite set them
+        row.removeMember("created_at");
+        row.removeMember("updated_at");
+        importer.add(std::move(row), lineNumber);
+    }
+    return true;
+}
+}  // namespace
+
+int runCatalogImport(const drogon::orm::DbClientPtr& clientPtr,
+                     const CatalogImportOptions& options) {
+    std::string format = options.format;
+    if (format.empty()) {
+        const auto dot = options.path.rfind('.');
+        const std::string extension = dot == std::string::npos ? "" : options.path.substr(dot + 1);
+        format = extension == "csv" ? "csv" : "ndjson";
+    }
+    if (format != "csv" && format != "ndjson") {
+        std::cerr << "unknown import format '" << format << "' (expected csv or ndjson)"
+                  << std::endl;
+        return 2;
+    }
+
+    // A larger stream buffer keeps the per-character CSV parser out of read()
+    std::vector<char> buffer(1 << 20);
+    std::ifstream in;
+    in.rdbuf()->pubsetbuf(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    in.open(options.path, std::ios::binary);
+    if (!in) {
+        std::cerr << "cannot open " << options.path << std::endl;
+        return 2;
+    }
+
+    std::cout << "importing " << options.path << " as " << format << std::endl;
+    CatalogImporter importer(clientPtr, options);
+    try {
+        importer.begin();
+        const bool ok = format == "csv" ? importCsv(in, importer) : importNdJson(in, importer);
+        if (!ok) {
+            clientPtr->execSqlSync("ROLLBACK");
+            return 2;
+        }
+        importer.finish();
+    } catch (const drogon::orm::DrogonDbException& e) {
+        std::cerr << "import failed: " << e.base().what() << std::endl;
+        return 2;
+    }
+    return importer.rejected() == 0 ? 0 : 1;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <drogon/orm/DbClient.h>
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief Options of `inventory_system import <file>`
+ */
+struct CatalogImportOptions {
+    /// CSV (with a header row) or NDJSON file, e.g. one written by GET /api/products/export
+    std::string path;
+    /// "csv", "ndjson" or empty to pick by file extension
+    std::string format;
+    /// Rows committed per transaction
+    size_t transactionRows{50000};
+    /// Rejected rows printed in detail; the rest are only counted
+    size_t maxReportedRejects{100};
+};
+
+/**
+ * @brief Stream a catalog file into the products table without going through HTTP
+ *
+ * Every row is checked with ValidationMiddleware::validateProductData() and the model's
+ * creation rules, then inserted with multi-row INSERT statements in large
+ * transactions. Rows whose sku or product_id already exists are skipped, so an
+ * interrupted import can simply be run again. Progress, rows/sec and rejected rows
+ * are written to stdout/stderr.
+ *
+ * The connection runs with synchronous=OFF and an in-memory journal, so a crash
+ * mid-import may leave the file unusable: import into a copy or keep a backup.
+ *
+ * @return process exit code: 0 if every row was imported or skipped as existing,
+ * 1 if rows were rejected, 2 if the import could not run
+ */
+int runCatalogImport(const drogon::orm::DbClientPtr& clientPtr,
+                     const CatalogImportOptions& options);
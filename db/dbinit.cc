@@ -2,80 +2,167 @@
 #include <drogon/drogon.h>
 #include <stdexcept>
 
+void createSchema(const drogon::orm::DbClientPtr& clientPtr) {
+    // Execute table creation queries
+    // Create Products table
+    std::string createProductsTable = R"(
+        CREATE TABLE IF NOT EXISTS products (
+            product_id INTEGER PRIMARY KEY AUTOINCREMENT,
+            sku TEXT UNIQUE NOT NULL,
+            name TEXT NOT NULL,
+            description TEXT,
+            category TEXT,
+            unit_price REAL NOT NULL DEFAULT 0.0,
+            quantity_in_stock INTEGER NOT NULL DEFAULT 0,
+            reorder_threshold INTEGER NOT NULL DEFAULT 0,
+            supplier_id INTEGER,
+            warehouse_id INTEGER,
+            created_at DATETIME DEFAULT CURRENT_TIMESTAMP,
+            updated_at DATETIME DEFAULT CURRENT_TIMESTAMP,
+            version INTEGER NOT NULL DEFAULT 1
+        )
+    )";
+    clientPtr->execSqlSync(createProductsTable);
+
+    // Row version behind the product ETag; databases created before it get the column here
+    bool hasVersion = false;
+    for (const auto& column : clientPtr->execSqlSync("PRAGMA table_info(products)")) {
+        hasVersion = hasVersion || column["name"].as<std::string>() == "version";
+    }
+    if (!hasVersion) {
+        clientPtr->execSqlSync(
+            "ALTER TABLE products ADD COLUMN version INTEGER NOT NULL DEFAULT 1");
+    }
+    // The API bumps version in the UPDATE itself; this catches every other writer.
+    // Recursive triggers are off, so the inner UPDATE does not fire it again.
+    clientPtr->execSqlSync(
+        "CREATE TRIGGER IF NOT EXISTS products_bump_version AFTER UPDATE ON products "
+        "FOR EACH ROW WHEN NEW.version = OLD.version BEGIN "
+        "UPDATE products SET version = OLD.version + 1 WHERE product_id = NEW.product_id; "
+        "END");
+    // Clients may create a product under the id of a deleted one. The deleted row's
+    // version is kept until then and the new row continues above it, so a row ETag
+    // such as "p42v1" never names two different bodies.
+    clientPtr->execSqlSync(R"(
+        CREATE TABLE IF NOT EXISTS product_tombstones (
+            product_id INTEGER PRIMARY KEY,
+            version INTEGER NOT NULL
+        )
+    )");
+    clientPtr->execSqlSync(
+        "CREATE TRIGGER IF NOT EXISTS products_keep_version AFTER DELETE ON products "
+        "FOR EACH ROW BEGIN "
+        "INSERT OR REPLACE INTO product_tombstones (product_id, version) "
+        "VALUES (OLD.product_id, OLD.version); "
+        "END");
+    clientPtr->execSqlSync(
+        "CREATE TRIGGER IF NOT EXISTS products_resume_version AFTER INSERT ON products "
+        "FOR EACH ROW WHEN EXISTS "
+        "(SELECT 1 FROM product_tombstones WHERE product_id = NEW.product_id) BEGIN "
+        "UPDATE products SET version = (SELECT version FROM product_tombstones "
+        "WHERE product_id = NEW.product_id) + 1 WHERE product_id = NEW.product_id; "
+        "DELETE FROM product_tombstones WHERE product_id = NEW.product_id; "
+        "END");
+
+    // Indexes backing the GET /api/products filters. SQLite appends the rowid to
+    // every index, so an equality seek also yields rows in product_id order and
+    // keyset pagination needs no sort.
+    clientPtr->execSqlSync(
+        "CREATE INDEX IF NOT EXISTS idx_products_category ON products(category)");
+    clientPtr->execSqlSync(
+        "CREATE INDEX IF NOT EXISTS idx_products_supplier ON products(supplier_id)");
+    clientPtr->execSqlSync(
+        "CREATE INDEX IF NOT EXISTS idx_products_warehouse ON products(warehouse_id)");
+    clientPtr->execSqlSync(
+        "CREATE INDEX IF NOT EXISTS idx_products_quantity ON products(quantity_in_stock)");
+    // Partial index: only rows currently at or below their reorder threshold are stored,
+    // the same rule as the low-stock watchlist. The earlier strict "<" index is replaced.
+    clientPtr->execSqlSync("DROP INDEX IF EXISTS idx_products_below_reorder");
+    clientPtr->execSqlSync(
+        "CREATE INDEX IF NOT EXISTS idx_products_at_reorder ON products(product_id) "
+        "WHERE quantity_in_stock <= reorder_threshold");
+
+    // Create Suppliers table
+    std::string createSuppliersTable = R"(
+        CREATE TABLE IF NOT EXISTS supplier (
+            supplier_id INTEGER PRIMARY KEY AUTOINCREMENT,
+            name TEXT NOT NULL,
+            contact_person TEXT,
+            email TEXT,
+            phone TEXT,
+            address TEXT,
+            created_at DATETIME DEFAULT CURRENT_TIMESTAMP,
+            updated_at DATETIME DEFAULT CURRENT_TIMESTAMP
+        )
+    )";
+    clientPtr->execSqlSync(createSuppliersTable);
+
+    // Create Warehouses table
+    std::string createWarehousesTable = R"(
+        CREATE TABLE IF NOT EXISTS warehouse (
+            warehouse_id INTEGER PRIMARY KEY AUTOINCREMENT,
+            name TEXT NOT NULL,
+            location TEXT,
+            capacity INTEGER,
+            created_at DATETIME DEFAULT CURRENT_TIMESTAMP,
+            updated_at DATETIME DEFAULT CURRENT_TIMESTAMP
+        )
+    )";
+    clientPtr->execSqlSync(createWarehousesTable);
+
+    // Create Purchase Orders table
+    std::string createPurchaseOrdersTable = R"(
+        CREATE TABLE IF NOT EXISTS purchase_order (
+            order_id INTEGER PRIMARY KEY AUTOINCREMENT,
+            product_id INTEGER NOT NULL,
+            supplier_id INTEGER NOT NULL,
+            quantity_ordered INTEGER NOT NULL,
+            unit_price REAL NOT NULL,
+            total_price REAL NOT NULL,
+            order_date DATETIME DEFAULT CURRENT_TIMESTAMP,
+            expected_delivery_date DATETIME,
+            actual_delivery_date DATETIME,
+            status TEXT NOT NULL DEFAULT 'PENDING',
+            created_at DATETIME DEFAULT CURRENT_TIMESTAMP,
+            updated_at DATETIME DEFAULT CURRENT_TIMESTAMP,
+            FOREIGN KEY (product_id) REFERENCES product(product_id),
+            FOREIGN KEY (supplier_id) REFERENCES supplier(supplier_id)
+        )
+    )";
+    clientPtr->execSqlSync(createPurchaseOrdersTable);
+
+    // Responses of writes sent with an Idempotency-Key; status stays 0 until the write
+    // that claimed the key has produced its response in the same transaction
+    std::string createIdempotencyKeysTable = R"(
+        CREATE TABLE IF NOT EXISTS idempotency_keys (
+            idempotency_key TEXT PRIMARY KEY,
+            fingerprint TEXT NOT NULL,
+            status INTEGER NOT NULL DEFAULT 0,
+            body TEXT,
+            created_at DATETIME DEFAULT CURRENT_TIMESTAMP
+        )
+    )";
+    clientPtr->execSqlSync(createIdempotencyKeysTable);
+    clientPtr->execSqlSync(
+        "CREATE INDEX IF NOT EXISTS idx_idempotency_keys_created ON idempotency_keys(created_at)");
+
+    // Highest StockDeltaBuffer journal record applied to products; written in the same
+    // transaction as the deltas it covers
+    clientPtr->execSqlSync(R"(
+        CREATE TABLE IF NOT EXISTS stock_delta_journal (
+            id INTEGER PRIMARY KEY CHECK (id = 1),
+            flushed_sequence INTEGER NOT NULL
+        )
+    )");
+}
+
 void initializeDatabase() {
     LOG_INFO << "Initializing database tables...";
 
     auto clientPtr = drogon::app().getDbClient();
 
     try {
-        // Execute table creation queries
-        // Create Products table
-        std::string createProductsTable = R"(
-            CREATE TABLE IF NOT EXISTS products (
-                product_id INTEGER PRIMARY KEY AUTOINCREMENT,
-                sku TEXT UNIQUE NOT NULL,
-                name TEXT NOT NULL,
-                description TEXT,
-                category TEXT,
-                unit_price REAL NOT NULL DEFAULT 0.0,
-                quantity_in_stock INTEGER NOT NULL DEFAULT 0,
-                reorder_threshold INTEGER NOT NULL DEFAULT 0,
-                supplier_id INTEGER,
-                warehouse_id INTEGER,
-                created_at DATETIME DEFAULT CURRENT_TIMESTAMP,
-                updated_at DATETIME DEFAULT CURRENT_TIMESTAMP
-            )
-        )";
-        clientPtr->execSqlSync(createProductsTable);
-
-        // Create Suppliers table
-        std::string createSuppliersTable = R"(
-            CREATE TABLE IF NOT EXISTS supplier (
-                supplier_id INTEGER PRIMARY KEY AUTOINCREMENT,
-                name TEXT NOT NULL,
-                contact_person TEXT,
-                email TEXT,
-                phone TEXT,
-                address TEXT,
-                created_at DATETIME DEFAULT CURRENT_TIMESTAMP,
-                updated_at DATETIME DEFAULT CURRENT_TIMESTAMP
-            )
-        )";
-        clientPtr->execSqlSync(createSuppliersTable);
-
-        // Create Warehouses table
-        std::string createWarehousesTable = R"(
-            CREATE TABLE IF NOT EXISTS warehouse (
-                warehouse_id INTEGER PRIMARY KEY AUTOINCREMENT,
-                name TEXT NOT NULL,
-                location TEXT,
-                capacity INTEGER,
-                created_at DATETIME DEFAULT CURRENT_TIMESTAMP,
-                updated_at DATETIME DEFAULT CURRENT_TIMESTAMP
-            )
-        )";
-        clientPtr->execSqlSync(createWarehousesTable);
-
-        // Create Purchase Orders table
-        std::string createPurchaseOrdersTable = R"(
-            CREATE TABLE IF NOT EXISTS purchase_order (
-                order_id INTEGER PRIMARY KEY AUTOINCREMENT,
-                product_id INTEGER NOT NULL,
-                supplier_id INTEGER NOT NULL,
-                quantity_ordered INTEGER NOT NULL,
-                unit_price REAL NOT NULL,
-                total_price REAL NOT NULL,
-                order_date DATETIME DEFAULT CURRENT_TIMESTAMP,
-                expected_delivery_date DATETIME,
-                actual_delivery_date DATETIME,
-                status TEXT NOT NULL DEFAULT 'PENDING',
-                created_at DATETIME DEFAULT CURRENT_TIMESTAMP,
-                updated_at DATETIME DEFAULT CURRENT_TIMESTAMP,
-                FOREIGN KEY (product_id) REFERENCES product(product_id),
-                FOREIGN KEY (supplier_id) REFERENCES supplier(supplier_id)
-            )
-        )";
-        clientPtr->execSqlSync(createPurchaseOrdersTable);
+        createSchema(clientPtr);
 
         // Insert sample data if tables are empty
         auto result = clientPtr->execSqlSync("SELECT COUNT(*) as count FROM products");
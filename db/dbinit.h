@@ -1,5 +1,17 @@
 #pragma once
 
+#include <drogon/orm/DbClient.h>
+
+/**
+ * @brief Create all tables and indexes if they do not exist yet
+ *
+ * Used by initializeDatabase() and by the offline catalog import, which has no
+ * running app and therefore brings its own client.
+ *
+ * @throws drogon::orm::DrogonDbException if a statement fails
+ */
+void createSchema(const drogon::orm::DbClientPtr& clientPtr);
+
 /**
  * @brief Initialize the database with required tables and sample data
  * 
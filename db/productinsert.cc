@@ -0,0 +1,86 @@
+#include "productinsert.h"
+#include "models/Products.h"
+
+namespace {
+/// SQLite's default SQLITE_MAX_VARIABLE_NUMBER before 3.32; newer builds allow more
+constexpr size_t kSqliteMaxParameters = 999;
+}  // namespace
+
+const std::vector<std::string> kProductInsertColumns = {"sku",
+                                                        "name",
+                                                        "description",
+                                                        "category",
+                                                        "unit_price",
+                                                        "quantity_in_stock",
+                                                        "reorder_threshold",
+                                                        "supplier_id",
+                                                        "warehouse_id"};
+
+const size_t kProductInsertRowsPerStatement = kSqliteMaxParameters / kProductInsertColumns.size();
+
+namespace {
+std::string buildValuesSql(size_t rows) {
+    std::string sql = "insert into " + drogon_model::sqlite3::Products::tableName + " (";
+    for (size_t c = 0; c < kProductInsertColumns.size(); ++c) {
+        sql += c == 0 ? "" : ",";
+        sql += kProductInsertColumns[c];
+    }
+    sql += ") values ";
+    for (size_t r = 0; r < rows; ++r) {
+        sql += r == 0 ? "(" : ",(";
+        for (size_t c = 0; c < kProductInsertColumns.size(); ++c) {
+            sql += c == 0 ? "?" : ",?";
+        }
+        sql += ')';
+    }
+    return sql;
+}
+
+/// Optional columns an upsert leaves alone when the item does not set them
+bool keepsExistingValue(const std::string& column) {
+    return column == "description" || column == "category" || column == "supplier_id" ||
+           column == "warehouse_id";
+}
+}  // namespace
+
+std::string buildProductInsertSql(size_t rows) {
+    return buildValuesSql(rows) + " on conflict(sku) do nothing returning product_id, sku";
+}
+
+std::string buildProductUpsertSql(size_t rows) {
+    std::string assignments;
+    std::string changed;
+    for (const auto& column : kProductInsertColumns) {
+        if (column == "sku") {
+            continue;
+        }
+        const std::string value =
+            keepsExistingValue(column)
+                ? "coalesce(excluded." + column + ", products." + column + ")"
+                : "excluded." + column;
+        assignments += column + " = " + value + ", ";
+        changed += changed.empty() ? "" : " or ";
+        changed += "products." + column + " is not " + value;
+    }
+    // The WHERE clause skips rows that would not change, so they are neither written
+    // nor returned
+    return buildValuesSql(rows) + " on conflict(sku) do update set " + assignments +
+           "updated_at = CURRENT_TIMESTAMP, version = products.version + 1 where " + changed +
+           " returning *";
+}
+
+void bindProductInsertRow(drogon::orm::internal::SqlBinder& binder, const Json::Value& product) {
+    for (const auto& column : kProductInsertColumns) {
+        const Json::Value& value = product[column];
+        if (value.isNull()) {
+            binder << nullptr;
+        } else if (column == "unit_price") {
+            binder << value.asDouble();
+        } else if (column == "quantity_in_stock" || column == "reorder_threshold" ||
+                   column == "supplier_id" || column == "warehouse_id") {
+            binder << static_cast<int64_t>(value.asInt64());
+        } else {
+            binder << value.asString();
+        }
+    }
+}
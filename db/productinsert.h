@@ -0,0 +1,37 @@
+#pragma once
+
+#include <drogon/orm/SqlBinder.h>
+#include <json/json.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/// Columns a multi-row product insert writes; the rest come from their table defaults
+extern const std::vector<std::string> kProductInsertColumns;
+
+/// Rows per multi-row INSERT so that one statement stays within SQLite's parameter limit
+extern const size_t kProductInsertRowsPerStatement;
+
+/**
+ * @brief "insert into products (...) values (?,...),... on conflict(sku) do nothing
+ * returning product_id, sku" for @p rows rows
+ *
+ * A duplicate SKU skips only its own row; rows missing from the RETURNING result
+ * were conflicts. RETURNING order is unspecified, so match rows back by SKU.
+ */
+std::string buildProductInsertSql(size_t rows);
+
+/**
+ * @brief Multi-row upsert by SKU for @p rows rows, "... on conflict(sku) do update ...
+ * returning *"
+ *
+ * Existing rows take every column of the item, except that a missing (NULL)
+ * description, category, supplier_id or warehouse_id keeps the stored value. Rows
+ * that would not change are skipped and are missing from the RETURNING result;
+ * inserted rows have a product_id above every id that existed before the statement
+ * (the table uses AUTOINCREMENT).
+ */
+std::string buildProductUpsertSql(size_t rows);
+
+/// Bind the kProductInsertColumns of one product, already checked by validateJsonForCreation()
+void bindProductInsertRow(drogon::orm::internal::SqlBinder& binder, const Json::Value& product);
@@ -1,13 +1,116 @@
 #include <drogon/drogon.h>
 #include <json/json.h>
+#include <cerrno>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
 #include <mutex>
 // Include controllers to ensure they are compiled and auto-registered
 #include "controllers/ProductsController.h"
 #include "middleware/ValidationMiddleware.h"
+#include "plugins/IdempotencyStore.h"
+#include "plugins/LowStockIndex.h"
+#include "plugins/ProductCache.h"
+#include "plugins/ResponseCache.h"
+#include "plugins/StockDeltaBuffer.h"
+#include "plugins/StockReservations.h"
+#include "plugins/WriteCoalescer.h"
+#include "db/catalogimport.h"
 #include "db/dbinit.h"
 #include "validation.h"
 
-int main() {
+namespace {
+/// SQLite file of the default db client in @p configPath
+std::string databaseFileFromConfig(const std::string& configPath) {
+    std::ifstream in(configPath);
+    Json::Value config;
+    Json::CharReaderBuilder builder;
+    std::string errors;
+    if (in && Json::parseFromStream(builder, in, &config, &errors)) {
+        for (const auto& client : config["db_clients"]) {
+            if (client.get("name", "default").asString() == "default") {
+                return client.get("filename", "inventory.db").asString();
+            }
+        }
+    }
+    return "inventory.db";
+}
+
+/// Print the import usage line; returns the exit code for bad arguments
+int importUsage(const char* program) {
+    std::cerr << "usage: " << program
+              << " import <file> [--format csv|ndjson] [--batch rows] [--config file]"
+              << std::endl;
+    return 2;
+}
+
+/// Read a positive row count, refusing anything that is not all digits
+bool parseBatchRows(const char* text, size_t& rows) {
+    if (*text < '0' || *text > '9') {
+        return false;
+    }
+    errno = 0;
+    char* end = nullptr;
+    const unsigned long long value = std::strtoull(text, &end, 10);
+    if (*end != '\0' || errno == ERANGE || value == 0 ||
+        value > std::numeric_limits<size_t>::max()) {
+        return false;
+    }
+    rows = static_cast<size_t>(value);
+    return true;
+}
+
+/// `inventory_system import <file> [--format csv|ndjson] [--batch rows] [--config file]`
+int runImportCommand(int argc, char* argv[]) {
+    if (argc < 3) {
+        return importUsage(argv[0]);
+    }
+    CatalogImportOptions options;
+    options.path = argv[2];
+    std::string configPath = "config.json";
+    for (int i = 3; i < argc; i += 2) {
+        const std::string flag = argv[i];
+        if (flag != "--format" && flag != "--batch" && flag != "--config") {
+            std::cerr << "unknown option " << flag << std::endl;
+            return importUsage(argv[0]);
+        }
+        if (i + 1 == argc) {
+            std::cerr << "option " << flag << " needs a value" << std::endl;
+            return importUsage(argv[0]);
+        }
+        const char* value = argv[i + 1];
+        if (flag == "--format") {
+            options.format = value;
+        } else if (flag == "--batch") {
+            if (!parseBatchRows(value, options.transactionRows)) {
+                std::cerr << "--batch must be a positive number of rows, got " << value
+                          << std::endl;
+                return importUsage(argv[0]);
+            }
+        } else {
+            configPath = value;
+        }
+    }
+
+    const std::string databaseFile = databaseFileFromConfig(configPath);
+    auto clientPtr = drogon::orm::DbClient::newSqlite3Client("filename=" + databaseFile, 1);
+    try {
+        createSchema(clientPtr);
+    } catch (const drogon::orm::DrogonDbException& e) {
+        std::cerr << "cannot prepare " << databaseFile << ": " << e.base().what() << std::endl;
+        return 2;
+    }
+    return runCatalogImport(clientPtr, options);
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    // Offline bulk load, no HTTP server
+    if (argc > 1 && std::string(argv[1]) == "import") {
+        return runImportCommand(argc, argv);
+    }
+
     // Set HTTP listener address and port
     drogon::app().addListener("0.0.0.0", 7777);
 
@@ -35,6 +138,160 @@ int main() {
             }
         });
 
+    // Multi-get by id or SKU in one request (Google-style custom method on the collection)
+    drogon::app().registerHandler(
+        "/api/products:batchGet",
+        [productsController](const drogon::HttpRequestPtr& req,
+                             std::function<void(const drogon::HttpResponsePtr&)>&& callback) {
+            if (req->getMethod() == drogon::Post) {
+                productsController->batchGet(req, std::move(callback));
+            } else {
+                auto resp = drogon::HttpResponse::newHttpResponse();
+                resp->setStatusCode(drogon::k405MethodNotAllowed);
+                callback(resp);
+            }
+        });
+
+    // Bulk creation in one transaction
+    drogon::app().registerHandler(
+        "/api/products/bulk",
+        [productsController](const drogon::HttpRequestPtr& req,
+                             std::function<void(const drogon::HttpResponsePtr&)>&& callback) {
+            if (req->getMethod() == drogon::Post) {
+                productsController->createBulk(req, std::move(callback));
+            } else {
+                auto resp = drogon::HttpResponse::newHttpResponse();
+                resp->setStatusCode(drogon::k405MethodNotAllowed);
+                callback(resp);
+            }
+        });
+
+    // Supplier feed sync: insert or update by SKU
+    drogon::app().registerHandler(
+        "/api/products/by-sku",
+        [productsController](const drogon::HttpRequestPtr& req,
+                             std::function<void(const drogon::HttpResponsePtr&)>&& callback) {
+            if (req->getMethod() == drogon::Put) {
+                productsController->upsertBySku(req, std::move(callback));
+            } else {
+                auto resp = drogon::HttpResponse::newHttpResponse();
+                resp->setStatusCode(drogon::k405MethodNotAllowed);
+                callback(resp);
+            }
+        });
+
+    // Batched stock adjustments, all-or-nothing
+    drogon::app().registerHandler(
+        "/api/products/adjust",
+        [productsController](const drogon::HttpRequestPtr& req,
+                             std::function<void(const drogon::HttpResponsePtr&)>&& callback) {
+            if (req->getMethod() == drogon::Post) {
+                productsController->adjustStockBatch(req, std::move(callback));
+            } else {
+                auto resp = drogon::HttpResponse::newHttpResponse();
+                resp->setStatusCode(drogon::k405MethodNotAllowed);
+                callback(resp);
+            }
+        });
+
+    // Atomic stock delta for one product
+    drogon::app().registerHandler(
+        "/api/products/{id}/adjust",
+        [productsController](const drogon::HttpRequestPtr& req,
+                             std::function<void(const drogon::HttpResponsePtr&)>&& callback,
+                             std::string&& id) {
+            if (req->getMethod() == drogon::Post) {
+                productsController->adjustStock(req, std::move(callback), std::move(id));
+            } else {
+                auto resp = drogon::HttpResponse::newHttpResponse();
+                resp->setStatusCode(drogon::k405MethodNotAllowed);
+                callback(resp);
+            }
+        });
+
+    // Checkout holds, answered from the in-memory StockReservations
+    drogon::app().registerHandler(
+        "/api/products/{id}/availability",
+        [productsController](const drogon::HttpRequestPtr& req,
+                             std::function<void(const drogon::HttpResponsePtr&)>&& callback,
+                             std::string&& id) {
+            if (req->getMethod() == drogon::Get) {
+                productsController->availability(req, std::move(callback), std::move(id));
+            } else {
+                auto resp = drogon::HttpResponse::newHttpResponse();
+                resp->setStatusCode(drogon::k405MethodNotAllowed);
+                callback(resp);
+            }
+        });
+    drogon::app().registerHandler(
+        "/api/products/{id}/reservations",
+        [productsController](const drogon::HttpRequestPtr& req,
+                             std::function<void(const drogon::HttpResponsePtr&)>&& callback,
+                             std::string&& id) {
+            if (req->getMethod() == drogon::Post) {
+                productsController->reserve(req, std::move(callback), std::move(id));
+            } else {
+                auto resp = drogon::HttpResponse::newHttpResponse();
+                resp->setStatusCode(drogon::k405MethodNotAllowed);
+                callback(resp);
+            }
+        });
+    drogon::app().registerHandler(
+        "/api/products/reservations/{id}/commit",
+        [productsController](const drogon::HttpRequestPtr& req,
+                             std::function<void(const drogon::HttpResponsePtr&)>&& callback,
+                             std::string&& id) {
+            if (req->getMethod() == drogon::Post) {
+                productsController->commitReservation(req, std::move(callback), std::move(id));
+            } else {
+                auto resp = drogon::HttpResponse::newHttpResponse();
+                resp->setStatusCode(drogon::k405MethodNotAllowed);
+                callback(resp);
+            }
+        });
+    drogon::app().registerHandler(
+        "/api/products/reservations/{id}",
+        [productsController](const drogon::HttpRequestPtr& req,
+                             std::function<void(const drogon::HttpResponsePtr&)>&& callback,
+                             std::string&& id) {
+            if (req->getMethod() == drogon::Delete) {
+                productsController->releaseReservation(req, std::move(callback), std::move(id));
+            } else {
+                auto resp = drogon::HttpResponse::newHttpResponse();
+                resp->setStatusCode(drogon::k405MethodNotAllowed);
+                callback(resp);
+            }
+        });
+
+    // Streaming catalog export; registered before /api/products/{id} so "export" is not taken
+    // for an id
+    drogon::app().registerHandler(
+        "/api/products/export",
+        [productsController](const drogon::HttpRequestPtr& req,
+                             std::function<void(const drogon::HttpResponsePtr&)>&& callback) {
+            if (req->getMethod() == drogon::Get) {
+                productsController->exportCatalog(req, std::move(callback));
+            } else {
+                auto resp = drogon::HttpResponse::newHttpResponse();
+                resp->setStatusCode(drogon::k405MethodNotAllowed);
+                callback(resp);
+            }
+        });
+
+    // Low-stock watchlist, answered from the in-memory LowStockIndex
+    drogon::app().registerHandler(
+        "/api/products/low-stock",
+        [productsController](const drogon::HttpRequestPtr& req,
+                             std::function<void(const drogon::HttpResponsePtr&)>&& callback) {
+            if (req->getMethod() == drogon::Get) {
+                productsController->lowStock(req, std::move(callback));
+            } else {
+                auto resp = drogon::HttpResponse::newHttpResponse();
+                resp->setStatusCode(drogon::k405MethodNotAllowed);
+                callback(resp);
+            }
+        });
+
     // Map /api/products/{id} routes to ProductsController methods
     drogon::app().registerHandler(
         "/api/products/{id}",
@@ -43,7 +300,7 @@ int main() {
                              std::string&& id) {
             if (req->getMethod() == drogon::Get) {
                 productsController->getOne(req, std::move(callback), std::move(id));
-            } else if (req->getMethod() == drogon::Put) {
+            } else if (req->getMethod() == drogon::Put || req->getMethod() == drogon::Patch) {
                 productsController->updateOne(req, std::move(callback), std::move(id));
             } else if (req->getMethod() == drogon::Delete) {
                 productsController->deleteOne(req, std::move(callback), std::move(id));
@@ -66,6 +323,33 @@ int main() {
             callback(resp);
         });
 
+    // In-process cache counters, used to size the caches in config.json
+    drogon::app().registerHandler(
+        "/api/cache/stats", [](const drogon::HttpRequestPtr& req,
+                               std::function<void(const drogon::HttpResponsePtr&)>&& callback) {
+            Json::Value response(Json::objectValue);
+            if (auto* productCache = drogon::app().getPlugin<ProductCache>()) {
+                response["product_cache"] = productCache->stats();
+            }
+            if (auto* responseCache = drogon::app().getPlugin<ResponseCache>()) {
+                response["response_cache"] = responseCache->stats();
+            }
+            if (auto* idempotencyStore = drogon::app().getPlugin<IdempotencyStore>()) {
+                response["idempotency_store"] = idempotencyStore->stats();
+            }
+            if (auto* writeCoalescer = drogon::app().getPlugin<WriteCoalescer>()) {
+                response["write_coalescer"] = writeCoalescer->stats();
+            }
+            if (auto* reservations = drogon::app().getPlugin<StockReservations>()) {
+                response["stock_reservations"] = reservations->stats();
+            }
+            if (auto* deltas = drogon::app().getPlugin<StockDeltaBuffer>()) {
+                response["stock_delta_buffer"] = deltas->stats();
+            }
+            auto resp = drogon::HttpResponse::newHttpJsonResponse(response);
+            callback(resp);
+        });
+
     // API documentation endpoint
     drogon::app().registerHandler(
         "/api", [](const drogon::HttpRequestPtr& req,
@@ -74,11 +358,28 @@ int main() {
             response["service"] = "Inventory Management System";
             response["version"] = "1.0.0";
             Json::Value endpoints(Json::arrayValue);
-            endpoints.append("GET /api/products - List all products");
+            endpoints.append(
+                "GET /api/products?limit=&after=&fields=&category=&supplier_id=&warehouse_id=&min_qty="
+                "&max_qty=&below_reorder= - List and filter products (keyset paginated)");
+            endpoints.append("GET /api/products/export?format=ndjson|csv - Stream full catalog");
+            endpoints.append(
+                "GET /api/products/low-stock?limit= - Products at or below reorder threshold");
             endpoints.append("POST /api/products - Create new product");
+            endpoints.append("POST /api/products/bulk - Create many products in one transaction");
+            endpoints.append(
+                "PUT /api/products/by-sku - Insert or update many products by SKU");
+            endpoints.append("POST /api/products:batchGet - Get many products by ids or skus");
+            endpoints.append(
+                "POST /api/products/{id}/adjust - Add a stock delta unless stock would go negative");
+            endpoints.append("POST /api/products/adjust - Apply many stock deltas all-or-nothing");
+            endpoints.append("GET /api/products/{id}/availability - In stock minus held");
+            endpoints.append("POST /api/products/{id}/reservations - Hold stock for a cart");
+            endpoints.append("POST /api/products/reservations/{id}/commit - Apply a hold");
+            endpoints.append("DELETE /api/products/reservations/{id} - Release a hold");
             endpoints.append("GET /api/products/{id} - Get product by ID");
-            endpoints.append("PUT /api/products/{id} - Update product");
+            endpoints.append("PUT|PATCH /api/products/{id} - Update the supplied fields");
             endpoints.append("DELETE /api/products/{id} - Delete product");
+            endpoints.append("GET /api/cache/stats - In-process cache and write batching counters");
             endpoints.append("GET /health - Health check");
             endpoints.append("GET / - Home page with product list");
             endpoints.append("GET /create - Web form to create products");
@@ -130,14 +431,25 @@ int main() {
     drogon::app().registerPostHandlingAdvice(
         [](const drogon::HttpRequestPtr&, const drogon::HttpResponsePtr& resp) {
             resp->addHeader("Access-Control-Allow-Origin", "*");
-            resp->addHeader("Access-Control-Allow-Methods", "GET,POST,PUT,DELETE,OPTIONS");
-            resp->addHeader("Access-Control-Allow-Headers", "Content-Type");
+            resp->addHeader("Access-Control-Allow-Methods", "GET,POST,PUT,PATCH,DELETE,OPTIONS");
+            resp->addHeader("Access-Control-Allow-Headers",
+                            "Content-Type, If-None-Match, If-Match, Idempotency-Key");
+            resp->addHeader("Access-Control-Expose-Headers", "X-Next-Cursor, ETag, Idempotent-Replayed");
         });
 
     // Initialize database after the server starts using a timer
     drogon::app().getLoop()->runAfter(1.0, []() {
         LOG_INFO << "Initializing database...";
         initializeDatabase();
+        if (auto* lowStock = drogon::app().getPlugin<LowStockIndex>()) {
+            lowStock->load(drogon::app().getDbClient());
+        }
+        if (auto* reservations = drogon::app().getPlugin<StockReservations>()) {
+            reservations->load(drogon::app().getDbClient());
+        }
+        if (auto* deltas = drogon::app().getPlugin<StockDeltaBuffer>()) {
+            deltas->load(drogon::app().getDbClient(), &ProductsController::onStockFlushed);
+        }
     });
 
     // Run HTTP framework,the method will block in the internal event loop
@@ -4,9 +4,10 @@
 #include <drogon/HttpRequest.h>
 #include <drogon/HttpResponse.h>
 #include <json/json.h>
-#include <regex>
+#include <memory>
 #include <string>
 #include <unordered_set>
+#include "utils/routeclassifier.h"
 
 using namespace drogon;
 
@@ -19,24 +20,23 @@ public:
                 MiddlewareNextCallback &&nextCb,
                 MiddlewareCallback &&mcb) override;
 
+    // Field rules for a new product; also used by the offline catalog import
+    static bool validateProductData(const Json::Value& json, std::string& error);
+
 private:
     // Validation helper methods
-    static bool validateJson(const std::string& body, Json::Value& jsonOut);
-    static bool validateProductData(const Json::Value& json, std::string& error);
+    // The request body as a JSON object, parsed at most once per request
+    static std::shared_ptr<Json::Value> validateJson(const HttpRequestPtr& req);
     static bool validateProductUpdate(const Json::Value& json, std::string& error);
-    static bool validateId(const std::string& id, std::string& error);
-    static bool validateString(const std::string& str, const std::string& fieldName,
-                             size_t minLen = 1, size_t maxLen = 255);
-    static bool validateNumber(const Json::Value& value, const std::string& fieldName,
-                             double min = 0.0, double max = 1000000.0);
-    static bool validatePrice(const Json::Value& value, const std::string& fieldName);
-    static bool validateQuantity(const Json::Value& value, const std::string& fieldName);
+    static bool validateId(const RouteMatch& route, std::string& error);
     
     // HTTP method validation
     static bool requiresValidation(const HttpMethod& method, const std::string& path);
-    static bool isCreateEndpoint(const std::string& path);
-    static bool isUpdateEndpoint(const std::string& path);
-    static bool isIdEndpoint(const std::string& path);
+    static bool isCreateEndpoint(const RouteMatch& route);
+    static bool isUpdateEndpoint(const RouteMatch& route);
+
+    // Largest ID accepted in a path (ten digits)
+    static constexpr int64_t kMaxId = 9999999999;
 
     // Response helpers
     static HttpResponsePtr createErrorResponse(const std::string& message,
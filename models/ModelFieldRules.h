@@ -0,0 +1,72 @@
+/**
+ *
+ *  ModelFieldRules.h
+ *  DO NOT EDIT. This file is generated by scripts/generate_model_field_rules.py
+ *
+ */
+
+#pragma once
+#include <array>
+#include "utils/fieldvalidator.h"
+
+namespace drogon_model
+{
+namespace sqlite3
+{
+
+/// Field rules of Products, in metaData_ order
+inline constexpr std::array<FieldRule, 12> kProductsFieldRules{{
+    integerField("product_id", false, true, 1.0),
+    textField("sku", true, 1, 50),
+    textField("name", true, 1, 100),
+    textField("description", false, 0, 500),
+    textField("category", false, 0, 100),
+    realField("unit_price", true, 0.01, 999999.99, 2),
+    integerField("quantity_in_stock", true, false, 0.0, 1000000.0),
+    integerField("reorder_threshold", true, false, 0.0, 1000000.0),
+    integerField("supplier_id", false, false, 1.0),
+    integerField("warehouse_id", false, false, 1.0),
+    dateTimeField("created_at", false, true),
+    dateTimeField("updated_at", false, true),
+}};
+
+/// Field rules of Supplier, in metaData_ order
+inline constexpr std::array<FieldRule, 8> kSupplierFieldRules{{
+    integerField("supplier_id", false, true, 1.0),
+    textField("name", true, 1, 100),
+    textField("contact_person", false, 0, 100),
+    textField("email", false, 0, 254),
+    textField("phone", false, 0, 50),
+    textField("address", false, 0, 500),
+    dateTimeField("created_at", false, true),
+    dateTimeField("updated_at", false, true),
+}};
+
+/// Field rules of Warehouse, in metaData_ order
+inline constexpr std::array<FieldRule, 6> kWarehouseFieldRules{{
+    integerField("warehouse_id", false, true, 1.0),
+    textField("name", true, 1, 100),
+    textField("location", false, 0, 255),
+    integerField("capacity", false, false, 0.0),
+    dateTimeField("created_at", false, true),
+    dateTimeField("updated_at", false, true),
+}};
+
+/// Field rules of PurchaseOrder, in metaData_ order
+inline constexpr std::array<FieldRule, 12> kPurchaseOrderFieldRules{{
+    integerField("order_id", false, true, 1.0),
+    integerField("product_id", true, false, 1.0),
+    integerField("supplier_id", true, false, 1.0),
+    integerField("quantity_ordered", true, false, 1.0, 1000000.0),
+    realField("unit_price", true, 0.0, 999999.99, 2),
+    realField("total_price", true, 0.0, std::numeric_limits<double>::max(), 2),
+    dateTimeField("order_date", false),
+    dateTimeField("expected_delivery_date", false),
+    dateTimeField("actual_delivery_date", false),
+    textField("status", true, 1, 20),
+    dateTimeField("created_at", false, true),
+    dateTimeField("updated_at", false, true),
+}};
+
+} // namespace sqlite3
+} // namespace drogon_model
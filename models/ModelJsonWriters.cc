@@ -0,0 +1,1794 @@
+/**
+ *
+ *  ModelJsonWriters.cc
+ *  DO NOT EDIT. This file is generated by scripts/generate_model_json_writers.py
+ *
+ */
+
+#include "ModelJsonWriters.h"
+#include "utils/jsonwriter.h"
+
+using namespace drogon_model::sqlite3;
+
+void drogon_model::sqlite3::appendJson(std::string &out, const Products &obj)
+{
+    appendJsonRaw(out, "{\"category\":");
+    if(obj.getCategory())
+    {
+        appendJsonString(out, obj.getValueOfCategory());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"created_at\":");
+    if(obj.getCreatedAt())
+    {
+        appendJsonString(out, obj.getCreatedAt()->toDbStringLocal());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"description\":");
+    if(obj.getDescription())
+    {
+        appendJsonString(out, obj.getValueOfDescription());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"name\":");
+    if(obj.getName())
+    {
+        appendJsonString(out, obj.getValueOfName());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"product_id\":");
+    if(obj.getProductId())
+    {
+        appendJsonInt(out, obj.getValueOfProductId());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"quantity_in_stock\":");
+    if(obj.getQuantityInStock())
+    {
+        appendJsonInt(out, obj.getValueOfQuantityInStock());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"reorder_threshold\":");
+    if(obj.getReorderThreshold())
+    {
+        appendJsonInt(out, obj.getValueOfReorderThreshold());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"sku\":");
+    if(obj.getSku())
+    {
+        appendJsonString(out, obj.getValueOfSku());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"supplier_id\":");
+    if(obj.getSupplierId())
+    {
+        appendJsonInt(out, obj.getValueOfSupplierId());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"unit_price\":");
+    if(obj.getUnitPrice())
+    {
+        appendJsonDouble(out, obj.getValueOfUnitPrice());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"updated_at\":");
+    if(obj.getUpdatedAt())
+    {
+        appendJsonString(out, obj.getUpdatedAt()->toDbStringLocal());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"warehouse_id\":");
+    if(obj.getWarehouseId())
+    {
+        appendJsonInt(out, obj.getValueOfWarehouseId());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    out += '}';
+}
+
+void drogon_model::sqlite3::appendJson(std::string &out, const Products &obj, uint64_t columnMask)
+{
+    char separator = '{';
+    if(columnMask & (1ULL << 4))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"category\":");
+        if(obj.getCategory())
+        {
+            appendJsonString(out, obj.getValueOfCategory());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 10))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"created_at\":");
+        if(obj.getCreatedAt())
+        {
+            appendJsonString(out, obj.getCreatedAt()->toDbStringLocal());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 3))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"description\":");
+        if(obj.getDescription())
+        {
+            appendJsonString(out, obj.getValueOfDescription());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 2))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"name\":");
+        if(obj.getName())
+        {
+            appendJsonString(out, obj.getValueOfName());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 0))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"product_id\":");
+        if(obj.getProductId())
+        {
+            appendJsonInt(out, obj.getValueOfProductId());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 6))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"quantity_in_stock\":");
+        if(obj.getQuantityInStock())
+        {
+            appendJsonInt(out, obj.getValueOfQuantityInStock());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 7))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"reorder_threshold\":");
+        if(obj.getReorderThreshold())
+        {
+            appendJsonInt(out, obj.getValueOfReorderThreshold());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 1))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"sku\":");
+        if(obj.getSku())
+        {
+            appendJsonString(out, obj.getValueOfSku());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 8))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"supplier_id\":");
+        if(obj.getSupplierId())
+        {
+            appendJsonInt(out, obj.getValueOfSupplierId());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 5))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"unit_price\":");
+        if(obj.getUnitPrice())
+        {
+            appendJsonDouble(out, obj.getValueOfUnitPrice());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 11))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"updated_at\":");
+        if(obj.getUpdatedAt())
+        {
+            appendJsonString(out, obj.getUpdatedAt()->toDbStringLocal());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 9))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"warehouse_id\":");
+        if(obj.getWarehouseId())
+        {
+            appendJsonInt(out, obj.getValueOfWarehouseId());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(separator == '{')
+    {
+        out += '{';
+    }
+    out += '}';
+}
+
+void drogon_model::sqlite3::readProjectedRow(const drogon::orm::Row &r, uint64_t columnMask, Products &obj)
+{
+    size_t index = 0;
+    if(columnMask & (1ULL << 0))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setProductId(r[index].as<int64_t>());
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 1))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setSku(r[index].as<std::string>());
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 2))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setName(r[index].as<std::string>());
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 3))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setDescription(r[index].as<std::string>());
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 4))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setCategory(r[index].as<std::string>());
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 5))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setUnitPrice(r[index].as<double>());
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 6))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setQuantityInStock(r[index].as<int64_t>());
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 7))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setReorderThreshold(r[index].as<int64_t>());
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 8))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setSupplierId(r[index].as<int64_t>());
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 9))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setWarehouseId(r[index].as<int64_t>());
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 10))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setCreatedAt(::trantor::Date::fromDbStringLocal(r[index].as<std::string>()));
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 11))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setUpdatedAt(::trantor::Date::fromDbStringLocal(r[index].as<std::string>()));
+        }
+        ++index;
+    }
+}
+
+void drogon_model::sqlite3::appendJson(std::string &out, const PurchaseOrder &obj)
+{
+    appendJsonRaw(out, "{\"actual_delivery_date\":");
+    if(obj.getActualDeliveryDate())
+    {
+        appendJsonString(out, obj.getActualDeliveryDate()->toDbStringLocal());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"created_at\":");
+    if(obj.getCreatedAt())
+    {
+        appendJsonString(out, obj.getCreatedAt()->toDbStringLocal());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"expected_delivery_date\":");
+    if(obj.getExpectedDeliveryDate())
+    {
+        appendJsonString(out, obj.getExpectedDeliveryDate()->toDbStringLocal());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"order_date\":");
+    if(obj.getOrderDate())
+    {
+        appendJsonString(out, obj.getOrderDate()->toDbStringLocal());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"order_id\":");
+    if(obj.getOrderId())
+    {
+        appendJsonInt(out, obj.getValueOfOrderId());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"product_id\":");
+    if(obj.getProductId())
+    {
+        appendJsonInt(out, obj.getValueOfProductId());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"quantity_ordered\":");
+    if(obj.getQuantityOrdered())
+    {
+        appendJsonInt(out, obj.getValueOfQuantityOrdered());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"status\":");
+    if(obj.getStatus())
+    {
+        appendJsonString(out, obj.getValueOfStatus());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"supplier_id\":");
+    if(obj.getSupplierId())
+    {
+        appendJsonInt(out, obj.getValueOfSupplierId());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"total_price\":");
+    if(obj.getTotalPrice())
+    {
+        appendJsonDouble(out, obj.getValueOfTotalPrice());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"unit_price\":");
+    if(obj.getUnitPrice())
+    {
+        appendJsonDouble(out, obj.getValueOfUnitPrice());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"updated_at\":");
+    if(obj.getUpdatedAt())
+    {
+        appendJsonString(out, obj.getUpdatedAt()->toDbStringLocal());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    out += '}';
+}
+
+void drogon_model::sqlite3::appendJson(std::string &out, const PurchaseOrder &obj, uint64_t columnMask)
+{
+    char separator = '{';
+    if(columnMask & (1ULL << 8))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"actual_delivery_date\":");
+        if(obj.getActualDeliveryDate())
+        {
+            appendJsonString(out, obj.getActualDeliveryDate()->toDbStringLocal());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 10))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"created_at\":");
+        if(obj.getCreatedAt())
+        {
+            appendJsonString(out, obj.getCreatedAt()->toDbStringLocal());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 7))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"expected_delivery_date\":");
+        if(obj.getExpectedDeliveryDate())
+        {
+            appendJsonString(out, obj.getExpectedDeliveryDate()->toDbStringLocal());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 6))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"order_date\":");
+        if(obj.getOrderDate())
+        {
+            appendJsonString(out, obj.getOrderDate()->toDbStringLocal());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 0))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"order_id\":");
+        if(obj.getOrderId())
+        {
+            appendJsonInt(out, obj.getValueOfOrderId());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 1))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"product_id\":");
+        if(obj.getProductId())
+        {
+            appendJsonInt(out, obj.getValueOfProductId());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 3))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"quantity_ordered\":");
+        if(obj.getQuantityOrdered())
+        {
+            appendJsonInt(out, obj.getValueOfQuantityOrdered());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 9))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"status\":");
+        if(obj.getStatus())
+        {
+            appendJsonString(out, obj.getValueOfStatus());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 2))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"supplier_id\":");
+        if(obj.getSupplierId())
+        {
+            appendJsonInt(out, obj.getValueOfSupplierId());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 5))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"total_price\":");
+        if(obj.getTotalPrice())
+        {
+            appendJsonDouble(out, obj.getValueOfTotalPrice());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 4))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"unit_price\":");
+        if(obj.getUnitPrice())
+        {
+            appendJsonDouble(out, obj.getValueOfUnitPrice());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 11))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"updated_at\":");
+        if(obj.getUpdatedAt())
+        {
+            appendJsonString(out, obj.getUpdatedAt()->toDbStringLocal());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(separator == '{')
+    {
+        out += '{';
+    }
+    out += '}';
+}
+
+void drogon_model::sqlite3::readProjectedRow(const drogon::orm::Row &r, uint64_t columnMask, PurchaseOrder &obj)
+{
+    size_t index = 0;
+    if(columnMask & (1ULL << 0))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setOrderId(r[index].as<int64_t>());
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 1))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setProductId(r[index].as<int64_t>());
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 2))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setSupplierId(r[index].as<int64_t>());
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 3))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setQuantityOrdered(r[index].as<int64_t>());
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 4))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setUnitPrice(r[index].as<double>());
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 5))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setTotalPrice(r[index].as<double>());
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 6))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setOrderDate(::trantor::Date::fromDbStringLocal(r[index].as<std::string>()));
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 7))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setExpectedDeliveryDate(::trantor::Date::fromDbStringLocal(r[index].as<std::string>()));
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 8))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setActualDeliveryDate(::trantor::Date::fromDbStringLocal(r[index].as<std::string>()));
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 9))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setStatus(r[index].as<std::string>());
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 10))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setCreatedAt(::trantor::Date::fromDbStringLocal(r[index].as<std::string>()));
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 11))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setUpdatedAt(::trantor::Date::fromDbStringLocal(r[index].as<std::string>()));
+        }
+        ++index;
+    }
+}
+
+void drogon_model::sqlite3::appendJson(std::string &out, const PurchaseOrders &obj)
+{
+    appendJsonRaw(out, "{\"expected_arrival_date\":");
+    if(obj.getExpectedArrivalDate())
+    {
+        appendJsonString(out, obj.getValueOfExpectedArrivalDate());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"order_date\":");
+    if(obj.getOrderDate())
+    {
+        appendJsonString(out, obj.getValueOfOrderDate());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"order_id\":");
+    if(obj.getOrderId())
+    {
+        appendJsonInt(out, obj.getValueOfOrderId());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"product_id\":");
+    if(obj.getProductId())
+    {
+        appendJsonInt(out, obj.getValueOfProductId());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"quantity_ordered\":");
+    if(obj.getQuantityOrdered())
+    {
+        appendJsonInt(out, obj.getValueOfQuantityOrdered());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"status\":");
+    if(obj.getStatus())
+    {
+        appendJsonString(out, obj.getValueOfStatus());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"supplier_id\":");
+    if(obj.getSupplierId())
+    {
+        appendJsonInt(out, obj.getValueOfSupplierId());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"warehouse_id\":");
+    if(obj.getWarehouseId())
+    {
+        appendJsonInt(out, obj.getValueOfWarehouseId());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    out += '}';
+}
+
+void drogon_model::sqlite3::appendJson(std::string &out, const PurchaseOrders &obj, uint64_t columnMask)
+{
+    char separator = '{';
+    if(columnMask & (1ULL << 6))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"expected_arrival_date\":");
+        if(obj.getExpectedArrivalDate())
+        {
+            appendJsonString(out, obj.getValueOfExpectedArrivalDate());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 5))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"order_date\":");
+        if(obj.getOrderDate())
+        {
+            appendJsonString(out, obj.getValueOfOrderDate());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 0))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"order_id\":");
+        if(obj.getOrderId())
+        {
+            appendJsonInt(out, obj.getValueOfOrderId());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 1))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"product_id\":");
+        if(obj.getProductId())
+        {
+            appendJsonInt(out, obj.getValueOfProductId());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 4))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"quantity_ordered\":");
+        if(obj.getQuantityOrdered())
+        {
+            appendJsonInt(out, obj.getValueOfQuantityOrdered());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 7))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"status\":");
+        if(obj.getStatus())
+        {
+            appendJsonString(out, obj.getValueOfStatus());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 2))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"supplier_id\":");
+        if(obj.getSupplierId())
+        {
+            appendJsonInt(out, obj.getValueOfSupplierId());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 3))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"warehouse_id\":");
+        if(obj.getWarehouseId())
+        {
+            appendJsonInt(out, obj.getValueOfWarehouseId());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(separator == '{')
+    {
+        out += '{';
+    }
+    out += '}';
+}
+
+void drogon_model::sqlite3::readProjectedRow(const drogon::orm::Row &r, uint64_t columnMask, PurchaseOrders &obj)
+{
+    size_t index = 0;
+    if(columnMask & (1ULL << 0))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setOrderId(r[index].as<int64_t>());
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 1))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setProductId(r[index].as<int64_t>());
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 2))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setSupplierId(r[index].as<int64_t>());
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 3))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setWarehouseId(r[index].as<int64_t>());
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 4))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setQuantityOrdered(r[index].as<int64_t>());
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 5))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setOrderDate(r[index].as<std::string>());
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 6))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setExpectedArrivalDate(r[index].as<std::string>());
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 7))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setStatus(r[index].as<std::string>());
+        }
+        ++index;
+    }
+}
+
+void drogon_model::sqlite3::appendJson(std::string &out, const Supplier &obj)
+{
+    appendJsonRaw(out, "{\"address\":");
+    if(obj.getAddress())
+    {
+        appendJsonString(out, obj.getValueOfAddress());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"contact_person\":");
+    if(obj.getContactPerson())
+    {
+        appendJsonString(out, obj.getValueOfContactPerson());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"created_at\":");
+    if(obj.getCreatedAt())
+    {
+        appendJsonString(out, obj.getCreatedAt()->toDbStringLocal());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"email\":");
+    if(obj.getEmail())
+    {
+        appendJsonString(out, obj.getValueOfEmail());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"name\":");
+    if(obj.getName())
+    {
+        appendJsonString(out, obj.getValueOfName());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"phone\":");
+    if(obj.getPhone())
+    {
+        appendJsonString(out, obj.getValueOfPhone());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"supplier_id\":");
+    if(obj.getSupplierId())
+    {
+        appendJsonInt(out, obj.getValueOfSupplierId());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"updated_at\":");
+    if(obj.getUpdatedAt())
+    {
+        appendJsonString(out, obj.getUpdatedAt()->toDbStringLocal());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    out += '}';
+}
+
+void drogon_model::sqlite3::appendJson(std::string &out, const Supplier &obj, uint64_t columnMask)
+{
+    char separator = '{';
+    if(columnMask & (1ULL << 5))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"address\":");
+        if(obj.getAddress())
+        {
+            appendJsonString(out, obj.getValueOfAddress());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 2))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"contact_person\":");
+        if(obj.getContactPerson())
+        {
+            appendJsonString(out, obj.getValueOfContactPerson());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 6))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"created_at\":");
+        if(obj.getCreatedAt())
+        {
+            appendJsonString(out, obj.getCreatedAt()->toDbStringLocal());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 3))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"email\":");
+        if(obj.getEmail())
+        {
+            appendJsonString(out, obj.getValueOfEmail());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 1))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"name\":");
+        if(obj.getName())
+        {
+            appendJsonString(out, obj.getValueOfName());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 4))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"phone\":");
+        if(obj.getPhone())
+        {
+            appendJsonString(out, obj.getValueOfPhone());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 0))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"supplier_id\":");
+        if(obj.getSupplierId())
+        {
+            appendJsonInt(out, obj.getValueOfSupplierId());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 7))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"updated_at\":");
+        if(obj.getUpdatedAt())
+        {
+            appendJsonString(out, obj.getUpdatedAt()->toDbStringLocal());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(separator == '{')
+    {
+        out += '{';
+    }
+    out += '}';
+}
+
+void drogon_model::sqlite3::readProjectedRow(const drogon::orm::Row &r, uint64_t columnMask, Supplier &obj)
+{
+    size_t index = 0;
+    if(columnMask & (1ULL << 0))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setSupplierId(r[index].as<int64_t>());
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 1))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setName(r[index].as<std::string>());
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 2))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setContactPerson(r[index].as<std::string>());
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 3))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setEmail(r[index].as<std::string>());
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 4))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setPhone(r[index].as<std::string>());
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 5))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setAddress(r[index].as<std::string>());
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 6))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setCreatedAt(::trantor::Date::fromDbStringLocal(r[index].as<std::string>()));
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 7))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setUpdatedAt(::trantor::Date::fromDbStringLocal(r[index].as<std::string>()));
+        }
+        ++index;
+    }
+}
+
+void drogon_model::sqlite3::appendJson(std::string &out, const Suppliers &obj)
+{
+    appendJsonRaw(out, "{\"contact_info\":");
+    if(obj.getContactInfo())
+    {
+        appendJsonString(out, obj.getValueOfContactInfo());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"name\":");
+    if(obj.getName())
+    {
+        appendJsonString(out, obj.getValueOfName());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"supplier_id\":");
+    if(obj.getSupplierId())
+    {
+        appendJsonInt(out, obj.getValueOfSupplierId());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    out += '}';
+}
+
+void drogon_model::sqlite3::appendJson(std::string &out, const Suppliers &obj, uint64_t columnMask)
+{
+    char separator = '{';
+    if(columnMask & (1ULL << 2))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"contact_info\":");
+        if(obj.getContactInfo())
+        {
+            appendJsonString(out, obj.getValueOfContactInfo());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 1))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"name\":");
+        if(obj.getName())
+        {
+            appendJsonString(out, obj.getValueOfName());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 0))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"supplier_id\":");
+        if(obj.getSupplierId())
+        {
+            appendJsonInt(out, obj.getValueOfSupplierId());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(separator == '{')
+    {
+        out += '{';
+    }
+    out += '}';
+}
+
+void drogon_model::sqlite3::readProjectedRow(const drogon::orm::Row &r, uint64_t columnMask, Suppliers &obj)
+{
+    size_t index = 0;
+    if(columnMask & (1ULL << 0))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setSupplierId(r[index].as<int64_t>());
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 1))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setName(r[index].as<std::string>());
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 2))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setContactInfo(r[index].as<std::string>());
+        }
+        ++index;
+    }
+}
+
+void drogon_model::sqlite3::appendJson(std::string &out, const Warehouse &obj)
+{
+    appendJsonRaw(out, "{\"capacity\":");
+    if(obj.getCapacity())
+    {
+        appendJsonInt(out, obj.getValueOfCapacity());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"created_at\":");
+    if(obj.getCreatedAt())
+    {
+        appendJsonString(out, obj.getCreatedAt()->toDbStringLocal());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"location\":");
+    if(obj.getLocation())
+    {
+        appendJsonString(out, obj.getValueOfLocation());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"name\":");
+    if(obj.getName())
+    {
+        appendJsonString(out, obj.getValueOfName());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"updated_at\":");
+    if(obj.getUpdatedAt())
+    {
+        appendJsonString(out, obj.getUpdatedAt()->toDbStringLocal());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"warehouse_id\":");
+    if(obj.getWarehouseId())
+    {
+        appendJsonInt(out, obj.getValueOfWarehouseId());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    out += '}';
+}
+
+void drogon_model::sqlite3::appendJson(std::string &out, const Warehouse &obj, uint64_t columnMask)
+{
+    char separator = '{';
+    if(columnMask & (1ULL << 3))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"capacity\":");
+        if(obj.getCapacity())
+        {
+            appendJsonInt(out, obj.getValueOfCapacity());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 4))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"created_at\":");
+        if(obj.getCreatedAt())
+        {
+            appendJsonString(out, obj.getCreatedAt()->toDbStringLocal());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 2))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"location\":");
+        if(obj.getLocation())
+        {
+            appendJsonString(out, obj.getValueOfLocation());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 1))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"name\":");
+        if(obj.getName())
+        {
+            appendJsonString(out, obj.getValueOfName());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 5))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"updated_at\":");
+        if(obj.getUpdatedAt())
+        {
+            appendJsonString(out, obj.getUpdatedAt()->toDbStringLocal());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 0))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"warehouse_id\":");
+        if(obj.getWarehouseId())
+        {
+            appendJsonInt(out, obj.getValueOfWarehouseId());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(separator == '{')
+    {
+        out += '{';
+    }
+    out += '}';
+}
+
+void drogon_model::sqlite3::readProjectedRow(const drogon::orm::Row &r, uint64_t columnMask, Warehouse &obj)
+{
+    size_t index = 0;
+    if(columnMask & (1ULL << 0))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setWarehouseId(r[index].as<int64_t>());
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 1))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setName(r[index].as<std::string>());
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 2))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setLocation(r[index].as<std::string>());
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 3))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setCapacity(r[index].as<int64_t>());
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 4))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setCreatedAt(::trantor::Date::fromDbStringLocal(r[index].as<std::string>()));
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 5))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setUpdatedAt(::trantor::Date::fromDbStringLocal(r[index].as<std::string>()));
+        }
+        ++index;
+    }
+}
+
+void drogon_model::sqlite3::appendJson(std::string &out, const Warehouses &obj)
+{
+    appendJsonRaw(out, "{\"capacity\":");
+    if(obj.getCapacity())
+    {
+        appendJsonInt(out, obj.getValueOfCapacity());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"location\":");
+    if(obj.getLocation())
+    {
+        appendJsonString(out, obj.getValueOfLocation());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"name\":");
+    if(obj.getName())
+    {
+        appendJsonString(out, obj.getValueOfName());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    appendJsonRaw(out, ",\"warehouse_id\":");
+    if(obj.getWarehouseId())
+    {
+        appendJsonInt(out, obj.getValueOfWarehouseId());
+    }
+    else
+    {
+        appendJsonNull(out);
+    }
+    out += '}';
+}
+
+void drogon_model::sqlite3::appendJson(std::string &out, const Warehouses &obj, uint64_t columnMask)
+{
+    char separator = '{';
+    if(columnMask & (1ULL << 3))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"capacity\":");
+        if(obj.getCapacity())
+        {
+            appendJsonInt(out, obj.getValueOfCapacity());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 2))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"location\":");
+        if(obj.getLocation())
+        {
+            appendJsonString(out, obj.getValueOfLocation());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 1))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"name\":");
+        if(obj.getName())
+        {
+            appendJsonString(out, obj.getValueOfName());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(columnMask & (1ULL << 0))
+    {
+        out += separator;
+        separator = ',';
+        appendJsonRaw(out, "\"warehouse_id\":");
+        if(obj.getWarehouseId())
+        {
+            appendJsonInt(out, obj.getValueOfWarehouseId());
+        }
+        else
+        {
+            appendJsonNull(out);
+        }
+    }
+    if(separator == '{')
+    {
+        out += '{';
+    }
+    out += '}';
+}
+
+void drogon_model::sqlite3::readProjectedRow(const drogon::orm::Row &r, uint64_t columnMask, Warehouses &obj)
+{
+    size_t index = 0;
+    if(columnMask & (1ULL << 0))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setWarehouseId(r[index].as<int64_t>());
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 1))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setName(r[index].as<std::string>());
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 2))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setLocation(r[index].as<std::string>());
+        }
+        ++index;
+    }
+    if(columnMask & (1ULL << 3))
+    {
+        if(!r[index].isNull())
+        {
+            obj.setCapacity(r[index].as<int64_t>());
+        }
+        ++index;
+    }
+}
@@ -0,0 +1,68 @@
+/**
+ *
+ *  ModelJsonWriters.h
+ *  DO NOT EDIT. This file is generated by scripts/generate_model_json_writers.py
+ *
+ */
+
+#pragma once
+#include "Products.h"
+#include "PurchaseOrder.h"
+#include "PurchaseOrders.h"
+#include "Supplier.h"
+#include "Suppliers.h"
+#include "Warehouse.h"
+#include "Warehouses.h"
+#include <cstdint>
+#include <string>
+
+namespace drogon_model
+{
+namespace sqlite3
+{
+
+/// Append obj as compact JSON, byte-identical to the drogon serialization of obj.toJson()
+void appendJson(std::string &out, const Products &obj);
+/// Same as above restricted to the columns whose metaData_ index bit is set in columnMask
+void appendJson(std::string &out, const Products &obj, uint64_t columnMask);
+/// Fill obj from a row holding only the masked columns, in metaData_ order
+void readProjectedRow(const drogon::orm::Row &r, uint64_t columnMask, Products &obj);
+/// Append obj as compact JSON, byte-identical to the drogon serialization of obj.toJson()
+void appendJson(std::string &out, const PurchaseOrder &obj);
+/// Same as above restricted to the columns whose metaData_ index bit is set in columnMask
+void appendJson(std::string &out, const PurchaseOrder &obj, uint64_t columnMask);
+/// Fill obj from a row holding only the masked columns, in metaData_ order
+void readProjectedRow(const drogon::orm::Row &r, uint64_t columnMask, PurchaseOrder &obj);
+/// Append obj as compact JSON, byte-identical to the drogon serialization of obj.toJson()
+void appendJson(std::string &out, const PurchaseOrders &obj);
+/// Same as above restricted to the columns whose metaData_ index bit is set in columnMask
+void appendJson(std::string &out, const PurchaseOrders &obj, uint64_t columnMask);
+/// Fill obj from a row holding only the masked columns, in metaData_ order
+void readProjectedRow(const drogon::orm::Row &r, uint64_t columnMask, PurchaseOrders &obj);
+/// Append obj as compact JSON, byte-identical to the drogon serialization of obj.toJson()
+void appendJson(std::string &out, const Supplier &obj);
+/// Same as above restricted to the columns whose metaData_ index bit is set in columnMask
+void appendJson(std::string &out, const Supplier &obj, uint64_t columnMask);
+/// Fill obj from a row holding only the masked columns, in metaData_ order
+void readProjectedRow(const drogon::orm::Row &r, uint64_t columnMask, Supplier &obj);
+/// Append obj as compact JSON, byte-identical to the drogon serialization of obj.toJson()
+void appendJson(std::string &out, const Suppliers &obj);
+/// Same as above restricted to the columns whose metaData_ index bit is set in columnMask
+void appendJson(std::string &out, const Suppliers &obj, uint64_t columnMask);
+/// Fill obj from a row holding only the masked columns, in metaData_ order
+void readProjectedRow(const drogon::orm::Row &r, uint64_t columnMask, Suppliers &obj);
+/// Append obj as compact JSON, byte-identical to the drogon serialization of obj.toJson()
+void appendJson(std::string &out, const Warehouse &obj);
+/// Same as above restricted to the columns whose metaData_ index bit is set in columnMask
+void appendJson(std::string &out, const Warehouse &obj, uint64_t columnMask);
+/// Fill obj from a row holding only the masked columns, in metaData_ order
+void readProjectedRow(const drogon::orm::Row &r, uint64_t columnMask, Warehouse &obj);
+/// Append obj as compact JSON, byte-identical to the drogon serialization of obj.toJson()
+void appendJson(std::string &out, const Warehouses &obj);
+/// Same as above restricted to the columns whose metaData_ index bit is set in columnMask
+void appendJson(std::string &out, const Warehouses &obj, uint64_t columnMask);
+/// Fill obj from a row holding only the masked columns, in metaData_ order
+void readProjectedRow(const drogon::orm::Row &r, uint64_t columnMask, Warehouses &obj);
+
+} // namespace sqlite3
+} // namespace drogon_model
@@ -0,0 +1,76 @@
+/**
+ *
+ *  IdempotencyStore.cc
+ *
+ */
+
+#include "IdempotencyStore.h"
+#include <drogon/HttpAppFramework.h>
+#include <drogon/orm/Exception.h>
+#include <trantor/utils/Logger.h>
+#include <cstdio>
+
+void IdempotencyStore::initAndStart(const Json::Value& config) {
+    const auto capacity = config.get("capacity", 100000).asUInt64();
+    ttlSeconds_ = config.get("ttl_seconds", 86400).asUInt64();
+    const auto shards = config.get("shards", 32).asUInt64();
+
+    cache_ = std::make_unique<ShardedLruCache<std::string, ResponsePtr>>(
+        capacity, std::chrono::seconds(ttlSeconds_), shards);
+
+    const std::string expired =
+        "created_at < datetime('now', '-" + std::to_string(ttlSeconds_) + " seconds')";
+    claimSql_ =
+        "insert into idempotency_keys (idempotency_key, fingerprint) values (?, ?) "
+        "on conflict(idempotency_key) do update set fingerprint = excluded.fingerprint, "
+        "status = 0, body = null, created_at = CURRENT_TIMESTAMP where idempotency_keys." +
+        expired;
+    // The claim already ignores expired rows; this only keeps the table small
+    const std::string purgeSql = "delete from idempotency_keys where " + expired;
+    purgeTimer_ = drogon::app().getLoop()->runEvery(3600.0, [purgeSql]() {
+        drogon::app().getDbClient()->execSqlAsync(
+            purgeSql,
+            [](const drogon::orm::Result& result) {
+                LOG_DEBUG << "IdempotencyStore purged " << result.affectedRows() << " keys";
+            },
+            [](const drogon::orm::DrogonDbException& e) {
+                LOG_WARN << "IdempotencyStore purge failed: " << e.base().what();
+            });
+    });
+    LOG_INFO << "IdempotencyStore enabled: capacity=" << capacity << " ttl=" << ttlSeconds_
+             << "s shards=" << shards;
+}
+
+void IdempotencyStore::shutdown() {
+    drogon::app().getLoop()->invalidateTimer(purgeTimer_);
+    cache_->clear();
+}
+
+std::string IdempotencyStore::fingerprint(const drogon::HttpRequestPtr& req) {
+    uint64_t bodyHash = 14695981039346656037ULL;
+    for (unsigned char c : req->getBody()) {
+        bodyHash = (bodyHash ^ c) * 1099511628211ULL;
+    }
+    char hash[17];
+    std::snprintf(hash, sizeof(hash), "%016llx", static_cast<unsigned long long>(bodyHash));
+    std::string ret(req->getMethodString());
+    ret += ' ';
+    ret += req->getPath();
+    ret += ' ';
+    ret += hash;
+    return ret;
+}
+
+Json::Value IdempotencyStore::stats() const {
+    const auto s = cache_->stats();
+    Json::Value ret;
+    ret["replays"] = static_cast<Json::UInt64>(s.hits);
+    ret["misses"] = static_cast<Json::UInt64>(s.misses);
+    ret["stored"] = static_cast<Json::UInt64>(s.insertions);
+    ret["evictions"] = static_cast<Json::UInt64>(s.evictions);
+    ret["expirations"] = static_cast<Json::UInt64>(s.expirations);
+    ret["size"] = static_cast<Json::UInt64>(s.size);
+    ret["capacity"] = static_cast<Json::UInt64>(s.capacity);
+    ret["ttl_seconds"] = static_cast<Json::UInt64>(ttlSeconds_);
+    return ret;
+}
@@ -0,0 +1,90 @@
+/**
+ *
+ *  IdempotencyStore.h
+ *
+ */
+
+#pragma once
+
+#include <drogon/HttpRequest.h>
+#include <drogon/plugins/Plugin.h>
+#include <trantor/net/EventLoop.h>
+#include <memory>
+#include <string>
+#include "utils/shardedlrucache.h"
+
+/**
+ * @brief Responses of writes sent with an Idempotency-Key header, for replaying retries
+ *
+ * A keyed write claims its key in the idempotency_keys table inside its own
+ * transaction and stores its response there before committing, so the write and its
+ * replay record are durable together. The committed response is also kept in this
+ * sharded, time-expiring table in memory: a retry is answered from it on the IO
+ * thread with one shard lookup and no SQL. Keys that have left memory (eviction,
+ * restart) are still found through the table, because claiming them fails. A row
+ * older than ttl_seconds does not block the claim, even before the hourly purge has
+ * removed it: claimSql() takes it over.
+ *
+ * config.json:
+ * @code
+   {
+      "name": "IdempotencyStore",
+      "config": {
+         "capacity": 100000,    // responses kept in memory
+         "ttl_seconds": 86400,  // how long a key is honoured, in memory and in the table
+         "shards": 32
+      }
+   }
+   @endcode
+ */
+class IdempotencyStore : public drogon::Plugin<IdempotencyStore> {
+  public:
+    /// Longest accepted Idempotency-Key header value
+    static constexpr size_t kMaxKeyLength = 255;
+
+    struct Response {
+        /// Identifies the request the key was first used with, see fingerprint()
+        std::string fingerprint;
+        int status{0};
+        std::string body;
+    };
+    using ResponsePtr = std::shared_ptr<const Response>;
+
+    IdempotencyStore() = default;
+    void initAndStart(const Json::Value& config) override;
+    void shutdown() override;
+
+    bool find(const std::string& key, ResponsePtr& response) {
+        return cache_->find(key, response);
+    }
+    /// Call once the keyed write has committed
+    void remember(const std::string& key, ResponsePtr response) {
+        cache_->insert(key, std::move(response));
+    }
+
+    /**
+     * @brief Statement claiming a key inside the write's transaction
+     *
+     * Binds: key, fingerprint. Affects no row when the key is taken and younger than
+     * ttl_seconds; an expired row is overwritten as a fresh claim.
+     */
+    const std::string& claimSql() const {
+        return claimSql_;
+    }
+
+    /**
+     * @brief Method, path and a hash of the body; a key reused for another request is refused
+     *
+     * The hash is FNV-1a, so fingerprints stored in idempotency_keys stay comparable
+     * across builds and standard libraries.
+     */
+    static std::string fingerprint(const drogon::HttpRequestPtr& req);
+
+    Json::Value stats() const;
+
+  private:
+    std::unique_ptr<ShardedLruCache<std::string, ResponsePtr>> cache_;
+    uint64_t ttlSeconds_{86400};
+    std::string claimSql_;
+    trantor::TimerId purgeTimer_{0};
+};
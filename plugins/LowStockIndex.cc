@@ -0,0 +1,168 @@
+/**
+ *
+ *  LowStockIndex.cc
+ *
+ */
+
+#include "LowStockIndex.h"
+#include <drogon/orm/Exception.h>
+#include <trantor/utils/Logger.h>
+#include <algorithm>
+
+void LowStockIndex::initAndStart(const Json::Value& config) {
+    LOG_INFO << "LowStockIndex enabled, waiting for database initialization";
+}
+
+void LowStockIndex::shutdown() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    byGap_.clear();
+    keyById_.clear();
+    tracked_.clear();
+    aboveThreshold_.clear();
+    versions_.clear();
+    ready_ = false;
+}
+
+void LowStockIndex::load(const drogon::orm::DbClientPtr& dbClient) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        loading_ = true;
+        touchedDuringLoad_.clear();
+    }
+    try {
+        // One scan at startup; from here on the index is kept current by the writers
+        auto result = dbClient->execSqlSync(
+            "select product_id, sku, name, quantity_in_stock, reorder_threshold from products "
+            "where quantity_in_stock <= reorder_threshold");
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& row : result) {
+            Entry entry;
+            entry.productId = row["product_id"].as<int64_t>();
+            if (touchedDuringLoad_.count(entry.productId)) {
+                continue;
+            }
+            entry.sku = row["sku"].as<std::string>();
+            entry.name = row["name"].as<std::string>();
+            entry.quantityInStock = row["quantity_in_stock"].as<int64_t>();
+            entry.reorderThreshold = row["reorder_threshold"].as<int64_t>();
+            upsertLocked(std::move(entry));
+        }
+        loading_ = false;
+        touchedDuringLoad_.clear();
+        ready_ = true;
+        LOG_INFO << "LowStockIndex loaded " << byGap_.size() << " products";
+    } catch (const drogon::orm::DrogonDbException& e) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        loading_ = false;
+        LOG_ERROR << "LowStockIndex load failed: " << e.base().what();
+    }
+}
+
+bool LowStockIndex::ready() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return ready_;
+}
+
+void LowStockIndex::update(const drogon_model::sqlite3::Products& product, int64_t version) {
+    Entry entry;
+    entry.productId = product.getValueOfProductId();
+    entry.sku = product.getValueOfSku();
+    entry.name = product.getValueOfName();
+    entry.quantityInStock = product.getValueOfQuantityInStock();
+    entry.reorderThreshold = product.getValueOfReorderThreshold();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (staleLocked(entry.productId, version)) {
+        return;
+    }
+    if (loading_) {
+        touchedDuringLoad_.insert(entry.productId);
+    }
+    upsertLocked(std::move(entry));
+}
+
+void LowStockIndex::track(const drogon_model::sqlite3::Products& product, int64_t version) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tracked_.insert(product.getValueOfProductId());
+    }
+    update(product, version);
+}
+
+void LowStockIndex::updateStock(int64_t productId, int64_t quantityInStock) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry entry;
+    if (auto it = keyById_.find(productId); it != keyById_.end()) {
+        entry = byGap_.at(it->second);
+    } else if (auto above = aboveThreshold_.find(productId); above != aboveThreshold_.end()) {
+        entry = above->second;
+    } else {
+        return;
+    }
+    if (loading_) {
+        touchedDuringLoad_.insert(productId);
+    }
+    entry.quantityInStock = quantityInStock;
+    upsertLocked(std::move(entry));
+}
+
+void LowStockIndex::remove(int64_t productId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (loading_) {
+        touchedDuringLoad_.insert(productId);
+    }
+    removeLocked(productId);
+    tracked_.erase(productId);
+    versions_.erase(productId);
+}
+
+std::vector<LowStockIndex::Entry> LowStockIndex::lowest(size_t limit) const {
+    std::vector<Entry> entries;
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries.reserve(std::min(limit, byGap_.size()));
+    for (auto it = byGap_.begin(); it != byGap_.end() && entries.size() < limit; ++it) {
+        entries.push_back(it->second);
+    }
+    return entries;
+}
+
+size_t LowStockIndex::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return byGap_.size();
+}
+
+bool LowStockIndex::staleLocked(int64_t productId, int64_t version) {
+    if (version == 0) {
+        return false;
+    }
+    auto& latest = versions_[productId];
+    if (version < latest) {
+        return true;
+    }
+    latest = version;
+    return false;
+}
+
+void LowStockIndex::upsertLocked(Entry&& entry) {
+    removeLocked(entry.productId);
+    const int64_t gap = entry.quantityInStock - entry.reorderThreshold;
+    if (gap > 0) {
+        if (tracked_.count(entry.productId)) {
+            aboveThreshold_[entry.productId] = std::move(entry);
+        }
+        return;
+    }
+    const Key key{gap, entry.productId};
+    keyById_.emplace(entry.productId, key);
+    byGap_.emplace(key, std::move(entry));
+}
+
+void LowStockIndex::removeLocked(int64_t productId) {
+    aboveThreshold_.erase(productId);
+    auto it = keyById_.find(productId);
+    if (it == keyById_.end()) {
+        return;
+    }
+    byGap_.erase(it->second);
+    keyById_.erase(it);
+}
@@ -0,0 +1,100 @@
+/**
+ *
+ *  LowStockIndex.h
+ *
+ */
+
+#pragma once
+
+#include <drogon/orm/DbClient.h>
+#include <drogon/plugins/Plugin.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "models/Products.h"
+
+/**
+ * @brief In-memory watchlist of products at or below their reorder threshold
+ *
+ * Products with quantity_in_stock - reorder_threshold <= 0 are kept ordered by that
+ * gap (most urgent first, then by product_id), so GET /api/products/low-stock reads
+ * the first k entries without touching SQLite. The index is loaded once after the
+ * database is initialized and then maintained by every product write.
+ *
+ * Quantities include the deltas StockDeltaBuffer has not flushed yet. Products in
+ * write-behind mode are tracked, so their entry follows each buffered adjustment
+ * through updateStock() without a row to read.
+ *
+ * config.json:
+ * @code
+   {
+      "name": "LowStockIndex",
+      "config": {}
+   }
+   @endcode
+ */
+class LowStockIndex : public drogon::Plugin<LowStockIndex> {
+  public:
+    struct Entry {
+        int64_t productId{0};
+        std::string sku;
+        std::string name;
+        int64_t quantityInStock{0};
+        int64_t reorderThreshold{0};
+    };
+
+    LowStockIndex() = default;
+    void initAndStart(const Json::Value& config) override;
+    void shutdown() override;
+
+    /// Rebuild from the products table; writes that race with the load win
+    void load(const drogon::orm::DbClientPtr& dbClient);
+
+    /// False until load() has completed
+    bool ready() const;
+
+    /**
+     * @brief Record the committed state of @p product after an insert or update
+     *
+     * @param version The row's version column. A row older than the last one recorded
+     * is ignored, since writers can report out of order; 0 if unknown (inserts).
+     */
+    void update(const drogon_model::sqlite3::Products& product, int64_t version = 0);
+    /// Same as update(), and keep following @p product while it is above its threshold
+    void track(const drogon_model::sqlite3::Products& product, int64_t version = 0);
+    /// Move an indexed or tracked product to @p quantityInStock; others are ignored
+    void updateStock(int64_t productId, int64_t quantityInStock);
+    /// Drop a deleted product
+    void remove(int64_t productId);
+
+    /// Up to @p limit entries, most urgent first
+    std::vector<Entry> lowest(size_t limit) const;
+
+    /// Number of products currently at or below their threshold
+    size_t size() const;
+
+  private:
+    using Key = std::pair<int64_t, int64_t>;  // (gap, product_id)
+
+    void upsertLocked(Entry&& entry);
+    /// True if @p version is older than the last row of @p productId; else record it
+    bool staleLocked(int64_t productId, int64_t version);
+    void removeLocked(int64_t productId);
+
+    mutable std::mutex mutex_;
+    std::map<Key, Entry> byGap_;
+    std::unordered_map<int64_t, Key> keyById_;
+    /// Tracked products, with their entry while they are above the threshold
+    std::unordered_set<int64_t> tracked_;
+    std::unordered_map<int64_t, Entry> aboveThreshold_;
+    /// Row version of the last update() of each product
+    std::unordered_map<int64_t, int64_t> versions_;
+    bool ready_{false};
+    bool loading_{false};
+    /// Products written while load() was reading; their snapshot rows are stale
+    std::unordered_set<int64_t> touchedDuringLoad_;
+};
@@ -0,0 +1,40 @@
+/**
+ *
+ *  ProductCache.cc
+ *
+ */
+
+#include "ProductCache.h"
+#include <trantor/utils/Logger.h>
+
+void ProductCache::initAndStart(const Json::Value& config) {
+    const auto capacity = config.get("capacity", 10000).asUInt64();
+    const auto ttlSeconds = config.get("ttl_seconds", 300).asUInt64();
+    const auto shards = config.get("shards", 16).asUInt64();
+
+    cache_ = std::make_unique<ShardedLruCache<int64_t, EntryPtr>>(
+        capacity, std::chrono::seconds(ttlSeconds), shards);
+    LOG_INFO << "ProductCache enabled: capacity=" << capacity << " ttl=" << ttlSeconds
+             << "s shards=" << shards;
+}
+
+void ProductCache::shutdown() {
+    cache_->clear();
+}
+
+Json::Value ProductCache::stats() const {
+    const auto s = cache_->stats();
+    Json::Value ret;
+    ret["hits"] = static_cast<Json::UInt64>(s.hits);
+    ret["misses"] = static_cast<Json::UInt64>(s.misses);
+    ret["hit_ratio"] =
+        s.hits + s.misses == 0 ? 0.0 : static_cast<double>(s.hits) / (s.hits + s.misses);
+    ret["insertions"] = static_cast<Json::UInt64>(s.insertions);
+    ret["evictions"] = static_cast<Json::UInt64>(s.evictions);
+    ret["expirations"] = static_cast<Json::UInt64>(s.expirations);
+    ret["invalidations"] = static_cast<Json::UInt64>(s.invalidations);
+    ret["stale_fills_dropped"] = static_cast<Json::UInt64>(s.staleFills);
+    ret["size"] = static_cast<Json::UInt64>(s.size);
+    ret["capacity"] = static_cast<Json::UInt64>(s.capacity);
+    return ret;
+}
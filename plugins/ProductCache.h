@@ -0,0 +1,66 @@
+/**
+ *
+ *  ProductCache.h
+ *
+ */
+
+#pragma once
+
+#include <drogon/plugins/Plugin.h>
+#include <memory>
+#include "models/Products.h"
+#include "utils/shardedlrucache.h"
+
+/**
+ * @brief In-process read-through cache for GET /api/products/{id}
+ *
+ * Holds recently read products keyed by product_id. Enable it by listing the plugin
+ * in config.json:
+ * @code
+   {
+      "name": "ProductCache",
+      "config": {
+         "capacity": 10000,   // max cached products
+         "ttl_seconds": 300,  // 0 = entries only leave by LRU or invalidation
+         "shards": 16         // independently locked partitions
+      }
+   }
+   @endcode
+ * Writers must call invalidate() for every product they touch. Each entry carries the
+ * row's version column, which the generated model does not map, so a hit can still be
+ * served with the row's ETag.
+ */
+class ProductCache : public drogon::Plugin<ProductCache> {
+  public:
+    using ProductPtr = std::shared_ptr<const drogon_model::sqlite3::Products>;
+
+    struct Entry {
+        drogon_model::sqlite3::Products product;
+        /// products.version of the row as read
+        int64_t version{0};
+    };
+    using EntryPtr = std::shared_ptr<const Entry>;
+
+    ProductCache() = default;
+    void initAndStart(const Json::Value& config) override;
+    void shutdown() override;
+
+    bool find(int64_t productId, EntryPtr& entry) {
+        return cache_->find(productId, entry);
+    }
+    uint64_t fillToken(int64_t productId) {
+        return cache_->fillToken(productId);
+    }
+    void fill(int64_t productId, EntryPtr entry, uint64_t token) {
+        cache_->insert(productId, std::move(entry), token);
+    }
+    void invalidate(int64_t productId) {
+        cache_->erase(productId);
+    }
+
+    /// Hit/miss/eviction counters for sizing the cache
+    Json::Value stats() const;
+
+  private:
+    std::unique_ptr<ShardedLruCache<int64_t, EntryPtr>> cache_;
+};
@@ -0,0 +1,270 @@
+/**
+ *
+ *  RequestLog.cc
+ *
+ */
+
+#include "RequestLog.h"
+#include <drogon/HttpAppFramework.h>
+#include <trantor/utils/Logger.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include "utils/jsonwriter.h"
+
+namespace {
+/// Names of the RouteKind values, as used in sample_every and the log lines
+constexpr const char* kRouteNames[] = {
+    "unknown",
+    "api_index",
+    "collection",
+    "item",
+    "cache_stats",
+    "product_batch_get",
+    "product_bulk",
+    "product_by_sku",
+    "product_adjust_batch",
+    "product_export",
+    "product_low_stock",
+    "product_adjust",
+    "product_availability",
+    "product_reserve",
+    "reservation",
+    "reservation_commit",
+};
+
+constexpr const char* kLevelNames[] = {"", "warn", "info", "debug"};
+constexpr const char* kEventNames[] = {"passed", "rejected", "skipped"};
+
+const char* methodName(drogon::HttpMethod method) {
+    switch (method) {
+        case drogon::Get:
+            return "GET";
+        case drogon::Post:
+            return "POST";
+        case drogon::Head:
+            return "HEAD";
+        case drogon::Put:
+            return "PUT";
+        case drogon::Delete:
+            return "DELETE";
+        case drogon::Options:
+            return "OPTIONS";
+        case drogon::Patch:
+            return "PATCH";
+        default:
+            return "INVALID";
+    }
+}
+
+/// Copy up to @p capacity bytes of @p text without splitting a UTF-8 character
+size_t copyTruncated(char* dest, size_t capacity, std::string_view text) {
+    size_t length = std::min(text.size(), capacity);
+    if (length < text.size()) {
+        while (length > 0 && (static_cast<unsigned char>(text[length]) & 0xC0) == 0x80) {
+            --length;
+        }
+    }
+    if (length != 0) {
+        std::memcpy(dest, text.data(), length);
+    }
+    return length;
+}
+
+}  // namespace
+
+static_assert(std::size(kRouteNames) == static_cast<size_t>(RouteKind::ReservationCommit) + 1,
+              "every RouteKind needs a name");
+
+void RequestLog::initAndStart(const Json::Value& config) {
+    size_t capacity = 1;
+    const size_t requested = std::max<uint64_t>(2, config.get("capacity", 8192).asUInt64());
+    while (capacity < requested) {
+        capacity <<= 1;
+    }
+    slots_ = std::make_unique<Slot[]>(capacity);
+    mask_ = capacity - 1;
+    for (size_t i = 0; i < capacity; ++i) {
+        slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    const Json::Value& sampling = config["sample_every"];
+    const uint32_t every = std::max(1u, sampling.get("default", 1).asUInt());
+    for (size_t i = 0; i < kRouteKinds; ++i) {
+        sampleEvery_[i] = std::max(1u, sampling.get(kRouteNames[i], every).asUInt());
+    }
+    bodyBytes_ = std::min<size_t>(config.get("body_bytes", 0).asUInt64(), kMaxBody);
+
+    const std::string path = config.get("log_path", "requests.log").asString();
+    file_ = std::fopen(path.c_str(), "a");
+    if (!file_) {
+        LOG_ERROR << "RequestLog cannot open " << path << ", request records are dropped";
+        return;
+    }
+    const double intervalMs = std::max(1.0, config.get("flush_interval_ms", 100).asDouble());
+    loopThread_ = std::make_unique<trantor::EventLoopThread>("RequestLog");
+    loopThread_->run();
+    loopThread_->getLoop()->runEvery(intervalMs / 1000.0, [this]() { flush(); });
+    enabled_ = true;
+    LOG_INFO << "RequestLog enabled: " << capacity << " records to " << path << ", level "
+             << REQUEST_LOG_LEVEL << (bodyBytes_ ? ", with bodies" : "");
+}
+
+void RequestLog::shutdown() {
+    enabled_ = false;
+    loopThread_.reset();
+    flush();
+    std::lock_guard<std::mutex> lock(flushMutex_);
+    if (file_) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+RequestLog* RequestLog::instance() {
+    static RequestLog* log = drogon::app().getPlugin<RequestLog>();
+    return log;
+}
+
+bool RequestLog::sampled(RouteKind route) {
+    const size_t index = static_cast<size_t>(route);
+    const uint32_t every = sampleEvery_[index];
+    return every == 1 ||
+           routeCounts_[index].fetch_add(1, std::memory_order_relaxed) % every == 0;
+}
+
+void RequestLog::write(RequestLogLevel level, RequestLogEvent event,
+                       const drogon::HttpRequestPtr& req, RouteKind route, uint16_t status,
+                       std::string_view message) {
+    if (!enabled_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    if (level != RequestLogLevel::Warn && !sampled(route)) {
+        sampledOut_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // Claim a slot (bounded multi-producer queue); a full ring drops the record
+    uint64_t position = head_.load(std::memory_order_relaxed);
+    Slot* slot = nullptr;
+    for (;;) {
+        slot = &slots_[position & mask_];
+        const uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+        const auto lag = static_cast<int64_t>(sequence - position);
+        if (lag == 0) {
+            if (head_.compare_exchange_weak(position, position + 1,
+                                            std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (lag < 0) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        } else {
+            position = head_.load(std::memory_order_relaxed);
+        }
+    }
+
+    Record& record = slot->record;
+    record.timeUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::system_clock::now().time_since_epoch())
+                        .count();
+    const auto body = req->getBody();
+    record.bodySize = static_cast<uint32_t>(std::min<size_t>(body.size(), UINT32_MAX));
+    record.status = status;
+    record.level = level;
+    record.event = event;
+    record.method = req->getMethod();
+    record.route = route;
+    record.pathLength =
+        static_cast<uint8_t>(copyTruncated(record.path, kMaxPath, req->getPath()));
+    record.messageLength =
+        static_cast<uint8_t>(copyTruncated(record.message, kMaxMessage, message));
+    record.bodyLength = static_cast<uint16_t>(copyTruncated(record.body, bodyBytes_, body));
+    slot->sequence.store(position + 1, std::memory_order_release);
+}
+
+void RequestLog::appendTimestamp(std::string& out, int64_t timeUs) {
+    // Records come in bursts within the same second, so the date is formatted once
+    const int64_t second = timeUs / 1000000;
+    if (second != formattedSecond_) {
+        const std::time_t seconds = static_cast<std::time_t>(second);
+        std::tm utc;
+        gmtime_r(&seconds, &utc);
+        formattedLength_ =
+            std::strftime(formatted_, sizeof(formatted_), "%Y-%m-%dT%H:%M:%S.", &utc);
+        formattedSecond_ = second;
+    }
+    out.append(formatted_, formattedLength_);
+    char micros[8];
+    std::snprintf(micros, sizeof(micros), "%06d", static_cast<int>(timeUs % 1000000));
+    out.append(micros, 6);
+    out += 'Z';
+}
+
+void RequestLog::appendLine(std::string& out, const Record& record) {
+    appendJsonRaw(out, "{\"time\":\"");
+    appendTimestamp(out, record.timeUs);
+    appendJsonRaw(out, "\",\"level\":\"");
+    out += kLevelNames[static_cast<size_t>(record.level)];
+    appendJsonRaw(out, "\",\"event\":\"");
+    out += kEventNames[static_cast<size_t>(record.event)];
+    appendJsonRaw(out, "\",\"method\":\"");
+    out += methodName(record.method);
+    appendJsonRaw(out, "\",\"route\":\"");
+    out += kRouteNames[static_cast<size_t>(record.route)];
+    appendJsonRaw(out, "\",\"path\":");
+    appendJsonString(out, std::string_view(record.path, record.pathLength));
+    if (record.status != 0) {
+        appendJsonRaw(out, ",\"status\":");
+        appendJsonInt(out, record.status);
+    }
+    appendJsonRaw(out, ",\"body_bytes\":");
+    appendJsonInt(out, record.bodySize);
+    if (record.messageLength != 0) {
+        appendJsonRaw(out, ",\"message\":");
+        appendJsonString(out, std::string_view(record.message, record.messageLength));
+    }
+    if (record.bodyLength != 0) {
+        appendJsonRaw(out, ",\"body\":");
+        appendJsonString(out, std::string_view(record.body, record.bodyLength));
+    }
+    appendJsonRaw(out, "}\n");
+}
+
+void RequestLog::flush() {
+    std::lock_guard<std::mutex> lock(flushMutex_);
+    if (!file_) {
+        return;
+    }
+    lines_.clear();
+    uint64_t count = 0;
+    for (;;) {
+        Slot& slot = slots_[tail_ & mask_];
+        if (slot.sequence.load(std::memory_order_acquire) != tail_ + 1) {
+            break;  // empty, or the next record is still being filled
+        }
+        appendLine(lines_, slot.record);
+        // Hand the slot back for the producers' next lap
+        slot.sequence.store(tail_ + mask_ + 1, std::memory_order_release);
+        ++tail_;
+        ++count;
+    }
+    if (count == 0) {
+        return;
+    }
+    std::fwrite(lines_.data(), 1, lines_.size(), file_);
+    std::fflush(file_);
+    written_.fetch_add(count, std::memory_order_relaxed);
+}
+
+Json::Value RequestLog::stats() const {
+    Json::Value stats;
+    stats["capacity"] = static_cast<Json::UInt64>(mask_ + 1);
+    stats["level"] = REQUEST_LOG_LEVEL;
+    stats["written"] = static_cast<Json::UInt64>(written_.load(std::memory_order_relaxed));
+    stats["sampled_out"] =
+        static_cast<Json::UInt64>(sampledOut_.load(std::memory_order_relaxed));
+    stats["dropped"] = static_cast<Json::UInt64>(dropped_.load(std::memory_order_relaxed));
+    return stats;
+}
@@ -0,0 +1,159 @@
+/**
+ *
+ *  RequestLog.h
+ *
+ */
+
+#pragma once
+
+#include <drogon/HttpRequest.h>
+#include <drogon/plugins/Plugin.h>
+#include <trantor/net/EventLoopThread.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include "utils/routeclassifier.h"
+
+/// Records above this level are compiled out: 0 none, 1 warn, 2 info, 3 debug
+#ifndef REQUEST_LOG_LEVEL
+#define REQUEST_LOG_LEVEL 2
+#endif
+
+enum class RequestLogLevel : uint8_t { Warn = 1, Info = 2, Debug = 3 };
+
+/// What happened to the request at the stage that wrote the record
+enum class RequestLogEvent : uint8_t {
+    Passed,    // validated and handed on
+    Rejected,  // answered with an error by the validation
+    Skipped,   // nothing to validate
+};
+
+/**
+ * @brief Structured request log written off the request path
+ *
+ * write() fills a fixed-size record in a lock-free ring buffer and returns; it never
+ * allocates, formats or touches the file. A background thread drains the ring every
+ * flush_interval_ms and appends one JSON line per record to log_path. When the ring
+ * is full the record is dropped and counted, so a slow disk never stalls a request.
+ *
+ * Use the REQUEST_LOG() macro: levels above REQUEST_LOG_LEVEL are removed at compile
+ * time, arguments included. Info and Debug records are sampled per route (one in
+ * sample_every[route]); Warn records are always kept. Bodies are not logged unless
+ * body_bytes is set, and then only their first body_bytes bytes.
+ *
+ * config.json:
+ * @code
+   {
+      "name": "RequestLog",
+      "config": {
+         "log_path": "requests.log",
+         "capacity": 8192,         // records in the ring, rounded up to a power of two
+         "flush_interval_ms": 100,
+         "sample_every": { "default": 1, "item": 10 },  // route names as in the log lines
+         "body_bytes": 0           // up to 256; 0 = no bodies
+      }
+   }
+   @endcode
+ */
+class RequestLog : public drogon::Plugin<RequestLog> {
+  public:
+    /// Longest path and message kept in a record
+    static constexpr size_t kMaxPath = 96;
+    static constexpr size_t kMaxMessage = 128;
+    /// Most body bytes a record can hold
+    static constexpr size_t kMaxBody = 256;
+
+    RequestLog() = default;
+    void initAndStart(const Json::Value& config) override;
+    void shutdown() override;
+
+    /// The plugin, or nullptr when config.json does not load it
+    static RequestLog* instance();
+
+    /**
+     * @brief Queue one record for @p req
+     *
+     * @param status The response status sent, 0 if the request was handed on
+     * @param message Reason for a rejection; truncated to kMaxMessage bytes
+     */
+    void write(RequestLogLevel level, RequestLogEvent event, const drogon::HttpRequestPtr& req,
+               RouteKind route, uint16_t status, std::string_view message = {});
+
+    /// Write out every queued record now
+    void flush();
+
+    Json::Value stats() const;
+
+  private:
+    struct Record {
+        int64_t timeUs;
+        uint32_t bodySize;
+        uint16_t status;
+        RequestLogLevel level;
+        RequestLogEvent event;
+        drogon::HttpMethod method;
+        RouteKind route;
+        uint8_t pathLength;
+        uint8_t messageLength;
+        uint16_t bodyLength;
+        char path[kMaxPath];
+        char message[kMaxMessage];
+        char body[kMaxBody];
+    };
+    /// One ring slot; sequence tells producers and the consumer whose turn it is
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};
+        Record record;
+    };
+    static constexpr size_t kRouteKinds = static_cast<size_t>(RouteKind::ReservationCommit) + 1;
+
+    bool sampled(RouteKind route);
+    void appendTimestamp(std::string& out, int64_t timeUs);
+    void appendLine(std::string& out, const Record& record);
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_{0};
+    alignas(64) std::atomic<uint64_t> head_{0};
+    alignas(64) uint64_t tail_{0};
+
+    std::array<uint32_t, kRouteKinds> sampleEvery_{};
+    std::array<std::atomic<uint32_t>, kRouteKinds> routeCounts_{};
+    size_t bodyBytes_{0};
+
+    std::atomic<bool> enabled_{false};
+    std::mutex flushMutex_;
+    std::FILE* file_{nullptr};
+    std::string lines_;
+    int64_t formattedSecond_{-1};
+    char formatted_[32];
+    size_t formattedLength_{0};
+    std::unique_ptr<trantor::EventLoopThread> loopThread_;
+
+    std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> sampledOut_{0};
+    std::atomic<uint64_t> dropped_{0};
+};
+
+#if REQUEST_LOG_LEVEL > 0
+/**
+ * REQUEST_LOG(Info, RequestLogEvent::Passed, req, route, 0) queues a record when the
+ * RequestLog plugin is loaded. Nothing is evaluated for a level that is compiled out.
+ */
+#define REQUEST_LOG(level, ...)                                                              \
+    do {                                                                                     \
+        if constexpr (static_cast<int>(RequestLogLevel::level) <= REQUEST_LOG_LEVEL) {       \
+            if (RequestLog* requestLog = RequestLog::instance()) {                           \
+                requestLog->write(RequestLogLevel::level, __VA_ARGS__);                      \
+            }                                                                                \
+        }                                                                                    \
+    } while (0)
+#else
+#define REQUEST_LOG(level, ...) \
+    do {                        \
+    } while (0)
+#endif
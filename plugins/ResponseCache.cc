@@ -0,0 +1,355 @@
+/**
+ *
+ *  ResponseCache.cc
+ *
+ */
+
+#include "ResponseCache.h"
+#include <drogon/HttpAppFramework.h>
+#include <drogon/utils/Utilities.h>
+#include <trantor/utils/Date.h>
+#include <trantor/utils/Logger.h>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <string_view>
+#ifdef HAS_BROTLI_ENCODER
+#include <brotli/encode.h>
+#endif
+
+namespace {
+enum class Encoding { Identity, Gzip, Brotli };
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (std::tolower(static_cast<unsigned char>(a[i])) !=
+            std::tolower(static_cast<unsigned char>(b[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// False only for an explicit zero weight (q=0, q=0.0, ...) in the parameters of an item
+bool weightAccepts(std::string_view params) {
+    size_t q = 0;
+    while (q + 1 < params.size() &&
+           !((params[q] == 'q' || params[q] == 'Q') && params[q + 1] == '=')) {
+        ++q;
+    }
+    if (q + 1 >= params.size()) {
+        return true;
+    }
+    for (char c : params.substr(q + 2)) {
+        if (c >= '1' && c <= '9') {
+            return true;
+        }
+        if (c != '0' && c != '.') {
+            break;
+        }
+    }
+    return false;
+}
+
+/// Append @p text with the bytes that delimit a cache key percent-encoded
+void appendKeyPart(std::string& key, std::string_view text) {
+    for (char c : text) {
+        if (c == '%' || c == '&' || c == '=' || c == '?') {
+            char escaped[4];
+            std::snprintf(escaped, sizeof(escaped), "%%%02X", static_cast<unsigned char>(c));
+            key.append(escaped, 3);
+        } else {
+            key += c;
+        }
+    }
+}
+
+uint64_t elapsedMicros(std::chrono::steady_clock::time_point start) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                                     std::chrono::steady_clock::now() - start)
+                                     .count());
+}
+
+std::string brotliCompress(const std::string& body, int quality) {
+#ifdef HAS_BROTLI_ENCODER
+    std::string out(BrotliEncoderMaxCompressedSize(body.size()), '\0');
+    size_t size = out.size();
+    if (out.empty() ||
+        !BrotliEncoderCompress(quality, BROTLI_DEFAULT_WINDOW, BROTLI_MODE_TEXT, body.size(),
+                               reinterpret_cast<const uint8_t*>(body.data()), &size,
+                               reinterpret_cast<uint8_t*>(out.data()))) {
+        return {};
+    }
+    out.resize(size);
+    return out;
+#else
+    (void)quality;
+    return drogon::utils::brotliCompress(body.data(), body.size());
+#endif
+}
+}  // namespace
+
+void ResponseCache::initAndStart(const Json::Value& config) {
+    const auto capacity = config.get("capacity", 1024).asUInt64();
+    const auto shards = config.get("shards", 8).asUInt64();
+    compressMinBytes_ = config.get("compress_min_bytes", 1024).asUInt64();
+    gzip_ = config.get("gzip", true).asBool();
+#ifdef HAS_BROTLI_ENCODER
+    brotli_ = config.get("brotli", true).asBool();
+#else
+    // drogon's brotliCompress() is only usable when drogon itself serves brotli
+    brotli_ = config.get("brotli", true).asBool() && drogon::app().isBrotliEnabled();
+#endif
+    brotliQuality_ = std::clamp(config.get("brotli_quality", 4).asInt(), 0, 11);
+    cache_ = std::make_unique<ShardedLruCache<std::string, EntryPtr>>(
+        capacity, std::chrono::milliseconds(0), shards);
+
+    // Versions restart at 1 on every boot; the epoch keeps old ETags from matching
+    char buf[24];
+    std::snprintf(buf, sizeof(buf), "%llx",
+                  static_cast<unsigned long long>(trantor::Date::now().microSecondsSinceEpoch()));
+    epoch_ = buf;
+    LOG_INFO << "ResponseCache enabled: capacity=" << capacity << " shards=" << shards
+             << " gzip=" << gzip_ << " brotli=" << brotli_ << " (quality " << brotliQuality_
+             << ")";
+}
+
+void ResponseCache::shutdown() {
+    cache_->clear();
+}
+
+std::string ResponseCache::cacheKey(const drogon::HttpRequestPtr& req) {
+    const auto& params = req->getParameters();
+    std::vector<std::pair<std::string, std::string>> sorted(params.begin(), params.end());
+    std::sort(sorted.begin(), sorted.end());
+
+    std::string key;
+    appendKeyPart(key, req->getPath());
+    char sep = '?';
+    for (const auto& [name, value] : sorted) {
+        key += sep;
+        appendKeyPart(key, name);
+        key += '=';
+        appendKeyPart(key, value);
+        sep = '&';
+    }
+    return key;
+}
+
+std::string ResponseCache::makeEtag(uint64_t version, const std::string& key) const {
+    // FNV-1a keeps the tag short while still differing per query
+    uint64_t hash = 1469598103934665603ULL;
+    for (unsigned char c : key) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    char buf[80];
+    std::snprintf(buf, sizeof(buf), "\"%s-%llx-%016llx\"", epoch_.c_str(),
+                  static_cast<unsigned long long>(version), static_cast<unsigned long long>(hash));
+    return buf;
+}
+
+bool ResponseCache::acceptsCoding(std::string_view header, std::string_view coding) {
+    // An item naming the coding decides; otherwise "*" stands for every unlisted coding
+    int wildcard = -1;
+    size_t pos = 0;
+    while (pos < header.size()) {
+        size_t end = header.find(',', pos);
+        if (end == std::string_view::npos) {
+            end = header.size();
+        }
+        std::string_view item = header.substr(pos, end - pos);
+        pos = end + 1;
+
+        const size_t semi = item.find(';');
+        std::string_view name = item.substr(0, semi);
+        while (!name.empty() && (name.front() == ' ' || name.front() == '\t')) {
+            name.remove_prefix(1);
+        }
+        while (!name.empty() && (name.back() == ' ' || name.back() == '\t')) {
+            name.remove_suffix(1);
+        }
+        const std::string_view params =
+            semi == std::string_view::npos ? std::string_view() : item.substr(semi + 1);
+        if (equalsIgnoreCase(name, coding)) {
+            return weightAccepts(params);
+        }
+        if (name == "*") {
+            wildcard = weightAccepts(params) ? 1 : 0;
+        }
+    }
+    return wildcard == 1;
+}
+
+bool ResponseCache::etagMatches(const std::string& ifNoneMatch, const std::string& etag,
+                                bool exists) {
+    if (ifNoneMatch.empty()) {
+        return false;
+    }
+    size_t pos = 0;
+    while (pos < ifNoneMatch.size()) {
+        size_t end = ifNoneMatch.find(',', pos);
+        if (end == std::string::npos) {
+            end = ifNoneMatch.size();
+        }
+        size_t b = ifNoneMatch.find_first_not_of(" \t", pos);
+        size_t e = ifNoneMatch.find_last_not_of(" \t", end - 1);
+        if (b != std::string::npos && b < end && e >= b) {
+            std::string_view candidate(ifNoneMatch.data() + b, e - b + 1);
+            // If-None-Match uses the weak comparison, so W/ is ignored
+            if (candidate.substr(0, 2) == "W/") {
+                candidate.remove_prefix(2);
+            }
+            if ((exists && candidate == "*") || candidate == etag) {
+                return true;
+            }
+        }
+        pos = end + 1;
+    }
+    return false;
+}
+
+bool ResponseCache::find(const std::string& key, uint64_t version, EntryPtr& entry) {
+    if (!cache_->find(key, entry)) {
+        return false;
+    }
+    if (entry->version != version) {
+        staleVersions_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+const std::string& ResponseCache::gzipBody(const Entry& entry) {
+    bool made = false;
+    std::call_once(entry.gzip.once, [&]() {
+        const auto start = std::chrono::steady_clock::now();
+        entry.gzip.body = drogon::utils::gzipCompress(entry.body.data(), entry.body.size());
+        entry.gzip.micros = elapsedMicros(start);
+        made = true;
+        compressMicros_.fetch_add(entry.gzip.micros, std::memory_order_relaxed);
+        compressedEntries_.fetch_add(1, std::memory_order_relaxed);
+        gzipInputBytes_.fetch_add(entry.body.size(), std::memory_order_relaxed);
+        gzipBytes_.fetch_add(entry.gzip.body.size(), std::memory_order_relaxed);
+    });
+    if (!made) {
+        savedMicros_.fetch_add(entry.gzip.micros, std::memory_order_relaxed);
+    }
+    return entry.gzip.body;
+}
+
+const std::string& ResponseCache::brotliBody(const Entry& entry) {
+    bool made = false;
+    std::call_once(entry.brotli.once, [&]() {
+        const auto start = std::chrono::steady_clock::now();
+        entry.brotli.body = brotliCompress(entry.body, brotliQuality_);
+        entry.brotli.micros = elapsedMicros(start);
+        made = true;
+        compressMicros_.fetch_add(entry.brotli.micros, std::memory_order_relaxed);
+        compressedEntries_.fetch_add(1, std::memory_order_relaxed);
+        brotliInputBytes_.fetch_add(entry.body.size(), std::memory_order_relaxed);
+        brotliBytes_.fetch_add(entry.brotli.body.size(), std::memory_order_relaxed);
+    });
+    if (!made) {
+        savedMicros_.fetch_add(entry.brotli.micros, std::memory_order_relaxed);
+    }
+    return entry.brotli.body;
+}
+
+drogon::HttpResponsePtr ResponseCache::newNotModifiedResponse(const std::string& etag) {
+    notModified_.fetch_add(1, std::memory_order_relaxed);
+    auto resp = drogon::HttpResponse::newHttpResponse();
+    resp->setStatusCode(drogon::k304NotModified);
+    resp->addHeader("ETag", etag);
+    return resp;
+}
+
+drogon::HttpResponsePtr ResponseCache::newResponse(const Entry& entry,
+                                                   const drogon::HttpRequestPtr& req) {
+    Encoding encoding = Encoding::Identity;
+    const std::string* body = &entry.body;
+    const bool compressible = (gzip_ || brotli_) && entry.body.size() >= compressMinBytes_;
+    if (compressible) {
+        // Only the encoding this client prefers is produced, and only once per entry
+        const std::string& acceptEncoding = req->getHeader("accept-encoding");
+        if (brotli_ && acceptsCoding(acceptEncoding, "br") && !brotliBody(entry).empty()) {
+            encoding = Encoding::Brotli;
+            body = &entry.brotli.body;
+        } else if (gzip_ && acceptsCoding(acceptEncoding, "gzip") &&
+                   !gzipBody(entry).empty()) {
+            encoding = Encoding::Gzip;
+            body = &entry.gzip.body;
+        }
+    }
+
+    auto resp = drogon::HttpResponse::newHttpResponse();
+    resp->setStatusCode(drogon::k200OK);
+    resp->setContentTypeCode(drogon::CT_APPLICATION_JSON);
+    resp->setBody(*body);
+    switch (encoding) {
+        case Encoding::Brotli:
+            resp->addHeader("Content-Encoding", "br");
+            brotliServed_.fetch_add(1, std::memory_order_relaxed);
+            break;
+        case Encoding::Gzip:
+            resp->addHeader("Content-Encoding", "gzip");
+            gzipServed_.fetch_add(1, std::memory_order_relaxed);
+            break;
+        case Encoding::Identity:
+            break;
+    }
+    if (compressible) {
+        resp->addHeader("Vary", "Accept-Encoding");
+    }
+    resp->addHeader("ETag", entry.etag);
+    resp->addHeader("Cache-Control", "no-cache");
+    for (const auto& [name, value] : entry.headers) {
+        resp->addHeader(name, value);
+    }
+    return resp;
+}
+
+Json::Value ResponseCache::stats() const {
+    const auto s = cache_->stats();
+    Json::Value ret;
+    ret["products_version"] = static_cast<Json::UInt64>(productsVersion());
+    // An LRU hit on an entry from an older version is served as a miss
+    const uint64_t stale = staleVersions_.load(std::memory_order_relaxed);
+    ret["hits"] = static_cast<Json::UInt64>(s.hits > stale ? s.hits - stale : 0);
+    ret["misses"] = static_cast<Json::UInt64>(s.misses + stale);
+    ret["stale_versions"] = static_cast<Json::UInt64>(stale);
+    ret["not_modified"] = static_cast<Json::UInt64>(notModified_.load(std::memory_order_relaxed));
+    ret["evictions"] = static_cast<Json::UInt64>(s.evictions);
+    ret["size"] = static_cast<Json::UInt64>(s.size);
+    ret["capacity"] = static_cast<Json::UInt64>(s.capacity);
+
+    Json::Value& compression = ret["compression"];
+    const uint64_t gzipRaw = gzipInputBytes_.load(std::memory_order_relaxed);
+    const uint64_t brotliRaw = brotliInputBytes_.load(std::memory_order_relaxed);
+    const uint64_t gz = gzipBytes_.load(std::memory_order_relaxed);
+    const uint64_t br = brotliBytes_.load(std::memory_order_relaxed);
+    // Variants made, each counted with the size of the body it compressed
+    compression["compressed_entries"] =
+        static_cast<Json::UInt64>(compressedEntries_.load(std::memory_order_relaxed));
+    compression["uncompressed_bytes"] = static_cast<Json::UInt64>(gzipRaw + brotliRaw);
+    compression["gzip_bytes"] = static_cast<Json::UInt64>(gz);
+    compression["brotli_bytes"] = static_cast<Json::UInt64>(br);
+    // Compressed size over original size, for bodies that were compressed
+    compression["gzip_ratio"] =
+        gzipRaw == 0 || gz == 0 ? 0.0 : static_cast<double>(gz) / gzipRaw;
+    compression["brotli_ratio"] =
+        brotliRaw == 0 || br == 0 ? 0.0 : static_cast<double>(br) / brotliRaw;
+    compression["gzip_served"] =
+        static_cast<Json::UInt64>(gzipServed_.load(std::memory_order_relaxed));
+    compression["brotli_served"] =
+        static_cast<Json::UInt64>(brotliServed_.load(std::memory_order_relaxed));
+    compression["cpu_spent_ms"] =
+        static_cast<double>(compressMicros_.load(std::memory_order_relaxed)) / 1000.0;
+    compression["cpu_saved_ms"] =
+        static_cast<double>(savedMicros_.load(std::memory_order_relaxed)) / 1000.0;
+    return ret;
+}
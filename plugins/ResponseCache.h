@@ -0,0 +1,146 @@
+/**
+ *
+ *  ResponseCache.h
+ *
+ */
+
+#pragma once
+
+#include <drogon/HttpRequest.h>
+#include <drogon/HttpResponse.h>
+#include <drogon/plugins/Plugin.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "utils/shardedlrucache.h"
+
+/**
+ * @brief Version-stamped cache of serialized product read responses
+ *
+ * Every product write bumps the products table version. Cached bodies are tagged
+ * with the version they were produced under and are only served while it is still
+ * current, so no explicit invalidation is needed. Each response carries a strong
+ * ETag derived from the version, which lets pollers revalidate with If-None-Match
+ * and get a 304 without touching SQLite or the serializer.
+ *
+ * Bodies above compress_min_bytes are compressed once per encoding, by the first
+ * response that accepts it, and the variant is kept next to the body. Later hits are
+ * served in the client's preferred Accept-Encoding without recompressing on the IO
+ * thread (drogon leaves responses that already carry Content-Encoding alone), and an
+ * encoding no client asks for costs nothing. Brotli uses a low quality by default:
+ * quality 11, drogon's default, takes far longer than serving the body it saves.
+ *
+ * config.json:
+ * @code
+   {
+      "name": "ResponseCache",
+      "config": {
+         "capacity": 1024,          // cached bodies (one per distinct path + query)
+         "shards": 8,
+         "compress_min_bytes": 1024, // smaller bodies are only kept uncompressed
+         "gzip": true,
+         "brotli": true,            // without libbrotlienc, also needs "use_brotli" in app
+         "brotli_quality": 4        // 0-11
+      }
+   }
+   @endcode
+ */
+class ResponseCache : public drogon::Plugin<ResponseCache> {
+  public:
+    /// A compressed copy of an entry's body, made by the first response that needs it
+    struct Variant {
+        std::once_flag once;
+        std::string body;
+        /// CPU time spent producing it, saved again on every later hit that serves it
+        uint64_t micros{0};
+    };
+    struct Entry {
+        uint64_t version{0};
+        std::string etag;
+        std::string body;
+        /// Extra headers that belong to the body, e.g. X-Next-Cursor
+        std::vector<std::pair<std::string, std::string>> headers;
+        /// Only bodies of at least compress_min_bytes get variants
+        mutable Variant gzip;
+        mutable Variant brotli;
+    };
+    using EntryPtr = std::shared_ptr<const Entry>;
+
+    ResponseCache() = default;
+    void initAndStart(const Json::Value& config) override;
+    void shutdown() override;
+
+    uint64_t productsVersion() const {
+        return productsVersion_.load(std::memory_order_acquire);
+    }
+    /// Call after a product write has committed
+    void bumpProductsVersion() {
+        productsVersion_.fetch_add(1, std::memory_order_acq_rel);
+    }
+
+    /**
+     * @brief Path plus query parameters in a canonical (sorted) order
+     *
+     * Parameters arrive decoded, so '%', '&', '=' and '?' inside a name or value are
+     * percent-encoded again; "a%26b" and "a&b" never share a key.
+     */
+    static std::string cacheKey(const drogon::HttpRequestPtr& req);
+    /// Strong ETag for @p key under @p version, unique across server restarts
+    std::string makeEtag(uint64_t version, const std::string& key) const;
+    /**
+     * @brief True if an Accept-Encoding header value accepts @p coding
+     *
+     * Coding names compare case-insensitively. An item for @p coding decides, else a
+     * "*" item does; only an explicit zero weight (q=0, q=0.000) refuses.
+     */
+    static bool acceptsCoding(std::string_view header, std::string_view coding);
+    /**
+     * @brief True if an If-None-Match header value lists @p etag
+     *
+     * "*" matches any current representation, so it only counts when @p exists says the
+     * resource has one; before the query has run a missing id must still get its 404.
+     */
+    static bool etagMatches(const std::string& ifNoneMatch, const std::string& etag,
+                            bool exists);
+
+    /// Look up a body produced under @p version
+    bool find(const std::string& key, uint64_t version, EntryPtr& entry);
+    void store(const std::string& key, EntryPtr entry) {
+        cache_->insert(key, std::move(entry));
+    }
+
+    drogon::HttpResponsePtr newNotModifiedResponse(const std::string& etag);
+    /// Response for @p entry in the best encoding @p req accepts, compressing it if needed
+    drogon::HttpResponsePtr newResponse(const Entry& entry, const drogon::HttpRequestPtr& req);
+
+    Json::Value stats() const;
+
+  private:
+    /// The gzip or brotli body of @p entry, compressed on first use; empty if that failed
+    const std::string& gzipBody(const Entry& entry);
+    const std::string& brotliBody(const Entry& entry);
+
+    std::unique_ptr<ShardedLruCache<std::string, EntryPtr>> cache_;
+    std::atomic<uint64_t> productsVersion_{1};
+    std::string epoch_;
+    std::atomic<uint64_t> notModified_{0};
+    std::atomic<uint64_t> staleVersions_{0};
+
+    size_t compressMinBytes_{1024};
+    bool gzip_{true};
+    bool brotli_{true};
+    int brotliQuality_{4};
+    std::atomic<uint64_t> compressedEntries_{0};
+    std::atomic<uint64_t> gzipInputBytes_{0};
+    std::atomic<uint64_t> brotliInputBytes_{0};
+    std::atomic<uint64_t> gzipBytes_{0};
+    std::atomic<uint64_t> brotliBytes_{0};
+    std::atomic<uint64_t> compressMicros_{0};
+    std::atomic<uint64_t> gzipServed_{0};
+    std::atomic<uint64_t> brotliServed_{0};
+    std::atomic<uint64_t> savedMicros_{0};
+};
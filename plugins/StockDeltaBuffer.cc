@@ -0,0 +1,420 @@
+/**
+ *
+ *  StockDeltaBuffer.cc
+ *
+ */
+
+#include "StockDeltaBuffer.h"
+#include <drogon/HttpAppFramework.h>
+#include <drogon/orm/Exception.h>
+#include <trantor/utils/Logger.h>
+#include <algorithm>
+#include <cstdio>
+#include <future>
+#include <utility>
+
+namespace {
+struct JournalRecord {
+    uint64_t sequence;
+    int64_t productId;
+    int64_t delta;
+};
+static_assert(sizeof(JournalRecord) == 24, "journal records are fixed-size");
+
+/**
+ * Apply one product's summed delta. Every delta in it was checked against the stock
+ * when it was accepted, so the guard only trips if that check was wrong. Binds: delta,
+ * product_id, delta.
+ */
+constexpr const char* kFlushDeltaSql =
+    "update products set quantity_in_stock = quantity_in_stock + ?, "
+    "updated_at = CURRENT_TIMESTAMP, version = version + 1 "
+    "where product_id = ? and quantity_in_stock + ? >= 0 returning *";
+
+constexpr const char* kStoreFlushedSequenceSql =
+    "insert into stock_delta_journal (id, flushed_sequence) values (1, ?) "
+    "on conflict(id) do update set flushed_sequence = excluded.flushed_sequence";
+
+/// Append the whole records of @p path with a sequence above @p after to @p records
+void readJournal(const std::string& path, uint64_t after, std::vector<JournalRecord>& records) {
+    std::ifstream in(path, std::ios::binary);
+    JournalRecord record;
+    // A torn record at the end (crash mid-write) is shorter than a record and ignored
+    while (in.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+        if (record.sequence > after) {
+            records.push_back(record);
+        }
+    }
+}
+}  // namespace
+
+void StockDeltaBuffer::initAndStart(const Json::Value& config) {
+    const double intervalMs = config.get("flush_interval_ms", 50).asDouble();
+    intervalSeconds_ = std::max(1.0, intervalMs) / 1000.0;
+    shards_ = std::vector<Shard>(std::max<size_t>(1, config.get("shards", 16).asUInt64()));
+    journalPath_ = config.get("journal_path", "stock_deltas.journal").asString();
+    for (const auto& id : config["product_ids"]) {
+        productIds_.insert(id.asInt64());
+    }
+
+    loopThread_ = std::make_unique<trantor::EventLoopThread>("StockDeltaBuffer");
+    loopThread_->run();
+    loop_ = loopThread_->getLoop();
+    LOG_INFO << "StockDeltaBuffer enabled: flush every " << intervalSeconds_ * 1000.0 << "ms, "
+             << productIds_.size() << " products, waiting for database initialization";
+}
+
+void StockDeltaBuffer::shutdown() {
+    if (!loopThread_) {
+        return;
+    }
+    // Write whatever is still pending before the thread stops; the journal covers it
+    // anyway if this fails
+    loop_->runInLoop([this]() { flush(); });
+    loopThread_.reset();
+    loop_ = nullptr;
+    std::lock_guard<std::mutex> lock(journalMutex_);
+    ready_ = false;
+    journal_.close();
+}
+
+void StockDeltaBuffer::load(const drogon::orm::DbClientPtr& dbClient, FlushListener listener) {
+    uint64_t flushed = 0;
+    try {
+        auto result =
+            dbClient->execSqlSync("select flushed_sequence from stock_delta_journal where id = 1");
+        if (!result.empty()) {
+            flushed = static_cast<uint64_t>(result[0]["flushed_sequence"].as<int64_t>());
+        }
+    } catch (const drogon::orm::DrogonDbException& e) {
+        LOG_ERROR << "StockDeltaBuffer load failed, adjustments stay synchronous: "
+                  << e.base().what();
+        return;
+    }
+
+    listener_ = std::move(listener);
+    if (!openJournal(journalPath_, flushed)) {
+        LOG_ERROR << "StockDeltaBuffer cannot write " << journalPath_
+                  << ", adjustments stay synchronous";
+        return;
+    }
+    loop_->runEvery(intervalSeconds_, [this]() { flush(); });
+}
+
+bool StockDeltaBuffer::openJournal(const std::string& path, uint64_t flushedSequence) {
+    std::lock_guard<std::mutex> lock(journalMutex_);
+    journalPath_ = path;
+    flushedSequence_ = flushedSequence;
+    sequence_ = flushedSequence;
+
+    // Records of a flush that never committed come first, then the active journal
+    const std::string flushingPath = journalPath_ + ".flushing";
+    std::vector<JournalRecord> journal;
+    readJournal(flushingPath, flushedSequence, journal);
+    readJournal(journalPath_, flushedSequence, journal);
+    std::vector<JournalRecord> records;
+    for (const auto& record : journal) {
+        // Sequences only grow, so a repeat means a crash interrupted the rewrite below
+        if (record.sequence <= sequence_) {
+            continue;
+        }
+        auto& shard = shardOf(record.productId);
+        std::unique_lock<std::shared_mutex> shardLock(shard.mutex);
+        shard.counters[record.productId].pending += record.delta;
+        sequence_ = record.sequence;
+        records.push_back(record);
+    }
+
+    // Rewrite what is still owed as the file being flushed, which also drops any torn
+    // tail, and start an empty active journal
+    std::ofstream out(flushingPath, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(records.data()),
+              static_cast<std::streamsize>(records.size() * sizeof(JournalRecord)));
+    out.close();
+    flushingFileExists_ = !records.empty();
+    if (!flushingFileExists_) {
+        std::remove(flushingPath.c_str());
+    }
+    journal_.open(journalPath_, std::ios::binary | std::ios::trunc);
+    activeRecords_ = 0;
+    if (!out || !journal_.is_open()) {
+        return false;
+    }
+    ready_ = true;
+    LOG_INFO << "StockDeltaBuffer replayed " << records.size()
+             << " journal records past sequence " << flushedSequence;
+    return true;
+}
+
+bool StockDeltaBuffer::covers(int64_t productId) const {
+    return ready_.load(std::memory_order_acquire) && productIds_.count(productId) > 0;
+}
+
+std::vector<int64_t> StockDeltaBuffer::coveredProducts() const {
+    if (!ready_.load(std::memory_order_acquire)) {
+        return {};
+    }
+    return std::vector<int64_t>(productIds_.begin(), productIds_.end());
+}
+
+StockDeltaBuffer::Status StockDeltaBuffer::add(int64_t productId,
+                                               int64_t delta,
+                                               int64_t& quantity) {
+    std::lock_guard<std::mutex> lock(journalMutex_);
+    if (!ready_.load(std::memory_order_relaxed) || !journal_.is_open()) {
+        return Status::NotReady;
+    }
+    auto& shard = shardOf(productId);
+    std::shared_lock<std::shared_mutex> shardLock(shard.mutex);
+    auto it = shard.counters.find(productId);
+    if (it == shard.counters.end() || !it->second.known.load(std::memory_order_acquire)) {
+        return Status::UnknownProduct;
+    }
+    Counter& counter = it->second;
+    // Adds and direct writes are serialized by journalMutex_, so nothing else lowers
+    // pending or inFlight meanwhile; a flush only lowers pending after raising
+    // committed by the same amount
+    const int64_t current = counter.committed.load() + counter.pending.load();
+    const int64_t available = current + counter.inFlight.load();
+    if (available + delta < 0) {
+        quantity = available;
+        refused_.fetch_add(1, std::memory_order_relaxed);
+        return Status::InsufficientStock;
+    }
+    if (!appendJournalLocked(productId, delta)) {
+        return Status::NotReady;
+    }
+    counter.pending.fetch_add(delta);
+    quantity = current + delta;
+    adds_.fetch_add(1, std::memory_order_relaxed);
+    return Status::Ok;
+}
+
+void StockDeltaBuffer::beginDirectWrite(int64_t productId, int64_t delta) {
+    if (delta >= 0) {
+        return;
+    }
+    // Under the journal lock, so an add() either comes before and is in the pending the
+    // caller binds, or comes after and sees this decrement
+    std::lock_guard<std::mutex> lock(journalMutex_);
+    auto& shard = shardOf(productId);
+    std::unique_lock<std::shared_mutex> shardLock(shard.mutex);
+    shard.counters[productId].inFlight.fetch_add(delta);
+}
+
+void StockDeltaBuffer::endDirectWrite(int64_t productId, int64_t delta) {
+    if (delta >= 0) {
+        return;
+    }
+    auto& shard = shardOf(productId);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.counters.find(productId);
+    if (it != shard.counters.end()) {
+        it->second.inFlight.fetch_sub(delta);
+    }
+}
+
+void StockDeltaBuffer::prime(int64_t productId, int64_t committed) {
+    auto& shard = shardOf(productId);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    Counter& counter = shard.counters[productId];
+    if (!counter.known.load()) {
+        counter.committed.store(committed);
+        counter.known.store(true, std::memory_order_release);
+    }
+}
+
+void StockDeltaBuffer::updateCommitted(int64_t productId, int64_t committed, int64_t version) {
+    // Only products that have been adjusted here are tracked
+    auto& shard = shardOf(productId);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.counters.find(productId);
+    if (it == shard.counters.end() || version < it->second.version) {
+        return;
+    }
+    it->second.version = version;
+    it->second.committed.store(committed);
+    it->second.known.store(true, std::memory_order_release);
+}
+
+void StockDeltaBuffer::remove(int64_t productId) {
+    auto& shard = shardOf(productId);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    // Journal records of a deleted product replay into an UPDATE that matches nothing
+    shard.counters.erase(productId);
+}
+
+int64_t StockDeltaBuffer::pending(int64_t productId) const {
+    auto& shard = shardOf(productId);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.counters.find(productId);
+    return it == shard.counters.end() ? 0 : it->second.pending.load(std::memory_order_relaxed);
+}
+
+bool StockDeltaBuffer::appendJournalLocked(int64_t productId, int64_t delta) {
+    const JournalRecord record{sequence_ + 1, productId, delta};
+    // flush() hands the record to the kernel before the adjustment is acknowledged: it
+    // survives a crash of the process, not of the machine
+    journal_.write(reinterpret_cast<const char*>(&record), sizeof(record));
+    journal_.flush();
+    if (!journal_) {
+        LOG_ERROR << "StockDeltaBuffer cannot append to " << journalPath_;
+        journal_.close();
+        return false;
+    }
+    ++sequence_;
+    ++activeRecords_;
+    return true;
+}
+
+void StockDeltaBuffer::rotateJournalLocked() {
+    if (activeRecords_ == 0) {
+        return;
+    }
+    const std::string flushingPath = journalPath_ + ".flushing";
+    journal_.close();
+    if (!flushingFileExists_) {
+        std::rename(journalPath_.c_str(), flushingPath.c_str());
+    } else {
+        // The previous flush failed: its records are still owed, so keep them together
+        std::ifstream in(journalPath_, std::ios::binary);
+        std::ofstream out(flushingPath, std::ios::binary | std::ios::app);
+        out << in.rdbuf();
+        out.close();
+        in.close();
+        std::remove(journalPath_.c_str());
+    }
+    flushingFileExists_ = true;
+    journal_.open(journalPath_, std::ios::binary | std::ios::trunc);
+    activeRecords_ = 0;
+}
+
+bool StockDeltaBuffer::beginFlush(FlushBatch& batch) {
+    std::lock_guard<std::mutex> lock(journalMutex_);
+    if (!ready_.load(std::memory_order_relaxed) || sequence_ == flushedSequence_) {
+        return false;
+    }
+    // The counters match the journal exactly up to sequence_, since adds hold this lock
+    batch.cut = sequence_;
+    batch.deltas.clear();
+    for (auto& shard : shards_) {
+        std::shared_lock<std::shared_mutex> shardLock(shard.mutex);
+        for (const auto& [productId, counter] : shard.counters) {
+            const int64_t pending = counter.pending.load();
+            if (pending != 0) {
+                batch.deltas.emplace_back(productId, pending);
+            }
+        }
+    }
+    rotateJournalLocked();
+    return true;
+}
+
+void StockDeltaBuffer::finishFlush(const FlushBatch& batch, const FlushedRows& rows) {
+    // Pending is lowered before committed is raised, so for a moment a product looks
+    // short of stock rather than over-stocked. A rejected delta is lowered as well: it
+    // was not written and retrying it would fail the same way.
+    for (const auto& [productId, delta] : batch.deltas) {
+        auto& shard = shardOf(productId);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.counters.find(productId);
+        if (it != shard.counters.end()) {
+            it->second.pending.fetch_sub(delta);
+        }
+    }
+    for (const auto& [row, version] : rows) {
+        updateCommitted(row.getValueOfProductId(), row.getValueOfQuantityInStock(), version);
+    }
+    {
+        std::lock_guard<std::mutex> lock(journalMutex_);
+        flushedSequence_ = batch.cut;
+        const std::string flushingPath = journalPath_ + ".flushing";
+        std::remove(flushingPath.c_str());
+        flushingFileExists_ = false;
+    }
+    flushes_.fetch_add(1, std::memory_order_relaxed);
+    flushedRows_.fetch_add(rows.size(), std::memory_order_relaxed);
+    if (listener_) {
+        for (const auto& [row, version] : rows) {
+            listener_(row, version);
+        }
+    }
+}
+
+void StockDeltaBuffer::flush() {
+    FlushBatch batch;
+    if (!beginFlush(batch)) {
+        return;
+    }
+
+    FlushedRows rows;
+    auto committed = std::make_shared<std::promise<bool>>();
+    auto commitResult = committed->get_future();
+    try {
+        auto transaction = drogon::app().getDbClient()->newTransaction(
+            [committed](bool ok) { committed->set_value(ok); });
+        for (const auto& [productId, delta] : batch.deltas) {
+            auto binder = *transaction << kFlushDeltaSql;
+            binder << delta << productId << delta;
+            binder << drogon::orm::Mode::Blocking;
+            binder >> [this, &rows, productId = productId, delta = delta](
+                          const drogon::orm::Result& result) {
+                if (result.empty()) {
+                    rejectedDeltas_.fetch_add(1, std::memory_order_relaxed);
+                    LOG_ERROR << "StockDeltaBuffer dropped delta " << delta << " of product "
+                              << productId << ": the product is gone or would go below zero";
+                }
+                for (const auto& row : result) {
+                    rows.emplace_back(drogon_model::sqlite3::Products(row),
+                                      row["version"].as<int64_t>());
+                }
+            };
+            binder.exec();
+        }
+        auto binder = *transaction << kStoreFlushedSequenceSql;
+        binder << static_cast<int64_t>(batch.cut);
+        binder << drogon::orm::Mode::Blocking;
+        binder.exec();
+        // Releasing the last reference commits
+    } catch (const drogon::orm::DrogonDbException& e) {
+        failedFlushes_.fetch_add(1, std::memory_order_relaxed);
+        LOG_WARN << "StockDeltaBuffer flush of " << batch.deltas.size()
+                 << " products failed, retrying next interval: " << e.base().what();
+        return;
+    }
+    if (!commitResult.get()) {
+        failedFlushes_.fetch_add(1, std::memory_order_relaxed);
+        LOG_WARN << "StockDeltaBuffer flush of " << batch.deltas.size()
+                 << " products did not commit, retrying next interval";
+        return;
+    }
+    finishFlush(batch, rows);
+}
+
+Json::Value StockDeltaBuffer::stats() const {
+    int64_t products = 0;
+    int64_t pendingUnits = 0;
+    for (const auto& shard : shards_) {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        for (const auto& [productId, counter] : shard.counters) {
+            const int64_t pending = counter.pending.load(std::memory_order_relaxed);
+            if (pending != 0) {
+                ++products;
+                pendingUnits += pending;
+            }
+        }
+    }
+    Json::Value ret;
+    ret["pending_products"] = static_cast<Json::Int64>(products);
+    ret["pending_delta"] = static_cast<Json::Int64>(pendingUnits);
+    ret["adds"] = static_cast<Json::UInt64>(adds_.load(std::memory_order_relaxed));
+    ret["refused"] = static_cast<Json::UInt64>(refused_.load(std::memory_order_relaxed));
+    ret["flushes"] = static_cast<Json::UInt64>(flushes_.load(std::memory_order_relaxed));
+    ret["flushed_rows"] = static_cast<Json::UInt64>(flushedRows_.load(std::memory_order_relaxed));
+    ret["failed_flushes"] =
+        static_cast<Json::UInt64>(failedFlushes_.load(std::memory_order_relaxed));
+    ret["rejected_deltas"] =
+        static_cast<Json::UInt64>(rejectedDeltas_.load(std::memory_order_relaxed));
+    ret["flush_interval_ms"] = intervalSeconds_ * 1000.0;
+    return ret;
+}
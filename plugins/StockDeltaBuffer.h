@@ -0,0 +1,205 @@
+/**
+ *
+ *  StockDeltaBuffer.h
+ *
+ */
+
+#pragma once
+
+#include <drogon/orm/DbClient.h>
+#include <drogon/plugins/Plugin.h>
+#include <trantor/net/EventLoopThread.h>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "models/Products.h"
+
+/**
+ * @brief Write-behind stock deltas for hot products
+ *
+ * POST /api/products/{id}/adjust normally costs one SQLite write per call. With this
+ * plugin the delta is instead added to a per-product counter in memory and written
+ * to a journal file, and the request is answered right away. A background thread
+ * writes the summed deltas of all products in one transaction every
+ * flush_interval_ms.
+ *
+ * The stock check still holds: a decrement is refused unless
+ * committed + pending + delta >= 0, counting the direct decrements still in flight.
+ * The committed quantity comes from the first read of the product and from every
+ * later write; a report older than the row version already recorded is ignored.
+ * Reads add pending() to the stored quantity_in_stock.
+ *
+ * Writes that must stay in a transaction (batches, keyed adjustments, reservation
+ * commits) still decrement the row directly. They announce themselves with
+ * beginDirectWrite() before the statement is bound and endDirectWrite() once it has
+ * finished, so add() cannot hand out the same units meanwhile. The flush keeps the
+ * stock guard: a delta that would take a product below zero is dropped, logged and
+ * counted as rejected rather than written.
+ *
+ * The journal is crash-safe. Each journal record has a sequence number. Each flush
+ * stores the highest sequence number it covers in stock_delta_journal, in the same
+ * transaction as the deltas. At startup, load() replays only the records above that
+ * number, so a delta is never lost and never applied twice.
+ *
+ * Counters live in shards, each guarded by a shared_mutex, so reads never wait for
+ * a writer. Adds are serialized by the journal.
+ *
+ * Write-behind is opt-in per product: only the products listed in product_ids are
+ * covered, so an empty list leaves every adjustment synchronous.
+ *
+ * config.json:
+ * @code
+   {
+      "name": "StockDeltaBuffer",
+      "config": {
+         "flush_interval_ms": 50,
+         "shards": 16,
+         "journal_path": "stock_deltas.journal",
+         "product_ids": [101, 102]   // products in write-behind mode
+      }
+   }
+   @endcode
+ */
+class StockDeltaBuffer : public drogon::Plugin<StockDeltaBuffer> {
+  public:
+    enum class Status { Ok, NotReady, UnknownProduct, InsufficientStock };
+    /// Gets each row a flush wrote and its version column, which the model does not map
+    using FlushListener =
+        std::function<void(const drogon_model::sqlite3::Products&, int64_t version)>;
+
+    StockDeltaBuffer() : shards_(16) {}
+    void initAndStart(const Json::Value& config) override;
+    void shutdown() override;
+
+    /**
+     * @brief Replay the journal past the last flush and start flushing
+     *
+     * Call once the database is initialized. @p listener runs on the flush thread for
+     * every row a flush writes, so caches and indexes can follow.
+     */
+    void load(const drogon::orm::DbClientPtr& dbClient, FlushListener listener);
+
+    /**
+     * @brief Replay the journal at @p path past @p flushedSequence, then keep appending
+     *
+     * load() calls this with the sequence the last flush stored.
+     * @return false if the journal cannot be written; adjustments then stay synchronous
+     */
+    bool openJournal(const std::string& path, uint64_t flushedSequence);
+
+    /// True if adjustments of @p productId should go through add()
+    bool covers(int64_t productId) const;
+
+    /// Every product covers() accepts; empty until load() has finished
+    std::vector<int64_t> coveredProducts() const;
+
+    /**
+     * @brief Add @p delta to the product's pending counter unless stock would go negative
+     *
+     * @param quantity Stock including every pending delta after the add on Ok; on
+     * InsufficientStock, what is left once the direct decrements in flight are counted
+     * @return UnknownProduct until prime() has supplied the committed quantity;
+     * NotReady if the journal cannot be written, in which case adjust directly
+     */
+    Status add(int64_t productId, int64_t delta, int64_t& quantity);
+
+    /**
+     * @brief Count a direct decrement of @p productId until endDirectWrite()
+     *
+     * Call before binding the guarded UPDATE and end it once the write has committed
+     * (after updateCommitted()) or failed. Increments need no announcement.
+     */
+    void beginDirectWrite(int64_t productId, int64_t delta);
+    void endDirectWrite(int64_t productId, int64_t delta);
+
+    /// Supply the committed quantity_in_stock read for an UnknownProduct
+    void prime(int64_t productId, int64_t committed);
+    /**
+     * @brief Record the quantity_in_stock a write committed at row @p version
+     *
+     * Ignored if a newer version has been recorded: a flush and a direct write can
+     * report their rows in either order.
+     */
+    void updateCommitted(int64_t productId, int64_t committed, int64_t version);
+    /// Forget a deleted product
+    void remove(int64_t productId);
+
+    /// Sum of the deltas not yet flushed for @p productId
+    int64_t pending(int64_t productId) const;
+
+    /// Deltas taken by one flush: the pending sum per product, up to journal record cut
+    struct FlushBatch {
+        uint64_t cut{0};
+        std::vector<std::pair<int64_t, int64_t>> deltas;  // (product_id, delta)
+    };
+    /**
+     * @brief Take every pending delta for writing and rotate the journal
+     *
+     * The flush thread writes the batch in one transaction and calls finishFlush() once
+     * it has committed; until then the journal still owes the batch.
+     * @return false if nothing is pending
+     */
+    bool beginFlush(FlushBatch& batch);
+    /// (row, version) of each product a flush wrote
+    using FlushedRows = std::vector<std::pair<drogon_model::sqlite3::Products, int64_t>>;
+    /// End a flush whose transaction committed; @p rows are the rows it wrote
+    void finishFlush(const FlushBatch& batch, const FlushedRows& rows);
+
+    Json::Value stats() const;
+
+  private:
+    struct Counter {
+        std::atomic<int64_t> pending{0};
+        /// Direct decrements between beginDirectWrite() and endDirectWrite()
+        std::atomic<int64_t> inFlight{0};
+        std::atomic<int64_t> committed{0};
+        /// Row version committed was read at; written under the shard's unique lock
+        int64_t version{0};
+        std::atomic<bool> known{false};
+    };
+    struct Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<int64_t, Counter> counters;
+    };
+
+    Shard& shardOf(int64_t productId) const {
+        return shards_[static_cast<uint64_t>(productId) % shards_.size()];
+    }
+    void flush();
+    bool appendJournalLocked(int64_t productId, int64_t delta);
+    /// Move the active journal onto the file being flushed, so new adds start afresh
+    void rotateJournalLocked();
+
+    mutable std::vector<Shard> shards_;
+    std::unordered_set<int64_t> productIds_;
+    std::atomic<bool> ready_{false};
+
+    std::mutex journalMutex_;
+    std::string journalPath_;
+    std::ofstream journal_;
+    uint64_t sequence_{0};
+    uint64_t flushedSequence_{0};
+    bool flushingFileExists_{false};
+    size_t activeRecords_{0};
+
+    FlushListener listener_;
+    std::unique_ptr<trantor::EventLoopThread> loopThread_;
+    trantor::EventLoop* loop_{nullptr};
+    double intervalSeconds_{0.05};
+
+    std::atomic<uint64_t> adds_{0};
+    std::atomic<uint64_t> refused_{0};
+    std::atomic<uint64_t> flushes_{0};
+    std::atomic<uint64_t> flushedRows_{0};
+    std::atomic<uint64_t> failedFlushes_{0};
+    std::atomic<uint64_t> rejectedDeltas_{0};
+};
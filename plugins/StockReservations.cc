@@ -0,0 +1,436 @@
+/**
+ *
+ *  StockReservations.cc
+ *
+ */
+
+#include "StockReservations.h"
+#include <drogon/HttpAppFramework.h>
+#include <drogon/orm/Exception.h>
+#include <trantor/utils/Logger.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <iterator>
+
+namespace {
+/// One log entry; Reserve carries every field, the others only the hold id
+struct LogRecord {
+    uint8_t op;
+    uint8_t unused[3];
+    int32_t quantity;
+    uint64_t holdId;
+    int64_t productId;
+    int64_t expiresAtMs;
+};
+static_assert(sizeof(LogRecord) == 32, "log records are fixed-size");
+
+/// Compact once the log holds this many records and four times more than are live
+constexpr size_t kCompactMinRecords = 1024;
+
+int64_t nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+/// Sits in the timing wheel; the wheel dropping it is the expiry
+class ExpiryEntry {
+  public:
+    explicit ExpiryEntry(std::function<void()> onExpiry) : onExpiry_(std::move(onExpiry)) {}
+    ~ExpiryEntry() {
+        onExpiry_();
+    }
+
+  private:
+    std::function<void()> onExpiry_;
+};
+}  // namespace
+
+void StockReservations::initAndStart(const Json::Value& config) {
+    defaultTtlSeconds_ = config.get("default_ttl_seconds", 300).asInt64();
+    maxTtlSeconds_ = std::max<int64_t>(config.get("max_ttl_seconds", 3600).asInt64(), 1);
+    defaultTtlSeconds_ = std::clamp<int64_t>(defaultTtlSeconds_, 1, maxTtlSeconds_);
+
+    // One-second ticks; the extra ticks cover the rounding in scheduleExpiry()
+    wheel_ = std::make_shared<trantor::TimingWheel>(
+        drogon::app().getLoop(), static_cast<size_t>(maxTtlSeconds_) + 2, 1.0F, 100);
+
+    const bool durable = openLog(config.get("log_path", "reservations.log").asString());
+    std::vector<Hold> holds;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& [id, hold] : holds_) {
+            holds.push_back(hold);
+        }
+    }
+    for (const auto& hold : holds) {
+        scheduleExpiry(hold);
+    }
+    LOG_INFO << "StockReservations enabled: " << holds.size() << " holds restored, default ttl="
+             << defaultTtlSeconds_ << "s max ttl=" << maxTtlSeconds_ << "s"
+             << (durable ? "" : ", log not writable: holds will not survive a restart");
+}
+
+void StockReservations::shutdown() {
+    std::shared_ptr<trantor::TimingWheel> wheel;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // Destroying the wheel drops every entry; that must not expire the holds
+        stopping_ = true;
+        wheel = std::move(wheel_);
+    }
+    wheel.reset();
+    std::lock_guard<std::mutex> lock(mutex_);
+    log_.close();
+}
+
+bool StockReservations::openLog(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    logPath_ = path;
+    size_t replayed = 0;
+    {
+        std::ifstream in(path, std::ios::binary);
+        LogRecord record;
+        // A torn record at the end (crash mid-write) is shorter than a record and ignored
+        while (in.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+            const auto op = static_cast<Op>(record.op);
+            if (op == Op::Reserve) {
+                Hold hold;
+                hold.id = record.holdId;
+                hold.productId = record.productId;
+                hold.quantity = record.quantity;
+                hold.expiresAtMs = record.expiresAtMs;
+                holds_[hold.id] = hold;
+                stock_[hold.productId].reserved += hold.quantity;
+                nextHoldId_ = std::max(nextHoldId_, hold.id + 1);
+            } else if (op == Op::Commit || op == Op::Release || op == Op::Expire) {
+                auto it = holds_.find(record.holdId);
+                if (it != holds_.end()) {
+                    stock_[it->second.productId].reserved -= it->second.quantity;
+                    holds_.erase(it);
+                }
+            } else if (op == Op::Sequence) {
+                nextHoldId_ = std::max(nextHoldId_, record.holdId);
+            } else {
+                LOG_WARN << "StockReservations: unknown record in " << path
+                         << ", ignoring the rest of the log";
+                break;
+            }
+            ++replayed;
+        }
+    }
+    // A hold whose commit was in flight at the crash may already be applied; it is kept
+    // until it expires, which can only understate what is available
+    const int64_t now = nowMs();
+    for (auto it = holds_.begin(); it != holds_.end();) {
+        if (it->second.expiresAtMs <= now) {
+            stock_[it->second.productId].reserved -= it->second.quantity;
+            it = holds_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (auto it = stock_.begin(); it != stock_.end();) {
+        it = it->second.reserved == 0 && !it->second.known ? stock_.erase(it) : std::next(it);
+    }
+    if (replayed > 0) {
+        LOG_INFO << "StockReservations replayed " << replayed << " log records, "
+                 << holds_.size() << " holds live";
+    }
+    return compactLocked();
+}
+
+void StockReservations::load(const drogon::orm::DbClientPtr& dbClient) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        loading_ = true;
+        touchedDuringLoad_.clear();
+    }
+    try {
+        auto result =
+            dbClient->execSqlSync("select product_id, quantity_in_stock from products");
+        std::vector<std::pair<int64_t, int64_t>> rows;
+        rows.reserve(result.size());
+        for (const auto& row : result) {
+            rows.emplace_back(row["product_id"].as<int64_t>(),
+                              row["quantity_in_stock"].as<int64_t>());
+        }
+        loadStock(rows);
+        LOG_INFO << "StockReservations loaded stock of " << rows.size() << " products";
+    } catch (const drogon::orm::DrogonDbException& e) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        loading_ = false;
+        LOG_ERROR << "StockReservations load failed: " << e.base().what();
+    }
+}
+
+void StockReservations::loadStock(const std::vector<std::pair<int64_t, int64_t>>& rows) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& [productId, inStock] : rows) {
+        if (touchedDuringLoad_.count(productId)) {
+            continue;
+        }
+        auto& stock = stock_[productId];
+        stock.inStock = inStock;
+        stock.known = true;
+    }
+    loading_ = false;
+    touchedDuringLoad_.clear();
+    ready_ = true;
+}
+
+bool StockReservations::ready() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return ready_;
+}
+
+void StockReservations::updateStock(int64_t productId, int64_t inStock, int64_t version) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& stock = stock_[productId];
+    if (version != 0) {
+        if (version < stock.version) {
+            return;
+        }
+        stock.version = version;
+    }
+    if (loading_) {
+        touchedDuringLoad_.insert(productId);
+    }
+    stock.inStock = inStock;
+    stock.known = true;
+}
+
+void StockReservations::removeProduct(int64_t productId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (loading_) {
+        touchedDuringLoad_.insert(productId);
+    }
+    auto it = stock_.find(productId);
+    if (it == stock_.end()) {
+        return;
+    }
+    if (it->second.reserved == 0) {
+        stock_.erase(it);
+        return;
+    }
+    // Its holds keep their units until they expire or are released
+    it->second.inStock = 0;
+    it->second.version = 0;
+    it->second.known = false;
+}
+
+StockReservations::Status StockReservations::availability(int64_t productId,
+                                                          Availability& availability) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!ready_) {
+        return Status::NotReady;
+    }
+    auto it = stock_.find(productId);
+    if (it == stock_.end() || !it->second.known) {
+        return Status::UnknownProduct;
+    }
+    availability.inStock = it->second.inStock;
+    availability.reserved = it->second.reserved;
+    // Stock adjusted below the outstanding holds shows as nothing available
+    availability.available = std::max<int64_t>(it->second.inStock - it->second.reserved, 0);
+    return Status::Ok;
+}
+
+StockReservations::Status StockReservations::reserve(int64_t productId,
+                                                     int64_t quantity,
+                                                     int64_t ttlSeconds,
+                                                     Hold& hold) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!ready_) {
+            return Status::NotReady;
+        }
+        auto it = stock_.find(productId);
+        if (it == stock_.end() || !it->second.known) {
+            return Status::UnknownProduct;
+        }
+        if (quantity > it->second.inStock - it->second.reserved) {
+            ++refused_;
+            return Status::InsufficientStock;
+        }
+        ttlSeconds = ttlSeconds <= 0 ? defaultTtlSeconds_ : std::min(ttlSeconds, maxTtlSeconds_);
+        hold = Hold();
+        hold.id = nextHoldId_++;
+        hold.productId = productId;
+        hold.quantity = quantity;
+        hold.expiresAtMs = nowMs() + ttlSeconds * 1000;
+        it->second.reserved += quantity;
+        holds_.emplace(hold.id, hold);
+        appendLocked(Op::Reserve, hold);
+        ++reserved_;
+    }
+    scheduleExpiry(hold);
+    return Status::Ok;
+}
+
+StockReservations::Status StockReservations::beginCommit(uint64_t holdId, Hold& hold) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = holds_.find(holdId);
+    // A hold already being committed is not available to a second commit
+    if (it == holds_.end() || it->second.committing) {
+        return Status::NotFound;
+    }
+    if (it->second.expiresAtMs <= nowMs()) {
+        // Past its deadline but the wheel has not fired yet
+        dropLocked(it, Op::Expire);
+        ++expired_;
+        return Status::NotFound;
+    }
+    it->second.committing = true;
+    hold = it->second;
+    return Status::Ok;
+}
+
+void StockReservations::finishCommit(uint64_t holdId, bool applied) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = holds_.find(holdId);
+    if (it == holds_.end()) {
+        return;
+    }
+    if (!applied) {
+        if (it->second.expiresAtMs <= nowMs()) {
+            // The wheel skipped it while it was being committed and will not fire again
+            dropLocked(it, Op::Expire);
+            ++expired_;
+            return;
+        }
+        // Held again; the caller may retry or release it
+        it->second.committing = false;
+        return;
+    }
+    dropLocked(it, Op::Commit);
+    ++committed_;
+}
+
+StockReservations::Status StockReservations::release(uint64_t holdId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = holds_.find(holdId);
+    if (it == holds_.end() || it->second.committing) {
+        return Status::NotFound;
+    }
+    dropLocked(it, Op::Release);
+    ++released_;
+    return Status::Ok;
+}
+
+void StockReservations::expire(uint64_t holdId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_) {
+        return;
+    }
+    auto it = holds_.find(holdId);
+    if (it == holds_.end() || it->second.committing) {
+        return;
+    }
+    dropLocked(it, Op::Expire);
+    ++expired_;
+}
+
+void StockReservations::scheduleExpiry(const Hold& hold) {
+    std::shared_ptr<trantor::TimingWheel> wheel;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        wheel = wheel_;
+    }
+    if (!wheel) {
+        return;
+    }
+    // The wheel fires up to one tick early, hence the extra second
+    const int64_t remainingMs = std::max<int64_t>(hold.expiresAtMs - nowMs(), 0);
+    const auto delay = static_cast<size_t>((remainingMs + 999) / 1000 + 1);
+    const uint64_t holdId = hold.id;
+    wheel->insertEntry(delay, std::make_shared<ExpiryEntry>([this, holdId]() { expire(holdId); }));
+}
+
+void StockReservations::dropLocked(std::unordered_map<uint64_t, Hold>::iterator it, Op op) {
+    const Hold hold = it->second;
+    // Erased before the append, which may compact the log from holds_
+    holds_.erase(it);
+    auto stock = stock_.find(hold.productId);
+    if (stock != stock_.end()) {
+        stock->second.reserved -= hold.quantity;
+        if (stock->second.reserved == 0 && !stock->second.known) {
+            stock_.erase(stock);
+        }
+    }
+    appendLocked(op, hold);
+}
+
+void StockReservations::appendLocked(Op op, const Hold& hold) {
+    if (!log_.is_open()) {
+        return;
+    }
+    LogRecord record{};
+    record.op = static_cast<uint8_t>(op);
+    record.holdId = hold.id;
+    if (op == Op::Reserve) {
+        record.quantity = static_cast<int32_t>(hold.quantity);
+        record.productId = hold.productId;
+        record.expiresAtMs = hold.expiresAtMs;
+    }
+    // flush() hands the record to the kernel: it survives a crash of the process, not
+    // of the machine
+    log_.write(reinterpret_cast<const char*>(&record), sizeof(record));
+    log_.flush();
+    ++logRecords_;
+    if (logRecords_ >= kCompactMinRecords && logRecords_ > 4 * (holds_.size() + 1)) {
+        compactLocked();
+    }
+}
+
+bool StockReservations::compactLocked() {
+    // Live holds plus the next id, so ids are never reused across restarts
+    const std::string tmpPath = logPath_ + ".tmp";
+    std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+    LogRecord sequence{};
+    sequence.op = static_cast<uint8_t>(Op::Sequence);
+    sequence.holdId = nextHoldId_;
+    out.write(reinterpret_cast<const char*>(&sequence), sizeof(sequence));
+    for (const auto& [id, hold] : holds_) {
+        LogRecord record{};
+        record.op = static_cast<uint8_t>(Op::Reserve);
+        record.quantity = static_cast<int32_t>(hold.quantity);
+        record.holdId = hold.id;
+        record.productId = hold.productId;
+        record.expiresAtMs = hold.expiresAtMs;
+        out.write(reinterpret_cast<const char*>(&record), sizeof(record));
+    }
+    out.flush();
+    if (!out) {
+        LOG_WARN << "StockReservations: cannot write " << tmpPath;
+        return log_.is_open();
+    }
+    out.close();
+    log_.close();
+    if (std::rename(tmpPath.c_str(), logPath_.c_str()) != 0) {
+        LOG_WARN << "StockReservations: cannot replace " << logPath_;
+    }
+    log_.open(logPath_, std::ios::binary | std::ios::app);
+    logRecords_ = holds_.size() + 1;
+    return log_.is_open();
+}
+
+Json::Value StockReservations::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    int64_t units = 0;
+    for (const auto& [id, hold] : holds_) {
+        units += hold.quantity;
+    }
+    Json::Value ret;
+    ret["holds"] = static_cast<Json::UInt64>(holds_.size());
+    ret["reserved_units"] = static_cast<Json::Int64>(units);
+    ret["reserved"] = static_cast<Json::UInt64>(reserved_);
+    ret["committed"] = static_cast<Json::UInt64>(committed_);
+    ret["released"] = static_cast<Json::UInt64>(released_);
+    ret["expired"] = static_cast<Json::UInt64>(expired_);
+    ret["refused"] = static_cast<Json::UInt64>(refused_);
+    ret["log_records"] = static_cast<Json::UInt64>(logRecords_);
+    return ret;
+}
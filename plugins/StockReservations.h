@@ -0,0 +1,169 @@
+/**
+ *
+ *  StockReservations.h
+ *
+ */
+
+#pragma once
+
+#include <drogon/orm/DbClient.h>
+#include <drogon/plugins/Plugin.h>
+#include <trantor/utils/TimingWheel.h>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Short-lived stock holds for checkout, kept in memory
+ *
+ * A hold sets aside some of a product's quantity_in_stock for a few minutes without
+ * writing the products table. available = in_stock - reserved is answered from memory:
+ * in_stock is loaded once after the database is initialized and then maintained by
+ * every product write, like LowStockIndex. Reserving, committing and releasing hold the
+ * plugin's lock, so two carts can never hold the same unit.
+ *
+ * Committing a hold is the only step that touches SQLite: the caller applies the
+ * guarded stock decrement and then calls finishCommit(). Holds that are neither
+ * committed nor released expire on a one-second timing wheel on the main loop.
+ *
+ * Every change is appended to a log of fixed 32-byte records before it is
+ * acknowledged, and the log is replayed at startup, so a restart keeps the holds that
+ * have not expired. The log is rewritten with only the live holds at startup and
+ * whenever dead records outgrow them.
+ *
+ * config.json:
+ * @code
+   {
+      "name": "StockReservations",
+      "config": {
+         "log_path": "reservations.log",
+         "default_ttl_seconds": 300,  // when the request does not set ttl_seconds
+         "max_ttl_seconds": 3600
+      }
+   }
+   @endcode
+ */
+class StockReservations : public drogon::Plugin<StockReservations> {
+  public:
+    struct Hold {
+        uint64_t id{0};
+        int64_t productId{0};
+        int64_t quantity{0};
+        /// Milliseconds since the Unix epoch
+        int64_t expiresAtMs{0};
+        /// Between beginCommit() and finishCommit(); such a hold cannot expire
+        bool committing{false};
+    };
+
+    struct Availability {
+        int64_t inStock{0};
+        int64_t reserved{0};
+        int64_t available{0};
+    };
+
+    enum class Status { Ok, NotReady, UnknownProduct, InsufficientStock, NotFound };
+
+    StockReservations() = default;
+    void initAndStart(const Json::Value& config) override;
+    void shutdown() override;
+
+    /**
+     * @brief Replay the log at @p path, then keep appending to it
+     *
+     * Holds that expired while the server was down are dropped. Call before load().
+     * @return false if the log cannot be written; holds then live in memory only
+     */
+    bool openLog(const std::string& path);
+
+    /// Read in_stock of every product; writes that race with the load win
+    void load(const drogon::orm::DbClientPtr& dbClient);
+    /// Same as load() with (product_id, quantity_in_stock) pairs already read
+    void loadStock(const std::vector<std::pair<int64_t, int64_t>>& rows);
+    /// False until load() has completed
+    bool ready() const;
+
+    /**
+     * @brief Record the quantity_in_stock of a product after an insert or update
+     *
+     * @param version The row's version column; a row older than the last one recorded
+     * is ignored. 0 if unknown: inserts, and buffered adjustments that have no row yet.
+     */
+    void updateStock(int64_t productId, int64_t inStock, int64_t version = 0);
+    /// Forget a deleted product; its holds can no longer be committed
+    void removeProduct(int64_t productId);
+
+    Status availability(int64_t productId, Availability& availability) const;
+
+    /// Hold @p quantity units of @p productId for @p ttlSeconds (0 = the default)
+    Status reserve(int64_t productId, int64_t quantity, int64_t ttlSeconds, Hold& hold);
+    /**
+     * @brief Start turning a hold into a real decrement of @p hold.quantity
+     *
+     * The units stay reserved until finishCommit(), so nobody else can take them while
+     * the decrement is written.
+     */
+    Status beginCommit(uint64_t holdId, Hold& hold);
+    /**
+     * @brief End a commit; @p applied is false if the decrement was refused or failed
+     *
+     * A hold that was not applied and whose deadline passed meanwhile expires now.
+     */
+    void finishCommit(uint64_t holdId, bool applied);
+    Status release(uint64_t holdId);
+
+    int64_t maxTtlSeconds() const {
+        return maxTtlSeconds_;
+    }
+
+    Json::Value stats() const;
+
+  private:
+    struct Stock {
+        int64_t inStock{0};
+        int64_t reserved{0};
+        /// Row version in_stock was last recorded from, 0 if none
+        int64_t version{0};
+        /// Set once in_stock is known; holds replayed from the log come first
+        bool known{false};
+    };
+
+    /// Log record kinds; the value is stored in the record
+    enum class Op : uint8_t { Reserve = 1, Commit = 2, Release = 3, Expire = 4, Sequence = 5 };
+
+    void expire(uint64_t holdId);
+    void scheduleExpiry(const Hold& hold);
+    /// Drop @p it and its reservation, logging @p op
+    void dropLocked(std::unordered_map<uint64_t, Hold>::iterator it, Op op);
+    void appendLocked(Op op, const Hold& hold);
+    bool compactLocked();
+
+    mutable std::mutex mutex_;
+    std::unordered_map<int64_t, Stock> stock_;
+    std::unordered_map<uint64_t, Hold> holds_;
+    uint64_t nextHoldId_{1};
+    bool ready_{false};
+    bool loading_{false};
+    /// Products written while load() was reading; their snapshot rows are stale
+    std::unordered_set<int64_t> touchedDuringLoad_;
+
+    std::string logPath_;
+    std::ofstream log_;
+    size_t logRecords_{0};
+
+    std::shared_ptr<trantor::TimingWheel> wheel_;
+    int64_t defaultTtlSeconds_{300};
+    int64_t maxTtlSeconds_{3600};
+    bool stopping_{false};
+
+    uint64_t reserved_{0};
+    uint64_t committed_{0};
+    uint64_t released_{0};
+    uint64_t expired_{0};
+    uint64_t refused_{0};
+};
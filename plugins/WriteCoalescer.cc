@@ -0,0 +1,219 @@
+/**
+ *
+ *  WriteCoalescer.cc
+ *
+ */
+
+#include "WriteCoalescer.h"
+#include <drogon/HttpAppFramework.h>
+#include <drogon/orm/Exception.h>
+#include <trantor/utils/Logger.h>
+#include <algorithm>
+#include <future>
+#include <unordered_map>
+#include "db/productinsert.h"
+
+void WriteCoalescer::initAndStart(const Json::Value& config) {
+    const double windowMs = config.get("window_ms", 2).asDouble();
+    windowSeconds_ = std::max(0.0, windowMs) / 1000.0;
+    maxBatch_ = std::max<size_t>(1, config.get("max_batch", 256).asUInt64());
+
+    loopThread_ = std::make_unique<trantor::EventLoopThread>("WriteCoalescer");
+    loopThread_->run();
+    loop_ = loopThread_->getLoop();
+    LOG_INFO << "WriteCoalescer enabled: window=" << windowMs << "ms max_batch=" << maxBatch_;
+}
+
+void WriteCoalescer::shutdown() {
+    if (!loopThread_) {
+        return;
+    }
+    // Write whatever is still queued before the thread stops
+    loop_->runInLoop([this]() { flush(); });
+    loopThread_.reset();
+    loop_ = nullptr;
+}
+
+void WriteCoalescer::submit(Json::Value&& product, Callback&& callback) {
+    Pending pending;
+    pending.product = std::move(product);
+    pending.callback = std::move(callback);
+    pending.loop = trantor::EventLoop::getEventLoopOfCurrentThread();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.push_back(std::move(pending));
+    if (queue_.size() >= maxBatch_) {
+        if (!flushQueued_) {
+            flushQueued_ = true;
+            loop_->queueInLoop([this]() { flush(); });
+        }
+    } else if (!timerScheduled_) {
+        timerScheduled_ = true;
+        loop_->runAfter(windowSeconds_, [this]() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                timerScheduled_ = false;
+            }
+            flush();
+        });
+    }
+}
+
+Json::Value WriteCoalescer::stats() const {
+    const uint64_t batches = batches_.load(std::memory_order_relaxed);
+    const uint64_t rows = rows_.load(std::memory_order_relaxed);
+    Json::Value ret;
+    ret["batches"] = static_cast<Json::UInt64>(batches);
+    ret["rows"] = static_cast<Json::UInt64>(rows);
+    ret["average_batch"] = batches == 0 ? 0.0 : static_cast<double>(rows) / batches;
+    ret["largest_batch"] = static_cast<Json::UInt64>(largestBatch_.load(std::memory_order_relaxed));
+    ret["row_by_row_retries"] =
+        static_cast<Json::UInt64>(rowByRowRetries_.load(std::memory_order_relaxed));
+    ret["window_ms"] = windowSeconds_ * 1000.0;
+    ret["max_batch"] = static_cast<Json::UInt64>(maxBatch_);
+    return ret;
+}
+
+void WriteCoalescer::flush() {
+    std::vector<Pending> batch;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        batch.swap(queue_);
+        flushQueued_ = false;
+    }
+    if (batch.empty()) {
+        return;
+    }
+    writeBatch(batch);
+
+    for (auto& pending : batch) {
+        if (pending.loop == nullptr) {
+            pending.callback(pending.outcome);
+            continue;
+        }
+        pending.loop->queueInLoop(
+            [callback = std::move(pending.callback), outcome = std::move(pending.outcome)]() {
+                callback(outcome);
+            });
+    }
+}
+
+void WriteCoalescer::writeBatch(std::vector<Pending>& batch) {
+    batches_.fetch_add(1, std::memory_order_relaxed);
+    rows_.fetch_add(batch.size(), std::memory_order_relaxed);
+    uint64_t largest = largestBatch_.load(std::memory_order_relaxed);
+    while (batch.size() > largest &&
+           !largestBatch_.compare_exchange_weak(largest, batch.size(), std::memory_order_relaxed)) {
+    }
+
+    std::vector<const Json::Value*> products;
+    products.reserve(batch.size());
+    for (const auto& pending : batch) {
+        products.push_back(&pending.product);
+    }
+    std::vector<Outcome> outcomes;
+    if (!resolveBatch(products, &WriteCoalescer::insertInTransaction, &WriteCoalescer::insertAlone,
+                      outcomes)) {
+        rowByRowRetries_.fetch_add(1, std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < batch.size(); ++i) {
+        batch[i].outcome = std::move(outcomes[i]);
+    }
+}
+
+bool WriteCoalescer::resolveBatch(const std::vector<const Json::Value*>& products,
+                                  const BatchInsert& insertBatch,
+                                  const RowInsert& insertRow,
+                                  std::vector<Outcome>& outcomes) {
+    outcomes.assign(products.size(), Outcome{});
+    std::unordered_map<std::string, size_t> indexBySku;
+    std::vector<const Json::Value*> rows;
+    std::vector<size_t> rowIndexes;
+    rows.reserve(products.size());
+    rowIndexes.reserve(products.size());
+    for (size_t i = 0; i < products.size(); ++i) {
+        outcomes[i].status = Outcome::Status::Conflict;
+        if (indexBySku.emplace((*products[i])["sku"].asString(), i).second) {
+            rows.push_back(products[i]);
+            rowIndexes.push_back(i);
+        }
+    }
+    if (rows.empty()) {
+        return true;
+    }
+
+    InsertedRows inserted;
+    if (insertBatch(rows, inserted)) {
+        // RETURNING order is unspecified, so rows are matched back by their unique SKU
+        for (const auto& [sku, productId] : inserted) {
+            auto it = indexBySku.find(sku);
+            if (it != indexBySku.end()) {
+                outcomes[it->second].status = Outcome::Status::Created;
+                outcomes[it->second].productId = productId;
+            }
+        }
+        return true;
+    }
+    for (size_t r = 0; r < rows.size(); ++r) {
+        outcomes[rowIndexes[r]] = insertRow(*rows[r]);
+    }
+    return false;
+}
+
+bool WriteCoalescer::insertInTransaction(const std::vector<const Json::Value*>& products,
+                                         InsertedRows& inserted) {
+    auto committed = std::make_shared<std::promise<bool>>();
+    auto commitResult = committed->get_future();
+    try {
+        auto transaction = drogon::app().getDbClient()->newTransaction(
+            [committed](bool ok) { committed->set_value(ok); });
+        for (size_t begin = 0; begin < products.size(); begin += kProductInsertRowsPerStatement) {
+            const size_t end = std::min(products.size(), begin + kProductInsertRowsPerStatement);
+            auto binder = *transaction << buildProductInsertSql(end - begin);
+            for (size_t r = begin; r < end; ++r) {
+                bindProductInsertRow(binder, *products[r]);
+            }
+            binder << drogon::orm::Mode::Blocking;
+            binder >> [&inserted](const drogon::orm::Result& result) {
+                for (const auto& row : result) {
+                    inserted.emplace_back(row["sku"].as<std::string>(),
+                                          row["product_id"].as<int64_t>());
+                }
+            };
+            binder.exec();
+        }
+        // Releasing the last reference commits
+    } catch (const drogon::orm::DrogonDbException& e) {
+        LOG_WARN << "WriteCoalescer batch of " << products.size()
+                 << " failed, retrying row by row: " << e.base().what();
+        return false;
+    }
+    if (!commitResult.get()) {
+        LOG_WARN << "WriteCoalescer batch of " << products.size()
+                 << " did not commit, retrying row by row";
+        return false;
+    }
+    return true;
+}
+
+WriteCoalescer::Outcome WriteCoalescer::insertAlone(const Json::Value& product) {
+    Outcome outcome;
+    try {
+        auto binder = *drogon::app().getDbClient() << buildProductInsertSql(1);
+        bindProductInsertRow(binder, product);
+        binder << drogon::orm::Mode::Blocking;
+        binder >> [&outcome](const drogon::orm::Result& result) {
+            if (result.empty()) {
+                outcome.status = Outcome::Status::Conflict;
+            } else {
+                outcome.status = Outcome::Status::Created;
+                outcome.productId = result[0]["product_id"].as<int64_t>();
+            }
+        };
+        binder.exec();
+    } catch (const drogon::orm::DrogonDbException& e) {
+        outcome.status = Outcome::Status::Failed;
+        outcome.message = e.base().what();
+    }
+    return outcome;
+}
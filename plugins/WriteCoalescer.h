@@ -0,0 +1,126 @@
+/**
+ *
+ *  WriteCoalescer.h
+ *
+ */
+
+#pragma once
+
+#include <drogon/plugins/Plugin.h>
+#include <trantor/net/EventLoop.h>
+#include <trantor/net/EventLoopThread.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Group commit for POST /api/products
+ *
+ * Single-product inserts submitted from any IO thread are queued and written
+ * together: a batch is flushed when it reaches max_batch or when the oldest queued
+ * insert has waited window_ms, whichever comes first. The batch is written with
+ * multi-row INSERT ... ON CONFLICT(sku) DO NOTHING statements in one transaction,
+ * so a duplicate SKU only fails its own request. If the batch transaction fails as
+ * a whole, its rows are retried one at a time so any other per-row error stays with
+ * the request that caused it. Each callback runs on the loop that submitted it.
+ *
+ * Writes happen on the plugin's own thread, which blocks on the database while a
+ * batch is written; inserts arriving meanwhile form the next batch.
+ *
+ * config.json:
+ * @code
+   {
+      "name": "WriteCoalescer",
+      "config": {
+         "window_ms": 2,     // longest an insert waits for others to join its batch
+         "max_batch": 256    // flush as soon as this many inserts are queued
+      }
+   }
+   @endcode
+ */
+class WriteCoalescer : public drogon::Plugin<WriteCoalescer> {
+  public:
+    struct Outcome {
+        enum class Status { Created, Conflict, Failed };
+        Status status{Status::Failed};
+        /// Set when Created
+        int64_t productId{0};
+        /// Database error when Failed
+        std::string message;
+    };
+    using Callback = std::function<void(const Outcome&)>;
+
+    /// (sku, product_id) of each row an INSERT ... RETURNING reported
+    using InsertedRows = std::vector<std::pair<std::string, int64_t>>;
+    /// Insert @p products in one transaction; false if it failed as a whole
+    using BatchInsert =
+        std::function<bool(const std::vector<const Json::Value*>& products,
+                           InsertedRows& inserted)>;
+    /// Insert one product on its own
+    using RowInsert = std::function<Outcome(const Json::Value& product)>;
+
+    WriteCoalescer() = default;
+    void initAndStart(const Json::Value& config) override;
+    void shutdown() override;
+
+    /**
+     * @brief Queue one insert
+     * @param product JSON already accepted by validateProductData() and
+     * Products::validateJsonForCreation()
+     */
+    void submit(Json::Value&& product, Callback&& callback);
+
+    /// Batch counters for tuning window_ms and max_batch
+    Json::Value stats() const;
+
+    /**
+     * @brief Work out the outcome of each of @p products, written as one batch
+     *
+     * Of two inserts of the same SKU the first one submitted is written and the other
+     * is a Conflict, exactly as if they had been separate transactions in arrival
+     * order. The rows left are handed to @p insertBatch; a row it does not report
+     * hit an existing SKU. If the batch fails as a whole, each row is retried with
+     * @p insertRow, so any other error stays with the request that caused it.
+     *
+     * @return false if the batch was retried row by row
+     */
+    static bool resolveBatch(const std::vector<const Json::Value*>& products,
+                             const BatchInsert& insertBatch,
+                             const RowInsert& insertRow,
+                             std::vector<Outcome>& outcomes);
+
+  private:
+    struct Pending {
+        Json::Value product;
+        Callback callback;
+        /// Loop of the submitting thread, nullptr if it has none
+        trantor::EventLoop* loop{nullptr};
+        Outcome outcome;
+    };
+
+    void flush();
+    void writeBatch(std::vector<Pending>& batch);
+    /// BatchInsert and RowInsert on the application's database
+    static bool insertInTransaction(const std::vector<const Json::Value*>& products,
+                                    InsertedRows& inserted);
+    static Outcome insertAlone(const Json::Value& product);
+
+    std::unique_ptr<trantor::EventLoopThread> loopThread_;
+    trantor::EventLoop* loop_{nullptr};
+    double windowSeconds_{0.002};
+    size_t maxBatch_{256};
+
+    std::mutex mutex_;
+    std::vector<Pending> queue_;
+    bool timerScheduled_{false};
+    bool flushQueued_{false};
+
+    std::atomic<uint64_t> batches_{0};
+    std::atomic<uint64_t> rows_{0};
+    std::atomic<uint64_t> largestBatch_{0};
+    std::atomic<uint64_t> rowByRowRetries_{0};
+};
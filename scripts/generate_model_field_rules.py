@@ -0,0 +1,156 @@
+#!/usr/bin/env python3
+"""Generate the constexpr field validation tables of the drogon_ctl models.
+
+Reads the column metadata (metaData_) of the models listed in MODELS and emits
+models/ModelFieldRules.h with one std::array<FieldRule, N> per model, in metaData_
+order. Type, NOT NULL and auto-assigned columns come from metaData_; length and
+range bounds come from BOUNDS below, the one place the business rules live.
+
+Re-run after regenerating the models with drogon_ctl or changing BOUNDS:
+
+    python3 scripts/generate_model_field_rules.py
+"""
+
+import os
+import re
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+MODELS_DIR = os.path.join(ROOT, "models")
+OUTPUT = "ModelFieldRules.h"
+
+MODELS = ("Products", "Supplier", "Warehouse", "PurchaseOrder")
+
+META_BLOCK = re.compile(r"(\w+)::metaData_\s*=\s*\{(.*?)\};", re.S)
+META_ENTRY = re.compile(
+    r'\{\s*"(\w+)"\s*,\s*"([^"]+)"\s*,\s*"[^"]*"\s*,\s*-?\d+\s*,\s*(\d)\s*,\s*\d\s*,\s*(\d)\s*\}')
+
+# (model, column) -> bounds: "length" (min, max) for text, "range" (min, max) and
+# "decimals" for numbers
+BOUNDS = {
+    ("Products", "product_id"): {"range": (1, None)},
+    ("Products", "sku"): {"length": (1, 50)},
+    ("Products", "name"): {"length": (1, 100)},
+    ("Products", "description"): {"length": (0, 500)},
+    ("Products", "category"): {"length": (0, 100)},
+    ("Products", "unit_price"): {"range": (0.01, 999999.99), "decimals": 2},
+    ("Products", "quantity_in_stock"): {"range": (0, 1000000)},
+    ("Products", "reorder_threshold"): {"range": (0, 1000000)},
+    ("Products", "supplier_id"): {"range": (1, None)},
+    ("Products", "warehouse_id"): {"range": (1, None)},
+    ("Supplier", "supplier_id"): {"range": (1, None)},
+    ("Supplier", "name"): {"length": (1, 100)},
+    ("Supplier", "contact_person"): {"length": (0, 100)},
+    ("Supplier", "email"): {"length": (0, 254)},
+    ("Supplier", "phone"): {"length": (0, 50)},
+    ("Supplier", "address"): {"length": (0, 500)},
+    ("Warehouse", "warehouse_id"): {"range": (1, None)},
+    ("Warehouse", "name"): {"length": (1, 100)},
+    ("Warehouse", "location"): {"length": (0, 255)},
+    ("Warehouse", "capacity"): {"range": (0, None)},
+    ("PurchaseOrder", "order_id"): {"range": (1, None)},
+    ("PurchaseOrder", "product_id"): {"range": (1, None)},
+    ("PurchaseOrder", "supplier_id"): {"range": (1, None)},
+    ("PurchaseOrder", "quantity_ordered"): {"range": (1, 1000000)},
+    ("PurchaseOrder", "unit_price"): {"range": (0, 999999.99), "decimals": 2},
+    ("PurchaseOrder", "total_price"): {"range": (0, None), "decimals": 2},
+    ("PurchaseOrder", "status"): {"length": (1, 20)},
+}
+
+# Columns the server maintains itself; validateFields() refuses them from clients
+SERVER_SET = ("created_at", "updated_at")
+
+INT_TYPES = ("int64_t", "int32_t", "int16_t", "int8_t", "uint64_t", "uint32_t")
+
+HEADER = """/**
+ *
+ *  ModelFieldRules.h
+ *  DO NOT EDIT. This file is generated by scripts/generate_model_field_rules.py
+ *
+ */
+
+#pragma once
+#include <array>
+#include "utils/fieldvalidator.h"
+
+namespace drogon_model
+{
+namespace sqlite3
+{
+"""
+
+FOOTER = """
+} // namespace sqlite3
+} // namespace drogon_model
+"""
+
+
+def number(value):
+    text = repr(value)
+    return text if "." in text or "e" in text else text + ".0"
+
+
+def rule(model, column, col_type, auto_val, not_null):
+    bounds = BOUNDS.get((model, column), {})
+    name = '"%s"' % column
+    null = "true" if not_null and not auto_val else "false"
+    if col_type in INT_TYPES:
+        low, high = bounds.get("range", (None, None))
+        args = [name, null, "true" if auto_val else "false"]
+        if low is not None or high is not None:
+            args.append(number(low) if low is not None else
+                        "std::numeric_limits<int64_t>::min()")
+        if high is not None:
+            args.append(number(high))
+        return "integerField(%s)" % ", ".join(args)
+    if col_type in ("double", "float"):
+        low, high = bounds.get("range", (None, None))
+        args = [name, null,
+                number(low) if low is not None else "-std::numeric_limits<double>::max()",
+                number(high) if high is not None else "std::numeric_limits<double>::max()"]
+        if "decimals" in bounds:
+            args.append(str(bounds["decimals"]))
+        return "realField(%s)" % ", ".join(args)
+    if col_type == "std::string":
+        args = [name, null]
+        if "length" in bounds:
+            args += [str(bounds["length"][0]), str(bounds["length"][1])]
+        return "textField(%s)" % ", ".join(args)
+    if col_type == "::trantor::Date":
+        if column in SERVER_SET:
+            return "dateTimeField(%s, %s, true)" % (name, null)
+        return "dateTimeField(%s, %s)" % (name, null)
+    sys.exit("unsupported column type %s" % col_type)
+
+
+def load_model(model):
+    with open(os.path.join(MODELS_DIR, model + ".cc")) as f:
+        match = META_BLOCK.search(f.read())
+    if not match or match.group(1) != model:
+        sys.exit("no metaData_ for %s" % model)
+    columns = META_ENTRY.findall(match.group(2))
+    for column, col_type, _, _ in columns:
+        if (model, column) not in BOUNDS and col_type != "::trantor::Date":
+            print("note: %s.%s has no bounds" % (model, column))
+    return columns
+
+
+def main():
+    lines = [HEADER]
+    for model in MODELS:
+        columns = load_model(model)
+        lines.append("/// Field rules of %s, in metaData_ order" % model)
+        lines.append("inline constexpr std::array<FieldRule, %d> k%sFieldRules{{" %
+                     (len(columns), model))
+        for column, col_type, auto_val, not_null in columns:
+            lines.append("    %s," % rule(model, column, col_type, auto_val == "1", not_null == "1"))
+        lines.append("}};")
+        lines.append("")
+    content = "\n".join(lines).rstrip("\n") + "\n" + FOOTER
+    with open(os.path.join(MODELS_DIR, OUTPUT), "w") as f:
+        f.write(content)
+    print("wrote models/" + OUTPUT)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,205 @@
+#!/usr/bin/env python3
+"""Generate direct-to-buffer JSON writers for the drogon_ctl models.
+
+Reads the column metadata (metaData_) of every model in models/ and emits
+models/ModelJsonWriters.h/.cc with, per model:
+
+  appendJson(out, obj)              exactly the bytes drogon would send for
+                                    obj.toJson(): keys in jsoncpp's sorted order,
+                                    every column present, null for unset columns
+  appendJson(out, obj, columnMask)  the same restricted to the columns whose
+                                    metaData_ index bit is set in columnMask
+  readProjectedRow(row, mask, obj)  fill obj from a row that holds only the
+                                    masked columns, in metaData_ order
+
+Re-run after regenerating the models with drogon_ctl:
+
+    python3 scripts/generate_model_json_writers.py
+"""
+
+import os
+import re
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+MODELS_DIR = os.path.join(ROOT, "models")
+OUTPUT_BASE = "ModelJsonWriters"
+
+META_BLOCK = re.compile(r"(\w+)::metaData_\s*=\s*\{(.*?)\};", re.S)
+META_ENTRY = re.compile(r'\{\s*"(\w+)"\s*,\s*"([^"]+)"')
+
+HEADER_BANNER = """/**
+ *
+ *  {name}
+ *  DO NOT EDIT. This file is generated by scripts/generate_model_json_writers.py
+ *
+ */
+"""
+
+
+def getter_suffix(column):
+    return "".join(part[:1].upper() + part[1:] for part in column.split("_"))
+
+
+def load_models():
+    models = []
+    for filename in sorted(os.listdir(MODELS_DIR)):
+        if not filename.endswith(".cc") or filename.startswith(OUTPUT_BASE):
+            continue
+        with open(os.path.join(MODELS_DIR, filename)) as f:
+            source = f.read()
+        match = META_BLOCK.search(source)
+        if not match:
+            continue
+        columns = META_ENTRY.findall(match.group(2))
+        models.append((match.group(1), filename[:-3] + ".h", columns))
+    return models
+
+
+INT_TYPES = ("int64_t", "int32_t", "int16_t", "int8_t", "uint64_t", "uint32_t")
+
+
+def value_reader(col_type, suffix):
+    if col_type == "::trantor::Date":
+        return "obj.set%s(::trantor::Date::fromDbStringLocal(r[index].as<std::string>()));" % suffix
+    return "obj.set%s(r[index].as<%s>());" % (suffix, col_type)
+
+
+def value_writer(col_type, suffix):
+    if col_type in INT_TYPES:
+        return "appendJsonInt(out, obj.getValueOf%s());" % suffix
+    if col_type in ("double", "float"):
+        return "appendJsonDouble(out, obj.getValueOf%s());" % suffix
+    if col_type == "bool":
+        return "appendJsonBool(out, obj.getValueOf%s());" % suffix
+    if col_type == "std::string":
+        return "appendJsonString(out, obj.getValueOf%s());" % suffix
+    if col_type == "::trantor::Date":
+        return "appendJsonString(out, obj.get%s()->toDbStringLocal());" % suffix
+    sys.exit("unsupported column type %s" % col_type)
+
+
+def generate_header(models):
+    lines = [HEADER_BANNER.format(name=OUTPUT_BASE + ".h"), "#pragma once"]
+    for _, header, _ in models:
+        lines.append('#include "%s"' % header)
+    lines += [
+        "#include <cstdint>",
+        "#include <string>",
+        "",
+        "namespace drogon_model",
+        "{",
+        "namespace sqlite3",
+        "{",
+        "",
+    ]
+    for name, _, _ in models:
+        lines += [
+            "/// Append obj as compact JSON, byte-identical to the drogon serialization of obj.toJson()",
+            "void appendJson(std::string &out, const %s &obj);" % name,
+            "/// Same as above restricted to the columns whose metaData_ index bit is set in columnMask",
+            "void appendJson(std::string &out, const %s &obj, uint64_t columnMask);" % name,
+            "/// Fill obj from a row holding only the masked columns, in metaData_ order",
+            "void readProjectedRow(const drogon::orm::Row &r, uint64_t columnMask, %s &obj);" % name,
+        ]
+    lines += ["", "} // namespace sqlite3", "} // namespace drogon_model", ""]
+    return "\n".join(lines)
+
+
+def generate_source(models):
+    lines = [
+        HEADER_BANNER.format(name=OUTPUT_BASE + ".cc"),
+        '#include "%s.h"' % OUTPUT_BASE,
+        '#include "utils/jsonwriter.h"',
+        "",
+        "using namespace drogon_model::sqlite3;",
+    ]
+    for name, _, columns in models:
+        lines += ["", "void drogon_model::sqlite3::appendJson(std::string &out, const %s &obj)" % name, "{"]
+        # jsoncpp keeps object members in a std::map, so keys come out in byte order
+        for i, (column, col_type) in enumerate(sorted(columns)):
+            suffix = getter_suffix(column)
+            key = ("{" if i == 0 else ",") + '\\"%s\\":' % column
+            lines += [
+                '    appendJsonRaw(out, "%s");' % key,
+                "    if(obj.get%s())" % suffix,
+                "    {",
+                "        " + value_writer(col_type, suffix),
+                "    }",
+                "    else",
+                "    {",
+                "        appendJsonNull(out);",
+                "    }",
+            ]
+        lines += ["    out += '}';", "}"]
+
+        indexed = {column: i for i, (column, _) in enumerate(columns)}
+        lines += [
+            "",
+            "void drogon_model::sqlite3::appendJson(std::string &out, const %s &obj, uint64_t columnMask)" % name,
+            "{",
+            "    char separator = '{';",
+        ]
+        for column, col_type in sorted(columns):
+            suffix = getter_suffix(column)
+            lines += [
+                "    if(columnMask & (1ULL << %d))" % indexed[column],
+                "    {",
+                "        out += separator;",
+                "        separator = ',';",
+                '        appendJsonRaw(out, "\\"%s\\":");' % column,
+                "        if(obj.get%s())" % suffix,
+                "        {",
+                "            " + value_writer(col_type, suffix),
+                "        }",
+                "        else",
+                "        {",
+                "            appendJsonNull(out);",
+                "        }",
+                "    }",
+            ]
+        lines += [
+            "    if(separator == '{')",
+            "    {",
+            "        out += '{';",
+            "    }",
+            "    out += '}';",
+            "}",
+            "",
+            "void drogon_model::sqlite3::readProjectedRow(const drogon::orm::Row &r, uint64_t columnMask, %s &obj)" % name,
+            "{",
+            "    size_t index = 0;",
+        ]
+        for i, (column, col_type) in enumerate(columns):
+            suffix = getter_suffix(column)
+            lines += [
+                "    if(columnMask & (1ULL << %d))" % i,
+                "    {",
+                "        if(!r[index].isNull())",
+                "        {",
+                "            " + value_reader(col_type, suffix),
+                "        }",
+                "        ++index;",
+                "    }",
+            ]
+        lines += ["}"]
+    lines.append("")
+    return "\n".join(lines)
+
+
+def main():
+    models = load_models()
+    if not models:
+        sys.exit("no models found in " + MODELS_DIR)
+    outputs = {
+        OUTPUT_BASE + ".h": generate_header(models),
+        OUTPUT_BASE + ".cc": generate_source(models),
+    }
+    for filename, content in outputs.items():
+        with open(os.path.join(MODELS_DIR, filename), "w") as f:
+            f.write(content)
+        print("wrote models/" + filename)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,42 @@
+#include <drogon/drogon_test.h>
+#include <sstream>
+#include "utils/csvreader.h"
+
+DROGON_TEST(CsvReaderQuotedFields) {
+    std::istringstream in(
+        "sku,name,description\r\n"
+        "A-1,\"Widget, large\",\"says \"\"hi\"\"\"\r\n"
+        "A-2,Gadget,\"two\nlines\"\r\n"
+        "A-3,,\n");
+    CsvReader reader(in);
+    std::vector<std::string> fields;
+
+    REQUIRE(reader.next(fields));
+    CHECK(fields.size() == 3);
+    CHECK(fields[2] == "description");
+
+    REQUIRE(reader.next(fields));
+    CHECK(fields[1] == "Widget, large");
+    CHECK(fields[2] == "says \"hi\"");
+    CHECK(reader.recordLine() == 2);
+
+    REQUIRE(reader.next(fields));
+    CHECK(fields[2] == "two\nlines");
+
+    REQUIRE(reader.next(fields));
+    CHECK(fields.size() == 3);
+    CHECK(fields[1].empty());
+    CHECK(reader.recordLine() == 5);
+
+    CHECK(reader.next(fields) == false);
+}
+
+DROGON_TEST(CsvReaderLastLineWithoutNewline) {
+    std::istringstream in("x,y");
+    CsvReader reader(in);
+    std::vector<std::string> fields;
+    REQUIRE(reader.next(fields));
+    CHECK(fields.size() == 2);
+    CHECK(fields[1] == "y");
+    CHECK(reader.next(fields) == false);
+}
@@ -0,0 +1,132 @@
+#include <drogon/drogon_test.h>
+#include <string>
+#include "models/ModelFieldRules.h"
+#include "models/Products.h"
+#include "models/PurchaseOrder.h"
+#include "models/Supplier.h"
+#include "models/Warehouse.h"
+
+using namespace drogon_model::sqlite3;
+
+namespace {
+template <typename Model, size_t N>
+bool matchesColumns(const std::array<FieldRule, N>& rules) {
+    if (Model::getColumnNumber() != N) {
+        return false;
+    }
+    for (size_t i = 0; i < N; ++i) {
+        if (Model::getColumnName(i) != rules[i].name ||
+            rules[i].nameHash != fieldNameHash(rules[i].name)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Json::Value validProduct() {
+    Json::Value product;
+    product["sku"] = "WID-001";
+    product["name"] = "Widget";
+    product["unit_price"] = 9.99;
+    product["quantity_in_stock"] = 10;
+    product["reorder_threshold"] = 2;
+    return product;
+}
+}  // namespace
+
+// Regenerate models/ModelFieldRules.h if a model changes and this fails
+DROGON_TEST(FieldRulesMatchModels) {
+    CHECK(matchesColumns<Products>(kProductsFieldRules));
+    CHECK(matchesColumns<Supplier>(kSupplierFieldRules));
+    CHECK(matchesColumns<Warehouse>(kWarehouseFieldRules));
+    CHECK(matchesColumns<PurchaseOrder>(kPurchaseOrderFieldRules));
+}
+
+DROGON_TEST(FieldValidatorCreate) {
+    std::string error;
+    auto product = validProduct();
+    CHECK(validateFields(kProductsFieldRules, product, FieldCheck::Create, error));
+
+    // An auto column may be given but is still checked
+    product["product_id"] = 0;
+    CHECK(!validateFields(kProductsFieldRules, product, FieldCheck::Create, error));
+    CHECK(error == "product_id must be at least 1");
+
+    product = validProduct();
+    product.removeMember("name");
+    CHECK(!validateFields(kProductsFieldRules, product, FieldCheck::Create, error));
+    CHECK(error == "Missing required field: name");
+
+    product = validProduct();
+    product["sku"] = Json::nullValue;
+    CHECK(!validateFields(kProductsFieldRules, product, FieldCheck::Create, error));
+    CHECK(error == "The sku column cannot be null");
+
+    product = validProduct();
+    product["quantity_in_stock"] = "10";
+    CHECK(!validateFields(kProductsFieldRules, product, FieldCheck::Create, error));
+    CHECK(error == "Type error in the quantity_in_stock field");
+
+    CHECK(!validateFields(kProductsFieldRules, Json::Value(Json::arrayValue), FieldCheck::Create,
+                          error));
+    CHECK(error == "Body must be a JSON object");
+}
+
+DROGON_TEST(FieldValidatorValues) {
+    std::string error;
+    auto product = validProduct();
+    product["unit_price"] = 1.005;
+    CHECK(!validateFields(kProductsFieldRules, product, FieldCheck::Create, error));
+    CHECK(error == "unit_price must have at most 2 decimal places");
+
+    product["unit_price"] = -1;
+    CHECK(!validateFields(kProductsFieldRules, product, FieldCheck::Create, error));
+    CHECK(error == "unit_price must be between 0.01 and 999999.99");
+
+    product = validProduct();
+    product["sku"] = "";
+    CHECK(!validateFields(kProductsFieldRules, product, FieldCheck::Create, error));
+    CHECK(error == "sku must be 1 to 50 characters long");
+
+    product = validProduct();
+    product["description"] = "line one\nline two";
+    CHECK(validateFields(kProductsFieldRules, product, FieldCheck::Create, error));
+    product["description"] = std::string("bell\a");
+    CHECK(!validateFields(kProductsFieldRules, product, FieldCheck::Create, error));
+    CHECK(error == "description must not contain control characters");
+}
+
+DROGON_TEST(FieldValidatorUpdate) {
+    std::string error;
+    Json::Value fields;
+    fields["unit_price"] = 4.5;
+    CHECK(validateFields(kProductsFieldRules, fields, FieldCheck::Update, error));
+
+    // Unknown fields are skipped unless the caller rejects them
+    fields["colour"] = "red";
+    CHECK(validateFields(kProductsFieldRules, fields, FieldCheck::Update, error));
+    CHECK(!validateFields(kProductsFieldRules, fields, FieldCheck::Update, error,
+                          UnknownFields::Reject));
+    CHECK(error == "Unknown field 'colour'");
+
+    // The key alone, or only unknown fields, is not an update
+    Json::Value keyOnly;
+    keyOnly["product_id"] = 5;
+    CHECK(!validateFields(kProductsFieldRules, keyOnly, FieldCheck::Update, error));
+    CHECK(error == "At least one field must be provided for update");
+    Json::Value unknownOnly;
+    unknownOnly["colour"] = "red";
+    CHECK(!validateFields(kProductsFieldRules, unknownOnly, FieldCheck::Update, error));
+
+    // The timestamps are maintained by the server, on create and on update
+    Json::Value touched;
+    touched["unit_price"] = 4.5;
+    touched["updated_at"] = "2020-01-01 00:00:00";
+    CHECK(!validateFields(kProductsFieldRules, touched, FieldCheck::Update, error,
+                          UnknownFields::Reject));
+    CHECK(error == "updated_at is set by the server");
+    auto product = validProduct();
+    product["created_at"] = "2020-01-01 00:00:00";
+    CHECK(!validateFields(kProductsFieldRules, product, FieldCheck::Create, error));
+    CHECK(error == "created_at is set by the server");
+}
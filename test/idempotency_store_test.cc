@@ -0,0 +1,35 @@
+#include <drogon/drogon_test.h>
+#include "plugins/IdempotencyStore.h"
+
+using namespace drogon;
+
+namespace {
+HttpRequestPtr makeRequest(HttpMethod method, const std::string& path, const std::string& body) {
+    auto req = HttpRequest::newHttpRequest();
+    req->setMethod(method);
+    req->setPath(path);
+    req->setBody(body);
+    return req;
+}
+}  // namespace
+
+DROGON_TEST(IdempotencyFingerprint) {
+    const auto base = IdempotencyStore::fingerprint(
+        makeRequest(Post, "/api/products/1/adjust", R"({"delta":-2})"));
+    CHECK(base == IdempotencyStore::fingerprint(
+                      makeRequest(Post, "/api/products/1/adjust", R"({"delta":-2})")));
+
+    // Any difference in method, path or body is a different request
+    CHECK(base != IdempotencyStore::fingerprint(
+                      makeRequest(Post, "/api/products/1/adjust", R"({"delta":-3})")));
+    CHECK(base != IdempotencyStore::fingerprint(
+                      makeRequest(Post, "/api/products/2/adjust", R"({"delta":-2})")));
+    CHECK(base != IdempotencyStore::fingerprint(
+                      makeRequest(Put, "/api/products/1/adjust", R"({"delta":-2})")));
+
+    // Stored in idempotency_keys, so the body hash must not depend on the build
+    CHECK(IdempotencyStore::fingerprint(makeRequest(Post, "/api/products", "")) ==
+          "POST /api/products cbf29ce484222325");
+    CHECK(IdempotencyStore::fingerprint(makeRequest(Post, "/api/products", "a")) ==
+          "POST /api/products af63dc4c8601ec8c");
+}
@@ -0,0 +1,111 @@
+#include <drogon/drogon_test.h>
+#include <cstdint>
+#include <random>
+#include <string>
+#include "utils/jsonprescan.h"
+
+namespace {
+bool passes(const std::string& body, JsonScanLevel level = JsonScanLevel::Best) {
+    JsonPrescan result;
+    JsonPrescanOptions options;
+    options.level = level;
+    return prescanJson(body, result, options);
+}
+
+std::string refusal(const std::string& body) {
+    JsonPrescan result;
+    prescanJson(body, result);
+    return result.error;
+}
+}  // namespace
+
+DROGON_TEST(JsonPrescanAcceptsJson) {
+    CHECK(passes(R"({"sku": "A-1", "tags": ["x", {"y": [1, 2.5e3, null]}], "ok": true})"));
+    CHECK(passes("{\n\t\"name\": \"caf\xC3\xA9 \xE2\x82\xAC \xF0\x9F\x93\xA6\"\r\n}"));
+    CHECK(passes(R"({"text": "brackets } ] in a string, and \"quotes\" \\ é"})"));
+    CHECK(passes("[]"));
+    CHECK(passes("42"));
+
+    JsonPrescan result;
+    CHECK(prescanJson("[[[]], {}]", result));
+    CHECK(result.depth == 3);
+    CHECK(result.structurals.empty());
+}
+
+DROGON_TEST(JsonPrescanRefusesBadBodies) {
+    CHECK(refusal("{\"a\": [1, 2}") == "Unbalanced brackets");
+    CHECK(refusal("{\"a\": 1}}") == "Unbalanced brackets");
+    CHECK(refusal("[[1]") == "Unbalanced brackets");
+    CHECK(refusal("{\"a\": \"open") == "Unterminated string");
+    CHECK(refusal("{\"a\": \"tab\there\"}") == "Control character in string");
+    CHECK(refusal(std::string("{\"a\": 1,\x01}")) == "Control character outside a string");
+    CHECK(refusal(R"({"a": "\q"})") == "Invalid escape");
+    // Truncated, overlong, surrogate and stray continuation bytes
+    CHECK(refusal("[\"\xC3\"]") == "Invalid UTF-8");
+    CHECK(refusal("[\"\xC0\xAF\"]") == "Invalid UTF-8");
+    CHECK(refusal("[\"\xED\xA0\x80\"]") == "Invalid UTF-8");
+    CHECK(refusal("[\"\x80\"]") == "Invalid UTF-8");
+
+    JsonPrescan result;
+    CHECK(!prescanJson(std::string(kMaxJsonDepth + 1, '['), result));
+    CHECK(result.error == "Nesting deeper than 64");
+    CHECK(result.errorOffset == kMaxJsonDepth);
+}
+
+DROGON_TEST(JsonPrescanStructuralIndex) {
+    const std::string body = R"( [{"a": "x,y"}, 2, [3, 4]] )";
+    JsonPrescanOptions options;
+    options.buildIndex = true;
+    JsonPrescan result;
+    REQUIRE(prescanJson(body, result, options));
+    std::string structure;
+    for (const auto offset : result.structurals) {
+        structure += body[offset];
+    }
+    CHECK(structure == "[{:},,[,]]");
+    CHECK(topLevelElementCount(body, result.structurals) == 3);
+
+    REQUIRE(prescanJson(" [ ] ", result, options));
+    CHECK(topLevelElementCount(" [ ] ", result.structurals) == 0);
+    REQUIRE(prescanJson("[[]]", result, options));
+    CHECK(topLevelElementCount("[[]]", result.structurals) == 1);
+    REQUIRE(prescanJson("\"x\"", result, options));
+    CHECK(topLevelElementCount("\"x\"", result.structurals) == 0);
+}
+
+DROGON_TEST(JsonPrescanLevelsAgree) {
+    // Random bodies over the bytes that matter, long enough to cross block boundaries
+    const std::string alphabet = "{}[],:\"\\ a1\n\x01\xC3\xA9\xE2\x82\xAC\xFF";
+    std::mt19937 rng(7);
+    JsonPrescanOptions options;
+    options.buildIndex = true;
+    for (int round = 0; round < 2000; ++round) {
+        std::string body;
+        const size_t length = rng() % 200;
+        for (size_t i = 0; i < length; ++i) {
+            body += alphabet[rng() % alphabet.size()];
+        }
+        JsonPrescan results[3];
+        const JsonScanLevel levels[3] = {JsonScanLevel::Best, JsonScanLevel::Sse2,
+                                         JsonScanLevel::Scalar};
+        for (int i = 0; i < 3; ++i) {
+            options.level = levels[i];
+            prescanJson(body, results[i], options);
+        }
+        for (int i = 1; i < 3; ++i) {
+            CHECK(results[i].error == results[0].error);
+            CHECK(results[i].errorOffset == results[0].errorOffset);
+            CHECK(results[i].structurals == results[0].structurals);
+        }
+    }
+    // Well-formed bodies too, which get past the first few bytes
+    const std::string product = R"({"sku": "S-1", "name": "café \"x\"", "tags": [1, 2]})";
+    std::string array = "[";
+    for (int i = 0; i < 50; ++i) {
+        array += (i ? ", " : "") + product;
+    }
+    array += "]";
+    CHECK(passes(array, JsonScanLevel::Best));
+    CHECK(passes(array, JsonScanLevel::Sse2));
+    CHECK(passes(array, JsonScanLevel::Scalar));
+}
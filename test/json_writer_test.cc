@@ -0,0 +1,93 @@
+#include <drogon/drogon_test.h>
+#include <json/json.h>
+#include "models/ModelJsonWriters.h"
+#include "utils/jsonwriter.h"
+#include "utils/projection.h"
+
+using namespace drogon_model::sqlite3;
+
+namespace {
+std::string drogonJson(const Json::Value& value) {
+    Json::StreamWriterBuilder builder;
+    builder["commentStyle"] = "None";
+    builder["indentation"] = "";
+    builder["emitUTF8"] = true;
+    return Json::writeString(builder, value);
+}
+}  // namespace
+
+DROGON_TEST(JsonWriterPrimitives) {
+    std::string out;
+    appendJsonString(out, std::string("q\"b\\s\n\x01\xC3\xA9", 9));
+    CHECK(out == "\"q\\\"b\\\\s\\n\\u0001\xC3\xA9\"");
+
+    out.clear();
+    appendJsonDouble(out, 5);
+    CHECK(out == "5.0");
+    out.clear();
+    appendJsonDouble(out, 999.99);
+    CHECK(out == drogonJson(Json::Value(999.99)));
+}
+
+DROGON_TEST(JsonWriterMatchesToJson) {
+    Products empty;
+    std::string out;
+    appendJson(out, empty);
+    CHECK(out == drogonJson(empty.toJson()));
+
+    Products product;
+    product.setProductId(7);
+    product.setSku("SKU-7");
+    product.setName("Tab\tand \"quotes\"");
+    product.setUnitPrice(19.95);
+    product.setQuantityInStock(3);
+    product.setReorderThreshold(10);
+    product.setCreatedAt(trantor::Date::now());
+    out.clear();
+    appendJson(out, product);
+    CHECK(out == drogonJson(product.toJson()));
+
+    std::vector<Products> page{empty, product};
+    Json::Value array(Json::arrayValue);
+    array.append(empty.toJson());
+    array.append(product.toJson());
+    out.clear();
+    appendJsonArray(out, page);
+    CHECK(out == drogonJson(array));
+
+    Supplier supplier;
+    supplier.setSupplierId(1);
+    supplier.setName("ACME");
+    out.clear();
+    appendJson(out, supplier);
+    CHECK(out == drogonJson(supplier.toJson()));
+}
+
+DROGON_TEST(JsonWriterProjection) {
+    uint64_t mask = 0;
+    std::string error;
+    CHECK(parseFieldMask<Products>("", mask, error));
+    CHECK(mask == allColumnsMask<Products>());
+    CHECK(parseFieldMask<Products>("sku, name,quantity_in_stock", mask, error));
+    CHECK(projectionSelectList<Products>(mask) == "sku,name,quantity_in_stock");
+    CHECK(!parseFieldMask<Products>("sku,password", mask, error));
+    CHECK(error.find("password") != std::string::npos);
+    CHECK(!parseFieldMask<Products>(" , ", mask, error));
+    CHECK(parseFieldMask<Products>("quantity_in_stock", mask, error));
+    CHECK(columnMask<Products>(Products::Cols::_quantity_in_stock) == mask);
+    CHECK(columnMask<Products>("password") == 0);
+
+    Products product;
+    product.setProductId(7);
+    product.setSku("SKU-7");
+    product.setName("Widget");
+    product.setQuantityInStock(3);
+    CHECK(parseFieldMask<Products>("quantity_in_stock,sku,name", mask, error));
+    std::string out;
+    appendJson(out, product, mask);
+    CHECK(out == "{\"name\":\"Widget\",\"quantity_in_stock\":3,\"sku\":\"SKU-7\"}");
+
+    out.clear();
+    appendJson(out, product, allColumnsMask<Products>());
+    CHECK(out == drogonJson(product.toJson()));
+}
@@ -0,0 +1,95 @@
+#include <drogon/drogon_test.h>
+#include "plugins/LowStockIndex.h"
+
+using drogon_model::sqlite3::Products;
+
+namespace {
+Products makeProduct(int64_t id, int64_t quantity, int64_t threshold) {
+    Products product;
+    product.setProductId(id);
+    product.setSku("SKU-" + std::to_string(id));
+    product.setName("Product " + std::to_string(id));
+    product.setQuantityInStock(quantity);
+    product.setReorderThreshold(threshold);
+    return product;
+}
+}  // namespace
+
+DROGON_TEST(LowStockIndexOrdersByGap) {
+    LowStockIndex index;
+    index.update(makeProduct(1, 50, 10));  // well stocked, not tracked
+    index.update(makeProduct(2, 5, 20));   // gap -15
+    index.update(makeProduct(3, 10, 10));  // gap 0
+    index.update(makeProduct(4, 0, 30));   // gap -30
+    CHECK(index.size() == 3);
+
+    auto entries = index.lowest(10);
+    REQUIRE(entries.size() == 3);
+    CHECK(entries[0].productId == 4);
+    CHECK(entries[1].productId == 2);
+    CHECK(entries[2].productId == 3);
+    CHECK(index.lowest(1).size() == 1);
+}
+
+DROGON_TEST(LowStockIndexTracksWrites) {
+    LowStockIndex index;
+    index.update(makeProduct(1, 5, 20));
+    index.update(makeProduct(2, 1, 20));
+    CHECK(index.lowest(1)[0].productId == 2);
+
+    index.update(makeProduct(2, 100, 20));  // restocked
+    CHECK(index.size() == 1);
+    CHECK(index.lowest(1)[0].productId == 1);
+
+    index.update(makeProduct(1, 0, 20));  // sold out, still tracked once
+    CHECK(index.size() == 1);
+    CHECK(index.lowest(1)[0].quantityInStock == 0);
+
+    index.remove(1);
+    CHECK(index.size() == 0);
+}
+
+DROGON_TEST(LowStockIndexFollowsTrackedStock) {
+    LowStockIndex index;
+    index.track(makeProduct(1, 50, 10));
+    index.update(makeProduct(2, 50, 10));
+    CHECK(index.size() == 0);
+
+    // Buffered adjustments move a tracked product without a row
+    index.updateStock(1, 8);
+    index.updateStock(2, 8);
+    REQUIRE(index.size() == 1);
+    CHECK(index.lowest(1)[0].productId == 1);
+    CHECK(index.lowest(1)[0].quantityInStock == 8);
+    CHECK(index.lowest(1)[0].sku == "SKU-1");
+
+    index.updateStock(1, 30);
+    CHECK(index.size() == 0);
+    index.updateStock(1, 2);
+    CHECK(index.size() == 1);
+
+    index.remove(1);
+    index.updateStock(1, 0);
+    CHECK(index.size() == 0);
+}
+
+DROGON_TEST(LowStockIndexIgnoresOlderRows) {
+    LowStockIndex index;
+    index.update(makeProduct(1, 2, 10), 5);
+    // A flush that read version 4 reports after the write that made version 5
+    index.update(makeProduct(1, 40, 10), 4);
+    REQUIRE(index.size() == 1);
+    CHECK(index.lowest(1)[0].quantityInStock == 2);
+
+    // Inserts carry no version and always apply
+    index.update(makeProduct(2, 1, 10));
+    CHECK(index.size() == 2);
+
+    index.update(makeProduct(1, 40, 10), 6);
+    CHECK(index.size() == 1);
+
+    // A re-created product starts over
+    index.remove(1);
+    index.update(makeProduct(1, 3, 10), 1);
+    CHECK(index.size() == 2);
+}
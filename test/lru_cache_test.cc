@@ -0,0 +1,30 @@
+#include <drogon/drogon_test.h>
+#include <string>
+#include "utils/shardedlrucache.h"
+
+DROGON_TEST(LruCacheEvictsLeastRecentlyUsed) {
+    ShardedLruCache<int64_t, std::string> cache(2, std::chrono::milliseconds(0), 1);
+    cache.insert(1, "one");
+    cache.insert(2, "two");
+    std::string value;
+    CHECK(cache.find(1, value));  // 1 becomes most recent
+    cache.insert(3, "three");     // evicts 2
+    CHECK(cache.find(2, value) == false);
+    CHECK(cache.find(1, value));
+    CHECK(value == "one");
+    CHECK(cache.stats().evictions == 1);
+}
+
+DROGON_TEST(LruCacheDropsStaleFill) {
+    ShardedLruCache<int64_t, std::string> cache(16, std::chrono::milliseconds(0), 4);
+    auto token = cache.fillToken(7);
+    cache.erase(7);  // a write lands while the read is in flight
+    CHECK(cache.insert(7, "stale", token) == false);
+    std::string value;
+    CHECK(cache.find(7, value) == false);
+
+    token = cache.fillToken(7);
+    CHECK(cache.insert(7, "fresh", token));
+    CHECK(cache.find(7, value));
+    CHECK(value == "fresh");
+}
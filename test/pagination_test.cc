@@ -0,0 +1,51 @@
+#include <drogon/drogon_test.h>
+#include "utils/pagination.h"
+
+DROGON_TEST(PaginationLimit) {
+    size_t limit = 0;
+    std::string error;
+    CHECK(parsePageLimit("", limit, error));
+    CHECK(limit == kDefaultPageLimit);
+    CHECK(parsePageLimit("25", limit, error));
+    CHECK(limit == 25);
+    CHECK(parsePageLimit("0", limit, error) == false);
+    CHECK(parsePageLimit("-5", limit, error) == false);
+    CHECK(parsePageLimit("abc", limit, error) == false);
+    CHECK(parsePageLimit(std::to_string(kMaxPageLimit + 1), limit, error) == false);
+}
+
+DROGON_TEST(PaginationCursorRoundTrip) {
+    std::string error;
+    int64_t id = -1;
+    CHECK(decodeProductCursor("", id, error));
+    CHECK(id == 0);
+
+    for (int64_t value : {int64_t{1}, int64_t{42}, int64_t{9007199254740993}}) {
+        const auto token = encodeProductCursor(value);
+        CHECK(token.find('=') == std::string::npos);
+        CHECK(decodeProductCursor(token, id, error));
+        CHECK(id == value);
+    }
+
+    CHECK(decodeProductCursor("not-a-cursor", id, error) == false);
+}
+
+DROGON_TEST(PaginationFilterParameters) {
+    std::string error;
+    int64_t value = -1;
+    bool present = true;
+    CHECK(parseIntParameter("", "supplier_id", value, present, error));
+    CHECK(present == false);
+    CHECK(parseIntParameter("12", "supplier_id", value, present, error));
+    CHECK(present);
+    CHECK(value == 12);
+    CHECK(parseIntParameter("-1", "min_qty", value, present, error) == false);
+    CHECK(error.find("min_qty") != std::string::npos);
+
+    bool flag = true;
+    CHECK(parseBoolParameter("", "below_reorder", flag, error));
+    CHECK(flag == false);
+    CHECK(parseBoolParameter("true", "below_reorder", flag, error));
+    CHECK(flag);
+    CHECK(parseBoolParameter("yes", "below_reorder", flag, error) == false);
+}
@@ -0,0 +1,70 @@
+#include <drogon/drogon_test.h>
+#include <drogon/HttpRequest.h>
+#include <string>
+#include "utils/jsonprescan.h"
+#include "utils/requestjson.h"
+
+DROGON_TEST(ParseJsonBody) {
+    auto json = parseJsonBody(R"({"sku": "A-1", "quantity_in_stock": 5})");
+    REQUIRE(json != nullptr);
+    CHECK((*json)["sku"].asString() == "A-1");
+    CHECK((*json)["quantity_in_stock"].asInt() == 5);
+
+    std::string error;
+    CHECK(parseJsonBody("{\"sku\": ", &error) == nullptr);
+    CHECK(!error.empty());
+
+    // Refused by the prescan, before jsoncpp sees it
+    CHECK(parseJsonBody(std::string(100, '[') + std::string(100, ']'), &error) == nullptr);
+    CHECK(error == "Nesting deeper than 64 at byte 64");
+}
+
+DROGON_TEST(ParseJsonBodyReusesPrescan) {
+    const std::string body = R"([{"sku": "A-1"}, {"sku": "A-2"}])";
+    JsonPrescanOptions options;
+    options.buildIndex = true;
+    JsonPrescan prescan;
+    REQUIRE(prescanJson(body, prescan, options));
+    auto json = parseJsonBody(body, nullptr, &prescan);
+    REQUIRE(json != nullptr);
+    CHECK(json->size() == 2);
+
+    // A refusal is reported from the result passed in, without scanning the body again
+    JsonPrescan refused;
+    refused.error = "Unbalanced brackets";
+    refused.errorOffset = 7;
+    std::string error;
+    CHECK(parseJsonBody(body, &error, &refused) == nullptr);
+    CHECK(error == "Unbalanced brackets at byte 7");
+}
+
+DROGON_TEST(RequestBodyParsedOnce) {
+    auto req = drogon::HttpRequest::newHttpRequest();
+    req->setMethod(drogon::Post);
+    req->setContentTypeCode(drogon::CT_APPLICATION_JSON);
+    req->setBody(R"({"delta": -3})");
+
+    const auto parsed = parseRequestBody(req);
+    REQUIRE(parsed != nullptr);
+    CHECK((*parsed)["delta"].asInt() == -3);
+    // Every later stage gets the same document back
+    CHECK(parseRequestBody(req) == parsed);
+    CHECK(requestJson(req) == parsed);
+
+    // A body that is not JSON is remembered as such
+    auto bad = drogon::HttpRequest::newHttpRequest();
+    bad->setBody("not json");
+    CHECK(parseRequestBody(bad) == nullptr);
+    CHECK(requestJson(bad) == nullptr);
+}
+
+DROGON_TEST(RequestJsonWithoutParseStage) {
+    // Requests that skipped the pre-routing parse fall back to drogon's own
+    auto req = drogon::HttpRequest::newHttpRequest();
+    req->setMethod(drogon::Post);
+    req->setContentTypeCode(drogon::CT_APPLICATION_JSON);
+    req->setBody(R"({"delta": 4})");
+    const auto json = requestJson(req);
+    REQUIRE(json != nullptr);
+    CHECK((*json)["delta"].asInt() == 4);
+}
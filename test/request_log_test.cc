@@ -0,0 +1,133 @@
+#include <drogon/drogon_test.h>
+#include <drogon/HttpRequest.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "plugins/RequestLog.h"
+
+namespace {
+std::string tempLogPath(const std::string& name) {
+    const std::string path = "request_log_test_" + name + ".log";
+    std::remove(path.c_str());
+    return path;
+}
+
+Json::Value logConfig(const std::string& path) {
+    Json::Value config;
+    config["log_path"] = path;
+    config["capacity"] = 16;
+    // Records are written by the explicit flush() calls below
+    config["flush_interval_ms"] = 3600000;
+    return config;
+}
+
+std::vector<std::string> readLines(const std::string& path) {
+    std::ifstream in(path);
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(in, line);) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+drogon::HttpRequestPtr makeRequest(const std::string& path, const std::string& body) {
+    auto req = drogon::HttpRequest::newHttpRequest();
+    req->setMethod(drogon::Post);
+    req->setPath(path);
+    req->setBody(body);
+    return req;
+}
+}  // namespace
+
+DROGON_TEST(RequestLogWritesJsonLines) {
+    const auto path = tempLogPath("lines");
+    RequestLog log;
+    log.initAndStart(logConfig(path));
+
+    const auto req = makeRequest("/api/products", R"({"sku": "A-1"})");
+    log.write(RequestLogLevel::Info, RequestLogEvent::Passed, req, RouteKind::Collection, 0);
+    log.write(RequestLogLevel::Warn, RequestLogEvent::Rejected, req, RouteKind::Collection, 400,
+              "Missing required field: \"name\"");
+    log.flush();
+
+    const auto lines = readLines(path);
+    REQUIRE(lines.size() == 2);
+    Json::Value first;
+    Json::Value second;
+    Json::Reader reader;
+    REQUIRE(reader.parse(lines[0], first));
+    REQUIRE(reader.parse(lines[1], second));
+    CHECK(first["level"].asString() == "info");
+    CHECK(first["event"].asString() == "passed");
+    CHECK(first["method"].asString() == "POST");
+    CHECK(first["route"].asString() == "collection");
+    CHECK(first["path"].asString() == "/api/products");
+    CHECK(first["body_bytes"].asUInt() == 14);
+    // Bodies are opt-in
+    CHECK(!first.isMember("body"));
+    CHECK(!first.isMember("status"));
+    CHECK(second["status"].asInt() == 400);
+    CHECK(second["message"].asString() == "Missing required field: \"name\"");
+
+    log.shutdown();
+    std::remove(path.c_str());
+}
+
+DROGON_TEST(RequestLogSamplesPerRoute) {
+    const auto path = tempLogPath("sampling");
+    auto config = logConfig(path);
+    config["sample_every"]["item"] = 4;
+    RequestLog log;
+    log.initAndStart(config);
+
+    const auto item = makeRequest("/api/products/7", "{}");
+    const auto collection = makeRequest("/api/products", "{}");
+    for (int i = 0; i < 8; ++i) {
+        log.write(RequestLogLevel::Info, RequestLogEvent::Passed, item, RouteKind::Item, 0);
+    }
+    log.write(RequestLogLevel::Info, RequestLogEvent::Passed, collection,
+              RouteKind::Collection, 0);
+    // Rejections are kept whatever the sampling
+    log.write(RequestLogLevel::Warn, RequestLogEvent::Rejected, item, RouteKind::Item, 400,
+              "Invalid ID");
+    log.flush();
+
+    CHECK(readLines(path).size() == 4);
+    const auto stats = log.stats();
+    CHECK(stats["written"].asUInt64() == 4);
+    CHECK(stats["sampled_out"].asUInt64() == 6);
+    log.shutdown();
+    std::remove(path.c_str());
+}
+
+DROGON_TEST(RequestLogTruncatesBodiesAndDropsWhenFull) {
+    const auto path = tempLogPath("bodies");
+    auto config = logConfig(path);
+    config["body_bytes"] = 9;
+    RequestLog log;
+    log.initAndStart(config);
+
+    // The cut falls inside the two-byte "é", which is left out whole
+    const auto req = makeRequest("/api/products", "{\"n\":\"ab\xC3\xA9\"}");
+    for (int i = 0; i < 20; ++i) {
+        log.write(RequestLogLevel::Info, RequestLogEvent::Passed, req, RouteKind::Collection, 0);
+    }
+    log.flush();
+
+    const auto lines = readLines(path);
+    REQUIRE(lines.size() == 16);
+    Json::Value record;
+    Json::Reader reader;
+    REQUIRE(reader.parse(lines[0], record));
+    CHECK(record["body"].asString() == "{\"n\":\"ab");
+    CHECK(record["body_bytes"].asUInt() == 12);
+    CHECK(log.stats()["dropped"].asUInt64() == 4);
+
+    // Flushing frees the ring for the next records
+    log.write(RequestLogLevel::Info, RequestLogEvent::Passed, req, RouteKind::Collection, 0);
+    log.flush();
+    CHECK(readLines(path).size() == 17);
+    log.shutdown();
+    std::remove(path.c_str());
+}
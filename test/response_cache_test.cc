@@ -0,0 +1,110 @@
+#include <drogon/drogon_test.h>
+#include <string>
+#include <utility>
+#include <vector>
+#include "plugins/ResponseCache.h"
+
+using namespace drogon;
+
+namespace {
+HttpRequestPtr makeRequest(const std::string& path,
+                           const std::vector<std::pair<std::string, std::string>>& params) {
+    auto req = HttpRequest::newHttpRequest();
+    req->setPath(path);
+    for (const auto& [name, value] : params) {
+        req->setParameter(name, value);
+    }
+    return req;
+}
+}  // namespace
+
+DROGON_TEST(ResponseCacheKeyEscapesParameters) {
+    // ?category=a%26limit%3D5 arrives decoded as one parameter
+    const auto smuggled =
+        ResponseCache::cacheKey(makeRequest("/api/products", {{"category", "a&limit=5"}}));
+    const auto split =
+        ResponseCache::cacheKey(makeRequest("/api/products", {{"category", "a"}, {"limit", "5"}}));
+    CHECK(smuggled != split);
+    CHECK(split == "/api/products?category=a&limit=5");
+    CHECK(smuggled == "/api/products?category=a%26limit%3D5");
+    // An escape in the input is escaped again rather than taken as one
+    CHECK(ResponseCache::cacheKey(makeRequest("/api/products", {{"category", "a%26limit%3D5"}})) ==
+          "/api/products?category=a%2526limit%253D5");
+}
+
+DROGON_TEST(ResponseCacheKeyIgnoresParameterOrder) {
+    auto first = makeRequest("/api/products", {{"limit", "5"}, {"category", "Tools"}});
+    auto second = makeRequest("/api/products", {{"category", "Tools"}, {"limit", "5"}});
+    CHECK(ResponseCache::cacheKey(first) == ResponseCache::cacheKey(second));
+    CHECK(ResponseCache::cacheKey(first) !=
+          ResponseCache::cacheKey(makeRequest("/api/products", {{"category", "Tools"}})));
+}
+
+DROGON_TEST(ResponseCacheEtagMatches) {
+    const std::string etag = "\"e-1-00ff\"";
+    CHECK(ResponseCache::etagMatches(etag, etag, false));
+    CHECK(!ResponseCache::etagMatches("", etag, true));
+    CHECK(!ResponseCache::etagMatches("\"e-2-00ff\"", etag, true));
+
+    // "*" only matches once the resource is known to exist
+    CHECK(!ResponseCache::etagMatches("*", etag, false));
+    CHECK(ResponseCache::etagMatches("*", etag, true));
+
+    // If-None-Match uses the weak comparison, and may list several tags
+    CHECK(ResponseCache::etagMatches("W/" + etag, etag, false));
+    CHECK(ResponseCache::etagMatches("\"other\", W/" + etag + " ,\"more\"", etag, false));
+    CHECK(ResponseCache::etagMatches("\"other\",\t" + etag, etag, false));
+    CHECK(!ResponseCache::etagMatches("\"other\", \"more\"", etag, false));
+}
+
+DROGON_TEST(ResponseCacheVersionBumpInvalidates) {
+    ResponseCache cache;
+    cache.initAndStart(Json::Value(Json::objectValue));
+    const std::string key = "/api/products?limit=5";
+    const uint64_t version = cache.productsVersion();
+
+    auto entry = std::make_shared<ResponseCache::Entry>();
+    entry->version = version;
+    entry->etag = cache.makeEtag(version, key);
+    entry->body = "[]";
+    cache.store(key, entry);
+
+    ResponseCache::EntryPtr found;
+    REQUIRE(cache.find(key, version, found));
+    CHECK(found->body == "[]");
+
+    // A write moves the version: the stored body and its ETag are both retired
+    cache.bumpProductsVersion();
+    const uint64_t bumped = cache.productsVersion();
+    CHECK(bumped == version + 1);
+    CHECK(!cache.find(key, bumped, found));
+    CHECK(cache.makeEtag(bumped, key) != entry->etag);
+    CHECK(!ResponseCache::etagMatches(entry->etag, cache.makeEtag(bumped, key), true));
+    CHECK(cache.stats()["stale_versions"].asUInt64() == 1);
+    cache.shutdown();
+}
+
+DROGON_TEST(ResponseCacheAcceptsCoding) {
+    CHECK(ResponseCache::acceptsCoding("gzip, deflate, br", "br"));
+    CHECK(ResponseCache::acceptsCoding("gzip, deflate, br", "gzip"));
+    CHECK(!ResponseCache::acceptsCoding("gzip, deflate", "br"));
+    CHECK(!ResponseCache::acceptsCoding("", "gzip"));
+
+    // Coding names are case-insensitive
+    CHECK(ResponseCache::acceptsCoding("GZIP", "gzip"));
+    CHECK(ResponseCache::acceptsCoding("Br;q=1", "br"));
+
+    // Only an explicit zero weight refuses
+    CHECK(!ResponseCache::acceptsCoding("gzip;q=0", "gzip"));
+    CHECK(!ResponseCache::acceptsCoding("gzip; q=0.000", "gzip"));
+    CHECK(!ResponseCache::acceptsCoding("br;Q=0, gzip", "br"));
+    CHECK(ResponseCache::acceptsCoding("gzip;q=0.5", "gzip"));
+    CHECK(ResponseCache::acceptsCoding("gzip;q=0.001", "gzip"));
+
+    // "*" covers codings that are not listed, and a listed one overrides it
+    CHECK(ResponseCache::acceptsCoding("*", "br"));
+    CHECK(ResponseCache::acceptsCoding("identity, *;q=0.5", "gzip"));
+    CHECK(!ResponseCache::acceptsCoding("*;q=0", "gzip"));
+    CHECK(!ResponseCache::acceptsCoding("*, br;q=0", "br"));
+    CHECK(ResponseCache::acceptsCoding("gzip, *;q=0", "gzip"));
+}
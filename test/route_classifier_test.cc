@@ -0,0 +1,59 @@
+#include <drogon/drogon_test.h>
+#include "utils/routeclassifier.h"
+
+DROGON_TEST(RouteClassifierResources) {
+    auto match = classifyRoute("/api/products");
+    CHECK(match.resource == ApiResource::Products);
+    CHECK(match.kind == RouteKind::Collection);
+    CHECK(classifyRoute("/api/products/").kind == RouteKind::Collection);
+    CHECK(classifyRoute("/api").kind == RouteKind::ApiIndex);
+    CHECK(classifyRoute("/api/cache/stats").kind == RouteKind::CacheStats);
+
+    match = classifyRoute("/api/purchase_orders/17/");
+    CHECK(match.resource == ApiResource::PurchaseOrders);
+    CHECK(match.kind == RouteKind::Item);
+    CHECK(match.idStatus == RouteIdStatus::Valid);
+    CHECK(match.id == 17);
+    CHECK(classifyRoute("/api/suppliers/3").resource == ApiResource::Suppliers);
+    CHECK(classifyRoute("/api/warehouses").resource == ApiResource::Warehouses);
+
+    CHECK(classifyRoute("/api/suppliers/3/adjust").kind == RouteKind::Unknown);
+    CHECK(classifyRoute("/api/customers").kind == RouteKind::Unknown);
+    CHECK(classifyRoute("/health").kind == RouteKind::Unknown);
+    CHECK(classifyRoute("/apix/products").kind == RouteKind::Unknown);
+}
+
+DROGON_TEST(RouteClassifierProductRoutes) {
+    CHECK(classifyRoute("/api/products:batchGet").kind == RouteKind::ProductBatchGet);
+    CHECK(classifyRoute("/api/products/bulk").kind == RouteKind::ProductBulk);
+    CHECK(classifyRoute("/api/products/by-sku").kind == RouteKind::ProductBySku);
+    CHECK(classifyRoute("/api/products/adjust").kind == RouteKind::ProductAdjustBatch);
+    CHECK(classifyRoute("/api/products/export").kind == RouteKind::ProductExport);
+    CHECK(classifyRoute("/api/products/low-stock").kind == RouteKind::ProductLowStock);
+
+    auto match = classifyRoute("/api/products/42/adjust");
+    CHECK(match.kind == RouteKind::ProductAdjust);
+    CHECK(match.id == 42);
+    CHECK(classifyRoute("/api/products/42/availability").kind ==
+          RouteKind::ProductAvailability);
+    CHECK(classifyRoute("/api/products/42/reservations").kind == RouteKind::ProductReserve);
+
+    match = classifyRoute("/api/products/reservations/9/commit");
+    CHECK(match.kind == RouteKind::ReservationCommit);
+    CHECK(match.id == 9);
+    CHECK(classifyRoute("/api/products/reservations/9").kind == RouteKind::Reservation);
+    CHECK(classifyRoute("/api/products/reservations").kind == RouteKind::Unknown);
+    CHECK(classifyRoute("/api/products/42/delete").kind == RouteKind::Unknown);
+    CHECK(classifyRoute("/api/products/abc").kind == RouteKind::Unknown);
+}
+
+DROGON_TEST(RouteClassifierIds) {
+    CHECK(classifyRoute("/api/products/0").idStatus == RouteIdStatus::Malformed);
+    CHECK(classifyRoute("/api/products/007").idStatus == RouteIdStatus::Malformed);
+    auto match = classifyRoute("/api/products/9223372036854775807");
+    CHECK(match.idStatus == RouteIdStatus::Valid);
+    CHECK(match.id == 9223372036854775807LL);
+    CHECK(classifyRoute("/api/products/9223372036854775808").idStatus ==
+          RouteIdStatus::OutOfRange);
+    CHECK(classifyRoute("/api/products").idStatus == RouteIdStatus::None);
+}
@@ -0,0 +1,32 @@
+#include <drogon/drogon_test.h>
+#include "utils/rowversion.h"
+
+DROGON_TEST(RowEtagRoundTrip) {
+    const auto etag = makeRowEtag(42, 7);
+    CHECK(etag == "\"p42v7\"");
+
+    bool any = false;
+    std::vector<int64_t> versions;
+    CHECK(parseIfMatch(etag, 42, any, versions));
+    CHECK(any == false);
+    REQUIRE(versions.size() == 1);
+    CHECK(versions[0] == 7);
+
+    CHECK(parseIfMatch(" \"p42v7\" , \"p42v9\"", 42, any, versions));
+    CHECK(versions.size() == 2);
+}
+
+DROGON_TEST(RowEtagIfMatchRules) {
+    bool any = false;
+    std::vector<int64_t> versions;
+    CHECK(parseIfMatch("", 42, any, versions) == false);
+
+    CHECK(parseIfMatch("*", 42, any, versions));
+    CHECK(any);
+    CHECK(versions.empty());
+
+    // Weak tags, other products and foreign tags are preconditions that cannot match
+    CHECK(parseIfMatch("W/\"p42v7\", \"p4v7\", \"p42v\", \"p42vx\", \"abc\"", 42, any, versions));
+    CHECK(any == false);
+    CHECK(versions.empty());
+}
@@ -0,0 +1,192 @@
+#include <drogon/drogon_test.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include "plugins/StockDeltaBuffer.h"
+
+namespace {
+std::string tempJournalPath(const std::string& name) {
+    const std::string path = "stock_delta_buffer_test_" + name + ".journal";
+    std::remove(path.c_str());
+    std::remove((path + ".flushing").c_str());
+    return path;
+}
+
+void removeJournal(const std::string& path) {
+    std::remove(path.c_str());
+    std::remove((path + ".flushing").c_str());
+}
+
+bool fileExists(const std::string& path) {
+    return std::ifstream(path).good();
+}
+}  // namespace
+
+DROGON_TEST(StockDeltaBufferChecksStock) {
+    const auto path = tempJournalPath("check");
+    StockDeltaBuffer deltas;
+    REQUIRE(deltas.openJournal(path, 0));
+
+    int64_t quantity = 0;
+    CHECK(deltas.add(1, -1, quantity) == StockDeltaBuffer::Status::UnknownProduct);
+    deltas.prime(1, 10);
+    CHECK(deltas.add(1, -3, quantity) == StockDeltaBuffer::Status::Ok);
+    CHECK(quantity == 7);
+    CHECK(deltas.add(1, -8, quantity) == StockDeltaBuffer::Status::InsufficientStock);
+    CHECK(quantity == 7);
+    CHECK(deltas.add(1, 5, quantity) == StockDeltaBuffer::Status::Ok);
+    CHECK(quantity == 12);
+    CHECK(deltas.pending(1) == 2);
+    removeJournal(path);
+}
+
+DROGON_TEST(StockDeltaBufferReplaysJournal) {
+    const auto path = tempJournalPath("replay");
+    int64_t quantity = 0;
+    {
+        StockDeltaBuffer deltas;
+        REQUIRE(deltas.openJournal(path, 0));
+        deltas.prime(1, 10);
+        deltas.prime(2, 0);
+        REQUIRE(deltas.add(1, -3, quantity) == StockDeltaBuffer::Status::Ok);
+        REQUIRE(deltas.add(2, 4, quantity) == StockDeltaBuffer::Status::Ok);
+        REQUIRE(deltas.add(1, -1, quantity) == StockDeltaBuffer::Status::Ok);
+        // Crash: nothing was flushed
+    }
+    StockDeltaBuffer restarted;
+    REQUIRE(restarted.openJournal(path, 0));
+    CHECK(restarted.pending(1) == -4);
+    CHECK(restarted.pending(2) == 4);
+    // The replayed records are owed by the next flush, so they moved to .flushing
+    CHECK(fileExists(path + ".flushing"));
+
+    // Replayed counters still need their committed quantity before taking adds
+    CHECK(restarted.add(1, -1, quantity) == StockDeltaBuffer::Status::UnknownProduct);
+    removeJournal(path);
+}
+
+DROGON_TEST(StockDeltaBufferReplaysUncommittedFlush) {
+    const auto path = tempJournalPath("uncommitted");
+    int64_t quantity = 0;
+    {
+        StockDeltaBuffer deltas;
+        REQUIRE(deltas.openJournal(path, 0));
+        deltas.prime(1, 10);
+        deltas.prime(2, 0);
+        REQUIRE(deltas.add(1, -2, quantity) == StockDeltaBuffer::Status::Ok);
+        REQUIRE(deltas.add(2, 4, quantity) == StockDeltaBuffer::Status::Ok);
+        StockDeltaBuffer::FlushBatch batch;
+        REQUIRE(deltas.beginFlush(batch));
+        CHECK(batch.cut == 2);
+        CHECK(batch.deltas.size() == 2);
+        // Adds during the flush go to the fresh active journal
+        REQUIRE(deltas.add(1, -1, quantity) == StockDeltaBuffer::Status::Ok);
+        // Crash before the flush transaction committed
+    }
+    StockDeltaBuffer restarted;
+    REQUIRE(restarted.openJournal(path, 0));
+    CHECK(restarted.pending(1) == -3);
+    CHECK(restarted.pending(2) == 4);
+    removeJournal(path);
+}
+
+DROGON_TEST(StockDeltaBufferSkipsFlushedRecords) {
+    const auto path = tempJournalPath("flushed");
+    int64_t quantity = 0;
+    uint64_t cut = 0;
+    {
+        StockDeltaBuffer deltas;
+        REQUIRE(deltas.openJournal(path, 0));
+        deltas.prime(1, 10);
+        deltas.prime(2, 0);
+        REQUIRE(deltas.add(1, -2, quantity) == StockDeltaBuffer::Status::Ok);
+        REQUIRE(deltas.add(2, 4, quantity) == StockDeltaBuffer::Status::Ok);
+        StockDeltaBuffer::FlushBatch batch;
+        REQUIRE(deltas.beginFlush(batch));
+        cut = batch.cut;
+        REQUIRE(deltas.add(1, -1, quantity) == StockDeltaBuffer::Status::Ok);
+        // Crash after the flush committed flushed_sequence = cut, before .flushing was
+        // removed: its records are at or below the cut
+    }
+    {
+        StockDeltaBuffer restarted;
+        REQUIRE(restarted.openJournal(path, cut));
+        CHECK(restarted.pending(1) == -1);
+        CHECK(restarted.pending(2) == 0);
+    }
+
+    // A flush that finishes removes .flushing and lowers what it wrote
+    const auto finishedPath = tempJournalPath("finished");
+    StockDeltaBuffer deltas;
+    REQUIRE(deltas.openJournal(finishedPath, 0));
+    deltas.prime(1, 10);
+    REQUIRE(deltas.add(1, -2, quantity) == StockDeltaBuffer::Status::Ok);
+    StockDeltaBuffer::FlushBatch batch;
+    REQUIRE(deltas.beginFlush(batch));
+    REQUIRE(deltas.add(1, -1, quantity) == StockDeltaBuffer::Status::Ok);
+    CHECK(fileExists(finishedPath + ".flushing"));
+    deltas.finishFlush(batch, {});
+    CHECK(!fileExists(finishedPath + ".flushing"));
+    CHECK(deltas.pending(1) == -1);
+    CHECK(deltas.stats()["flushes"].asUInt64() == 1);
+    // Nothing new since the last flush but the one add
+    REQUIRE(deltas.beginFlush(batch));
+    CHECK(batch.deltas.size() == 1);
+    CHECK(batch.deltas[0].second == -1);
+    removeJournal(path);
+    removeJournal(finishedPath);
+}
+
+DROGON_TEST(StockDeltaBufferCountsDirectWrites) {
+    const auto path = tempJournalPath("direct");
+    StockDeltaBuffer deltas;
+    REQUIRE(deltas.openJournal(path, 0));
+    deltas.prime(1, 10);
+
+    // A direct decrement of 8 is in flight: only 2 units are left for add()
+    deltas.beginDirectWrite(1, -8);
+    int64_t quantity = 0;
+    CHECK(deltas.add(1, -5, quantity) == StockDeltaBuffer::Status::InsufficientStock);
+    CHECK(quantity == 2);
+    CHECK(deltas.add(1, -2, quantity) == StockDeltaBuffer::Status::Ok);
+    CHECK(quantity == 8);
+
+    // The write commits: the committed quantity follows, then the announcement ends
+    deltas.updateCommitted(1, 2, 2);
+    deltas.endDirectWrite(1, -8);
+    CHECK(deltas.add(1, -1, quantity) == StockDeltaBuffer::Status::InsufficientStock);
+    CHECK(quantity == 0);
+
+    // Increments are not announced
+    deltas.beginDirectWrite(1, 5);
+    CHECK(deltas.add(1, 3, quantity) == StockDeltaBuffer::Status::Ok);
+    CHECK(quantity == 3);
+    removeJournal(path);
+}
+
+DROGON_TEST(StockDeltaBufferIgnoresOlderCommits) {
+    const auto path = tempJournalPath("versions");
+    StockDeltaBuffer deltas;
+    REQUIRE(deltas.openJournal(path, 0));
+    deltas.prime(1, 10);
+    int64_t quantity = 0;
+    REQUIRE(deltas.add(1, -2, quantity) == StockDeltaBuffer::Status::Ok);
+    StockDeltaBuffer::FlushBatch batch;
+    REQUIRE(deltas.beginFlush(batch));
+
+    // The flush wrote version 4 with 8 in stock; a direct write then made version 5 with
+    // 3 and reported first
+    deltas.updateCommitted(1, 3, 5);
+    drogon_model::sqlite3::Products flushed;
+    flushed.setProductId(1);
+    flushed.setQuantityInStock(8);
+    deltas.finishFlush(batch, {{flushed, 4}});
+    CHECK(deltas.pending(1) == 0);
+    CHECK(deltas.add(1, -4, quantity) == StockDeltaBuffer::Status::InsufficientStock);
+    CHECK(quantity == 3);
+
+    deltas.updateCommitted(1, 6, 6);
+    CHECK(deltas.add(1, -4, quantity) == StockDeltaBuffer::Status::Ok);
+    CHECK(quantity == 2);
+    removeJournal(path);
+}
@@ -0,0 +1,183 @@
+#include <drogon/drogon_test.h>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include "plugins/StockReservations.h"
+
+namespace {
+std::string tempLogPath(const std::string& name) {
+    const std::string path = "stock_reservations_test_" + name + ".log";
+    std::remove(path.c_str());
+    return path;
+}
+}  // namespace
+
+DROGON_TEST(StockReservationsHoldStock) {
+    const auto path = tempLogPath("hold");
+    StockReservations reservations;
+    REQUIRE(reservations.openLog(path));
+
+    StockReservations::Availability availability;
+    StockReservations::Hold hold;
+    CHECK(reservations.reserve(1, 1, 60, hold) == StockReservations::Status::NotReady);
+
+    reservations.loadStock({{1, 10}, {2, 0}});
+    CHECK(reservations.reserve(1, 4, 60, hold) == StockReservations::Status::Ok);
+    const uint64_t first = hold.id;
+    CHECK(reservations.reserve(1, 6, 60, hold) == StockReservations::Status::Ok);
+    CHECK(reservations.reserve(1, 1, 60, hold) ==
+          StockReservations::Status::InsufficientStock);
+    CHECK(reservations.reserve(2, 1, 60, hold) ==
+          StockReservations::Status::InsufficientStock);
+    CHECK(reservations.reserve(3, 1, 60, hold) == StockReservations::Status::UnknownProduct);
+
+    REQUIRE(reservations.availability(1, availability) == StockReservations::Status::Ok);
+    CHECK(availability.inStock == 10);
+    CHECK(availability.reserved == 10);
+    CHECK(availability.available == 0);
+
+    // Releasing gives the units back, once
+    CHECK(reservations.release(first) == StockReservations::Status::Ok);
+    CHECK(reservations.release(first) == StockReservations::Status::NotFound);
+    reservations.availability(1, availability);
+    CHECK(availability.available == 4);
+    std::remove(path.c_str());
+}
+
+DROGON_TEST(StockReservationsCommit) {
+    const auto path = tempLogPath("commit");
+    StockReservations reservations;
+    REQUIRE(reservations.openLog(path));
+    reservations.loadStock({{1, 10}});
+
+    StockReservations::Hold hold;
+    REQUIRE(reservations.reserve(1, 3, 60, hold) == StockReservations::Status::Ok);
+    StockReservations::Hold committing;
+    REQUIRE(reservations.beginCommit(hold.id, committing) == StockReservations::Status::Ok);
+    CHECK(committing.quantity == 3);
+    // Neither a second commit nor a release can take a hold that is being committed
+    CHECK(reservations.beginCommit(hold.id, committing) == StockReservations::Status::NotFound);
+    CHECK(reservations.release(hold.id) == StockReservations::Status::NotFound);
+
+    // A failed write leaves the hold in place
+    reservations.finishCommit(hold.id, false);
+    REQUIRE(reservations.beginCommit(hold.id, committing) == StockReservations::Status::Ok);
+
+    // The writer reports the decremented stock before the commit finishes
+    reservations.updateStock(1, 7);
+    reservations.finishCommit(hold.id, true);
+    StockReservations::Availability availability;
+    reservations.availability(1, availability);
+    CHECK(availability.inStock == 7);
+    CHECK(availability.reserved == 0);
+    CHECK(availability.available == 7);
+    CHECK(reservations.release(hold.id) == StockReservations::Status::NotFound);
+    std::remove(path.c_str());
+}
+
+DROGON_TEST(StockReservationsIgnoreOlderStock) {
+    StockReservations reservations;
+    reservations.loadStock({{1, 10}});
+    reservations.updateStock(1, 4, 7);
+    // A write that read version 6 reports after the one that made version 7
+    reservations.updateStock(1, 9, 6);
+    StockReservations::Availability availability;
+    REQUIRE(reservations.availability(1, availability) == StockReservations::Status::Ok);
+    CHECK(availability.inStock == 4);
+
+    // Buffered adjustments have no row version and always apply
+    reservations.updateStock(1, 3);
+    reservations.availability(1, availability);
+    CHECK(availability.inStock == 3);
+    reservations.updateStock(1, 8, 8);
+    reservations.availability(1, availability);
+    CHECK(availability.inStock == 8);
+}
+
+DROGON_TEST(StockReservationsReplayLog) {
+    const auto path = tempLogPath("replay");
+    uint64_t kept = 0;
+    uint64_t released = 0;
+    {
+        StockReservations reservations;
+        REQUIRE(reservations.openLog(path));
+        reservations.loadStock({{1, 10}, {2, 5}});
+        StockReservations::Hold hold;
+        REQUIRE(reservations.reserve(1, 2, 60, hold) == StockReservations::Status::Ok);
+        kept = hold.id;
+        REQUIRE(reservations.reserve(2, 5, 60, hold) == StockReservations::Status::Ok);
+        released = hold.id;
+        REQUIRE(reservations.release(released) == StockReservations::Status::Ok);
+    }
+
+    StockReservations restarted;
+    REQUIRE(restarted.openLog(path));
+    restarted.loadStock({{1, 10}, {2, 5}});
+    StockReservations::Availability availability;
+    restarted.availability(1, availability);
+    CHECK(availability.reserved == 2);
+    restarted.availability(2, availability);
+    CHECK(availability.reserved == 0);
+
+    // Ids keep growing across restarts, so an old id never names a new hold
+    StockReservations::Hold hold;
+    REQUIRE(restarted.reserve(2, 1, 60, hold) == StockReservations::Status::Ok);
+    CHECK(hold.id > released);
+    CHECK(restarted.release(released) == StockReservations::Status::NotFound);
+    CHECK(restarted.release(kept) == StockReservations::Status::Ok);
+    std::remove(path.c_str());
+}
+
+DROGON_TEST(StockReservationsExpireAfterFailedCommit) {
+    const auto path = tempLogPath("late_commit");
+    StockReservations reservations;
+    REQUIRE(reservations.openLog(path));
+    reservations.loadStock({{1, 10}});
+
+    StockReservations::Hold hold;
+    REQUIRE(reservations.reserve(1, 3, 1, hold) == StockReservations::Status::Ok);
+    StockReservations::Hold committing;
+    REQUIRE(reservations.beginCommit(hold.id, committing) == StockReservations::Status::Ok);
+    // The deadline passes while the write runs, and the write fails
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    reservations.finishCommit(hold.id, false);
+
+    StockReservations::Availability availability;
+    reservations.availability(1, availability);
+    CHECK(availability.reserved == 0);
+    CHECK(reservations.release(hold.id) == StockReservations::Status::NotFound);
+    CHECK(reservations.stats()["expired"].asUInt64() == 1);
+    std::remove(path.c_str());
+}
+
+DROGON_TEST(StockReservationsCompactionDropsReleasedHolds) {
+    const auto path = tempLogPath("compact");
+    {
+        StockReservations reservations;
+        REQUIRE(reservations.openLog(path));
+        reservations.loadStock({{1, 10}});
+        StockReservations::Hold hold;
+        // Enough churn that the log is compacted; the hold kept in the middle shifts
+        // which record triggers it, so one of the two rounds compacts during a release
+        for (int round = 0; round < 2; ++round) {
+            for (int i = 0; i < 1500; ++i) {
+                REQUIRE(reservations.reserve(1, 1, 60, hold) == StockReservations::Status::Ok);
+                REQUIRE(reservations.release(hold.id) == StockReservations::Status::Ok);
+            }
+            if (round == 0) {
+                REQUIRE(reservations.reserve(1, 2, 60, hold) == StockReservations::Status::Ok);
+            }
+        }
+        CHECK(reservations.stats()["log_records"].asUInt64() < 3000);
+    }
+
+    StockReservations restarted;
+    REQUIRE(restarted.openLog(path));
+    restarted.loadStock({{1, 10}});
+    StockReservations::Availability availability;
+    restarted.availability(1, availability);
+    CHECK(availability.reserved == 2);
+    CHECK(restarted.stats()["holds"].asUInt64() == 1);
+    std::remove(path.c_str());
+}
@@ -0,0 +1,97 @@
+#include <drogon/drogon_test.h>
+#include <string>
+#include <vector>
+#include "plugins/WriteCoalescer.h"
+
+using Status = WriteCoalescer::Outcome::Status;
+
+namespace {
+Json::Value makeProduct(const std::string& sku) {
+    Json::Value product;
+    product["sku"] = sku;
+    product["name"] = "Product " + sku;
+    return product;
+}
+
+std::vector<const Json::Value*> pointersTo(const std::vector<Json::Value>& products) {
+    std::vector<const Json::Value*> pointers;
+    for (const auto& product : products) {
+        pointers.push_back(&product);
+    }
+    return pointers;
+}
+}  // namespace
+
+DROGON_TEST(WriteCoalescerFirstSubmittedSkuWins) {
+    const std::vector<Json::Value> products{makeProduct("A"), makeProduct("B"), makeProduct("A"),
+                                            makeProduct("TAKEN")};
+    std::vector<std::string> written;
+    auto insertBatch = [&written](const std::vector<const Json::Value*>& rows,
+                                  WriteCoalescer::InsertedRows& inserted) {
+        for (const auto* row : rows) {
+            written.push_back((*row)["sku"].asString());
+        }
+        // RETURNING in another order, and without the SKU that already exists
+        inserted = {{"B", 11}, {"A", 10}};
+        return true;
+    };
+    bool retried = false;
+    auto insertRow = [&retried](const Json::Value&) {
+        retried = true;
+        return WriteCoalescer::Outcome{};
+    };
+
+    std::vector<WriteCoalescer::Outcome> outcomes;
+    CHECK(WriteCoalescer::resolveBatch(pointersTo(products), insertBatch, insertRow, outcomes));
+    CHECK(!retried);
+    CHECK(written == std::vector<std::string>({"A", "B", "TAKEN"}));
+    REQUIRE(outcomes.size() == 4);
+    CHECK(outcomes[0].status == Status::Created);
+    CHECK(outcomes[0].productId == 10);
+    CHECK(outcomes[1].status == Status::Created);
+    CHECK(outcomes[1].productId == 11);
+    CHECK(outcomes[2].status == Status::Conflict);
+    CHECK(outcomes[3].status == Status::Conflict);
+}
+
+DROGON_TEST(WriteCoalescerRetriesRowByRow) {
+    const std::vector<Json::Value> products{makeProduct("A"), makeProduct("BAD"),
+                                            makeProduct("A"), makeProduct("TAKEN"),
+                                            makeProduct("C")};
+    auto insertBatch = [](const std::vector<const Json::Value*>&,
+                          WriteCoalescer::InsertedRows& inserted) {
+        inserted = {{"A", 10}};  // reported before the batch failed; must not count
+        return false;
+    };
+    std::vector<std::string> retried;
+    auto insertRow = [&retried](const Json::Value& product) {
+        const std::string sku = product["sku"].asString();
+        retried.push_back(sku);
+        WriteCoalescer::Outcome outcome;
+        if (sku == "BAD") {
+            outcome.status = Status::Failed;
+            outcome.message = "CHECK constraint failed";
+        } else if (sku == "TAKEN") {
+            outcome.status = Status::Conflict;
+        } else {
+            outcome.status = Status::Created;
+            outcome.productId = sku == "A" ? 20 : 21;
+        }
+        return outcome;
+    };
+
+    std::vector<WriteCoalescer::Outcome> outcomes;
+    CHECK(!WriteCoalescer::resolveBatch(pointersTo(products), insertBatch, insertRow, outcomes));
+    // The in-batch duplicate is not retried; it lost to the first "A"
+    CHECK(retried == std::vector<std::string>({"A", "BAD", "TAKEN", "C"}));
+    REQUIRE(outcomes.size() == 5);
+    CHECK(outcomes[0].status == Status::Created);
+    CHECK(outcomes[0].productId == 20);
+    CHECK(outcomes[1].status == Status::Failed);
+    CHECK(outcomes[1].message == "CHECK constraint failed");
+    CHECK(outcomes[2].status == Status::Conflict);
+    CHECK(outcomes[3].status == Status::Conflict);
+    CHECK(outcomes[3].message.empty());
+    CHECK(outcomes[4].status == Status::Created);
+    CHECK(outcomes[4].productId == 21);
+}
@@ -0,0 +1,59 @@
+#include "csvreader.h"
+
+bool CsvReader::next(std::vector<std::string>& fields) {
+    fields.clear();
+    std::streambuf* buf = in_.rdbuf();
+    int c = buf->sgetc();
+    if (c == std::char_traits<char>::eof()) {
+        return false;
+    }
+
+    recordLine_ = line_;
+    std::string field;
+    bool quoted = false;
+    while (true) {
+        c = buf->sbumpc();
+        if (c == std::char_traits<char>::eof()) {
+            fields.push_back(std::move(field));
+            return true;
+        }
+        const char ch = static_cast<char>(c);
+        if (quoted) {
+            if (ch == '"') {
+                if (buf->sgetc() == '"') {
+                    buf->sbumpc();
+                    field += '"';
+                } else {
+                    quoted = false;
+                }
+            } else {
+                if (ch == '\n') {
+                    ++line_;
+                }
+                field += ch;
+            }
+            continue;
+        }
+        switch (ch) {
+            case '"':
+                quoted = true;
+                break;
+            case ',':
+                fields.push_back(std::move(field));
+                field.clear();
+                break;
+            case '\r':
+                if (buf->sgetc() == '\n') {
+                    break;
+                }
+                [[fallthrough]];
+            case '\n':
+                ++line_;
+                fields.push_back(std::move(field));
+                return true;
+            default:
+                field += ch;
+                break;
+        }
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <istream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Streaming RFC 4180 record reader
+ *
+ * Reads one record at a time, so files of any size can be processed in constant
+ * memory. Quoted fields may contain commas, doubled quotes and line breaks; both
+ * LF and CRLF line endings are accepted (the catalog export writes CRLF).
+ */
+class CsvReader {
+  public:
+    explicit CsvReader(std::istream& in) : in_(in) {}
+
+    /**
+     * @brief Read the next record into @p fields
+     * @return false at end of input
+     */
+    bool next(std::vector<std::string>& fields);
+
+    /// Line on which the last record returned by next() started (1-based)
+    size_t recordLine() const {
+        return recordLine_;
+    }
+
+  private:
+    std::istream& in_;
+    size_t line_{1};
+    size_t recordLine_{0};
+};
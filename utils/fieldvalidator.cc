@@ -0,0 +1,155 @@
+#include "fieldvalidator.h"
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+std::string formatBound(double value) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.15g", value);
+    return buf;
+}
+
+const FieldRule* findRule(const FieldRule* rules, size_t count, std::string_view name,
+                          size_t& index) {
+    const uint64_t hash = fieldNameHash(name);
+    for (size_t i = 0; i < count; ++i) {
+        if (rules[i].nameHash == hash && rules[i].name == name) {
+            index = i;
+            return &rules[i];
+        }
+    }
+    return nullptr;
+}
+
+bool checkText(const FieldRule& rule, const Json::Value& value, std::string& error) {
+    const char* begin = nullptr;
+    const char* end = nullptr;
+    value.getString(&begin, &end);
+    const size_t length = static_cast<size_t>(end - begin);
+    if (length < rule.minLength || length > rule.maxLength) {
+        error = std::string(rule.name) + " must be " +
+                (rule.maxLength == std::numeric_limits<size_t>::max()
+                     ? "at least " + std::to_string(rule.minLength)
+                     : std::to_string(rule.minLength) + " to " + std::to_string(rule.maxLength)) +
+                " characters long";
+        return false;
+    }
+    // No control characters other than line breaks and tabs
+    for (const char* p = begin; p != end; ++p) {
+        const char c = *p;
+        if (std::iscntrl(static_cast<unsigned char>(c)) && c != '\n' && c != '\r' && c != '\t') {
+            error = std::string(rule.name) + " must not contain control characters";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool checkNumber(const FieldRule& rule, const Json::Value& value, std::string& error) {
+    const double number = value.asDouble();
+    if (!std::isfinite(number) || number < rule.min || number > rule.max) {
+        // Unbounded ends come from the int64 limits and read better left out
+        const bool noMax = rule.max >= static_cast<double>(std::numeric_limits<int64_t>::max());
+        error = std::string(rule.name) +
+                (noMax ? " must be at least " + formatBound(rule.min)
+                       : " must be between " + formatBound(rule.min) + " and " +
+                             formatBound(rule.max));
+        return false;
+    }
+    if (rule.type == FieldType::Real && rule.decimals != kAnyDecimals) {
+        const double scale = std::pow(10.0, rule.decimals);
+        if (std::abs(number - std::round(number * scale) / scale) >= 1e-9) {
+            error = std::string(rule.name) + " must have at most " +
+                    std::to_string(rule.decimals) + " decimal places";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool checkValue(const FieldRule& rule, const Json::Value& value, std::string& error) {
+    if (value.isNull()) {
+        if (rule.notNull) {
+            error = "The " + std::string(rule.name) + " column cannot be null";
+            return false;
+        }
+        return true;
+    }
+    bool typeOk = false;
+    switch (rule.type) {
+        case FieldType::Integer:
+            typeOk = value.isInt64();
+            break;
+        case FieldType::Real:
+            typeOk = value.isNumeric();
+            break;
+        case FieldType::Text:
+        case FieldType::DateTime:
+            typeOk = value.isString();
+            break;
+    }
+    if (!typeOk) {
+        error = "Type error in the " + std::string(rule.name) + " field";
+        return false;
+    }
+    switch (rule.type) {
+        case FieldType::Integer:
+        case FieldType::Real:
+            return checkNumber(rule, value, error);
+        case FieldType::Text:
+            return checkText(rule, value, error);
+        case FieldType::DateTime:
+            break;
+    }
+    return true;
+}
+}  // namespace
+
+bool validateFields(const FieldRule* rules, size_t count, const Json::Value& json,
+                    FieldCheck check, std::string& error, UnknownFields unknown) {
+    if (!json.isObject()) {
+        error = "Body must be a JSON object";
+        return false;
+    }
+    uint64_t seen = 0;
+    bool anyWritable = false;
+    for (auto it = json.begin(); it != json.end(); ++it) {
+        const char* end = nullptr;
+        const char* begin = it.memberName(&end);
+        const std::string_view name(begin, static_cast<size_t>(end - begin));
+        size_t index = 0;
+        const FieldRule* rule = findRule(rules, count, name, index);
+        if (!rule) {
+            if (unknown == UnknownFields::Reject) {
+                error = "Unknown field '" + std::string(name) + "'";
+                return false;
+            }
+            continue;
+        }
+        if (rule->serverSet) {
+            error = std::string(name) + " is set by the server";
+            return false;
+        }
+        seen |= uint64_t{1} << index;
+        anyWritable = anyWritable || !rule->autoValue;
+        if (!checkValue(*rule, *it, error)) {
+            return false;
+        }
+    }
+
+    if (check == FieldCheck::Update) {
+        if (!anyWritable) {
+            error = "At least one field must be provided for update";
+            return false;
+        }
+        return true;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (rules[i].notNull && !rules[i].autoValue && !(seen & (uint64_t{1} << i))) {
+            error = "Missing required field: " + std::string(rules[i].name);
+            return false;
+        }
+    }
+    return true;
+}
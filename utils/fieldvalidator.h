@@ -0,0 +1,105 @@
+#pragma once
+
+#include <json/json.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+
+/**
+ * Table-driven validation of model JSON.
+ *
+ * Each model has a constexpr table of FieldRule in metaData_ order, generated into
+ * models/ModelFieldRules.h by scripts/generate_model_field_rules.py: the type and
+ * nullability come from metaData_, the length and range bounds from the script.
+ * validateFields() walks the members of a JSON object once, finds each rule by a
+ * precomputed name hash and allocates only to report an error.
+ */
+
+enum class FieldType : uint8_t { Integer, Real, Text, DateTime };
+
+/// No limit on the decimal places of a Real field
+constexpr int8_t kAnyDecimals = -1;
+
+struct FieldRule {
+    std::string_view name;
+    uint64_t nameHash;
+    FieldType type;
+    /// Required on create and never null
+    bool notNull;
+    /// Assigned by the database, so never required
+    bool autoValue;
+    /// Text: length in bytes
+    size_t minLength;
+    size_t maxLength;
+    /// Integer and Real: inclusive range
+    double min;
+    double max;
+    /// Real: most decimal places
+    int8_t decimals;
+    /// Maintained by the server (timestamps), so a client may not send it
+    bool serverSet;
+};
+
+/// 64-bit FNV-1a of a field name
+constexpr uint64_t fieldNameHash(std::string_view name) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (char c : name) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+constexpr FieldRule integerField(std::string_view name, bool notNull, bool autoValue,
+                                 double min = std::numeric_limits<int64_t>::min(),
+                                 double max = std::numeric_limits<int64_t>::max()) {
+    return {name, fieldNameHash(name), FieldType::Integer, notNull, autoValue, 0, 0, min, max,
+            0, false};
+}
+
+constexpr FieldRule realField(std::string_view name, bool notNull,
+                              double min = -std::numeric_limits<double>::max(),
+                              double max = std::numeric_limits<double>::max(),
+                              int8_t decimals = kAnyDecimals) {
+    return {name, fieldNameHash(name), FieldType::Real, notNull, false, 0, 0, min, max,
+            decimals, false};
+}
+
+constexpr FieldRule textField(std::string_view name, bool notNull, size_t minLength = 0,
+                              size_t maxLength = std::numeric_limits<size_t>::max()) {
+    return {name, fieldNameHash(name), FieldType::Text, notNull, false, minLength, maxLength,
+            0, 0, 0, false};
+}
+
+constexpr FieldRule dateTimeField(std::string_view name, bool notNull, bool serverSet = false) {
+    return {name, fieldNameHash(name), FieldType::DateTime, notNull, false, 0, 0, 0, 0, 0,
+            serverSet};
+}
+
+enum class FieldCheck {
+    /// Every NOT NULL field that the database does not assign must be present
+    Create,
+    /// Fields are optional, but at least one that is not assigned by the database
+    Update,
+};
+
+enum class UnknownFields { Ignore, Reject };
+
+/**
+ * @brief Check the members of @p json against @p rules
+ *
+ * @return true on success, false with @p error set for the first field that fails
+ */
+bool validateFields(const FieldRule* rules, size_t count, const Json::Value& json,
+                    FieldCheck check, std::string& error,
+                    UnknownFields unknown = UnknownFields::Ignore);
+
+template <size_t N>
+bool validateFields(const std::array<FieldRule, N>& rules, const Json::Value& json,
+                    FieldCheck check, std::string& error,
+                    UnknownFields unknown = UnknownFields::Ignore) {
+    static_assert(N <= 64, "fields are tracked in a 64-bit mask");
+    return validateFields(rules.data(), N, json, check, error, unknown);
+}
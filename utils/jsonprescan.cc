@@ -0,0 +1,295 @@
+#include "jsonprescan.h"
+#include <algorithm>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define JSON_PRESCAN_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+/// Length of the UTF-8 sequence starting at @p p, or 0 if it is invalid
+size_t utf8SequenceLength(const unsigned char* p, size_t available) {
+    const auto cont = [&](size_t i, unsigned char lo = 0x80, unsigned char hi = 0xBF) {
+        return i < available && p[i] >= lo && p[i] <= hi;
+    };
+    const unsigned char c = p[0];
+    if (c >= 0xC2 && c <= 0xDF) {
+        return cont(1) ? 2 : 0;
+    }
+    if (c >= 0xE0 && c <= 0xEF) {
+        // No overlong forms (E0) and no UTF-16 surrogates (ED)
+        const unsigned char lo = c == 0xE0 ? 0xA0 : 0x80;
+        const unsigned char hi = c == 0xED ? 0x9F : 0xBF;
+        return cont(1, lo, hi) && cont(2) ? 3 : 0;
+    }
+    if (c >= 0xF0 && c <= 0xF4) {
+        // No overlong forms (F0) and nothing above U+10FFFF (F4)
+        const unsigned char lo = c == 0xF0 ? 0x90 : 0x80;
+        const unsigned char hi = c == 0xF4 ? 0x8F : 0xBF;
+        return cont(1, lo, hi) && cont(2) && cont(3) ? 4 : 0;
+    }
+    return 0;
+}
+
+/// The bytes the block filters flag; '|' comes along with the brackets and is ignored
+bool flagged(unsigned char c) {
+    const unsigned char lower = c | 0x20;
+    return c < 0x20 || c >= 0x80 || c == '"' || c == ',' || c == ':' || lower == '{' ||
+           lower == '|' || lower == '}';
+}
+
+/// State of one scan; visit() sees every flagged byte in order
+class Scanner {
+  public:
+    Scanner(std::string_view body, JsonPrescan& result, const JsonPrescanOptions& options)
+        : data_(reinterpret_cast<const unsigned char*>(body.data())),
+          size_(body.size()),
+          result_(result),
+          options_(options) {
+        stack_.reserve(std::min<size_t>(options.maxDepth, 256));
+    }
+
+    bool visit(size_t p) {
+        // Inside an escape or a multi-byte character already checked
+        if (p < next_) {
+            return true;
+        }
+        const unsigned char c = data_[p];
+        if (c >= 0x80) {
+            const size_t length = utf8SequenceLength(data_ + p, size_ - p);
+            if (length == 0) {
+                return fail(p, "Invalid UTF-8");
+            }
+            next_ = p + length;
+            return true;
+        }
+        if (inString_) {
+            if (c == '"') {
+                inString_ = false;
+            } else if (c == '\\') {
+                if (p + 1 >= size_) {
+                    return fail(stringStart_, "Unterminated string");
+                }
+                switch (data_[p + 1]) {
+                    case '"':
+                    case '\\':
+                    case '/':
+                    case 'b':
+                    case 'f':
+                    case 'n':
+                    case 'r':
+                    case 't':
+                    case 'u':
+                        break;
+                    default:
+                        return fail(p, "Invalid escape");
+                }
+                next_ = p + 2;
+            } else if (c < 0x20) {
+                return fail(p, "Control character in string");
+            }
+            return true;
+        }
+        switch (c) {
+            case '"':
+                inString_ = true;
+                stringStart_ = p;
+                break;
+            case '{':
+            case '[':
+                if (stack_.size() >= options_.maxDepth) {
+                    return fail(p, "Nesting deeper than " + std::to_string(options_.maxDepth));
+                }
+                stack_.push_back(static_cast<char>(c));
+                result_.depth = std::max(result_.depth, stack_.size());
+                record(p);
+                break;
+            case '}':
+            case ']':
+                if (stack_.empty() || stack_.back() != (c == '}' ? '{' : '[')) {
+                    return fail(p, "Unbalanced brackets");
+                }
+                stack_.pop_back();
+                record(p);
+                break;
+            case ',':
+            case ':':
+                record(p);
+                break;
+            case '\t':
+            case '\n':
+            case '\r':
+                break;
+            default:
+                // A stray backslash or '|' is the parser's to report
+                if (c < 0x20) {
+                    return fail(p, "Control character outside a string");
+                }
+                break;
+        }
+        return true;
+    }
+
+    bool finish() {
+        if (inString_) {
+            return fail(stringStart_, "Unterminated string");
+        }
+        if (!stack_.empty()) {
+            return fail(size_, "Unbalanced brackets");
+        }
+        return true;
+    }
+
+  private:
+    void record(size_t p) {
+        if (options_.buildIndex) {
+            result_.structurals.push_back(static_cast<uint32_t>(p));
+        }
+    }
+
+    bool fail(size_t p, std::string error) {
+        result_.error = std::move(error);
+        result_.errorOffset = p;
+        return false;
+    }
+
+    const unsigned char* data_;
+    size_t size_;
+    JsonPrescan& result_;
+    const JsonPrescanOptions& options_;
+    std::string stack_;
+    size_t next_{0};
+    size_t stringStart_{0};
+    bool inString_{false};
+};
+
+/// Hand the set bits of @p bits, the flags of the block at @p base, to the scanner
+bool visitBits(Scanner& scanner, size_t base, uint32_t bits) {
+    while (bits != 0) {
+        if (!scanner.visit(base + static_cast<size_t>(__builtin_ctz(bits)))) {
+            return false;
+        }
+        bits &= bits - 1;
+    }
+    return true;
+}
+
+#ifdef JSON_PRESCAN_X86
+/// Scan whole 16-byte blocks; @p done is set to the first byte left for the scalar tail
+bool scanSse2(Scanner& scanner, const char* data, size_t size, size_t& done) {
+    const __m128i space = _mm_set1_epi8(0x20);
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i colon = _mm_set1_epi8(':');
+    const __m128i openBrace = _mm_set1_epi8('{');
+    const __m128i pipe = _mm_set1_epi8('|');
+    const __m128i closeBrace = _mm_set1_epi8('}');
+    size_t p = 0;
+    for (; p + 16 <= size; p += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + p));
+        // Signed compare: bytes below 0x20 and every byte from 0x80 up
+        __m128i m = _mm_cmplt_epi8(v, space);
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(v, quote));
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(v, comma));
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(v, colon));
+        // Setting bit 5 maps [ \ ] onto { | }
+        const __m128i lower = _mm_or_si128(v, space);
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(lower, openBrace));
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(lower, pipe));
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(lower, closeBrace));
+        if (!visitBits(scanner, p, static_cast<uint32_t>(_mm_movemask_epi8(m)))) {
+            return false;
+        }
+    }
+    done = p;
+    return true;
+}
+
+/// scanSse2() over 32-byte blocks
+__attribute__((target("avx2"))) bool scanAvx2(Scanner& scanner, const char* data, size_t size,
+                                              size_t& done) {
+    const __m256i space = _mm256_set1_epi8(0x20);
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i comma = _mm256_set1_epi8(',');
+    const __m256i colon = _mm256_set1_epi8(':');
+    const __m256i openBrace = _mm256_set1_epi8('{');
+    const __m256i pipe = _mm256_set1_epi8('|');
+    const __m256i closeBrace = _mm256_set1_epi8('}');
+    size_t p = 0;
+    for (; p + 32 <= size; p += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + p));
+        __m256i m = _mm256_cmpgt_epi8(space, v);
+        m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, quote));
+        m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, comma));
+        m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, colon));
+        const __m256i lower = _mm256_or_si256(v, space);
+        m = _mm256_or_si256(m, _mm256_cmpeq_epi8(lower, openBrace));
+        m = _mm256_or_si256(m, _mm256_cmpeq_epi8(lower, pipe));
+        m = _mm256_or_si256(m, _mm256_cmpeq_epi8(lower, closeBrace));
+        if (!visitBits(scanner, p, static_cast<uint32_t>(_mm256_movemask_epi8(m)))) {
+            return false;
+        }
+    }
+    done = p;
+    return true;
+}
+
+bool hasAvx2() {
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    return avx2;
+}
+#endif
+}  // namespace
+
+bool prescanJson(std::string_view body, JsonPrescan& result, const JsonPrescanOptions& options) {
+    result.error.clear();
+    result.errorOffset = 0;
+    result.depth = 0;
+    result.structurals.clear();
+    Scanner scanner(body, result, options);
+
+    size_t p = 0;
+#ifdef JSON_PRESCAN_X86
+    if (options.level == JsonScanLevel::Best && hasAvx2()) {
+        if (!scanAvx2(scanner, body.data(), body.size(), p)) {
+            return false;
+        }
+    } else if (options.level != JsonScanLevel::Scalar) {
+        if (!scanSse2(scanner, body.data(), body.size(), p)) {
+            return false;
+        }
+    }
+#endif
+    for (; p < body.size(); ++p) {
+        if (flagged(static_cast<unsigned char>(body[p])) && !scanner.visit(p)) {
+            return false;
+        }
+    }
+    return scanner.finish();
+}
+
+size_t topLevelElementCount(std::string_view body, const std::vector<uint32_t>& structurals) {
+    const size_t start = body.find_first_not_of(" \t\n\r");
+    if (structurals.empty() || structurals.front() != start) {
+        return 0;
+    }
+    size_t depth = 0;
+    size_t commas = 0;
+    for (size_t i = 0; i < structurals.size(); ++i) {
+        const char c = body[structurals[i]];
+        if (c == '{' || c == '[') {
+            ++depth;
+        } else if (c == '}' || c == ']') {
+            if (--depth == 0) {
+                // "[]" or "{ }": the close follows the open with only whitespace between
+                if (i == 1 && body.find_first_not_of(" \t\n\r", start + 1) == structurals[1]) {
+                    return 0;
+                }
+                return commas + 1;
+            }
+        } else if (c == ',' && depth == 1) {
+            ++commas;
+        }
+    }
+    return 0;
+}
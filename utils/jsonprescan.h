@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// Deepest nesting of objects and arrays a request body may have
+constexpr size_t kMaxJsonDepth = 64;
+
+/// Instruction set prescanJson() classifies bytes with
+enum class JsonScanLevel : uint8_t {
+    Best,    // AVX2 when the CPU has it, else SSE2, else Scalar
+    Sse2,    // 16 bytes at a time; Scalar on other architectures
+    Scalar,  // one byte at a time
+};
+
+struct JsonPrescanOptions {
+    size_t maxDepth{kMaxJsonDepth};
+    /// Fill JsonPrescan::structurals
+    bool buildIndex{false};
+    JsonScanLevel level{JsonScanLevel::Best};
+};
+
+struct JsonPrescan {
+    /// Why the body was refused, empty when it passed
+    std::string error;
+    /// Byte offset of the first bad byte
+    size_t errorOffset{0};
+    /// Deepest nesting seen
+    size_t depth{0};
+    /// Offsets of the {}[]:, bytes outside strings, in order, when buildIndex is set
+    std::vector<uint32_t> structurals;
+};
+
+/**
+ * @brief Check the structure of a JSON body before any DOM is built
+ *
+ * Refuses, in one pass over the raw bytes, bodies with invalid UTF-8, unbalanced or
+ * mismatched brackets, nesting deeper than maxDepth, control characters inside strings
+ * or outside whitespace, bad escapes and unterminated strings. Numbers and literals are
+ * left to the parser, so a body that passes can still fail to parse.
+ *
+ * Blocks of 16 or 32 bytes are compared against the bytes that matter at once; only
+ * those bytes (quotes, backslashes, brackets, separators, control and non-ASCII bytes)
+ * are looked at one by one, so names, numbers and plain text are skipped a block at a
+ * time. Every level gives the same result.
+ *
+ * @return false with result.error set when the body is refused
+ */
+bool prescanJson(std::string_view body, JsonPrescan& result,
+                 const JsonPrescanOptions& options = {});
+
+/**
+ * @brief Number of elements of the array or members of the object at the top level
+ *
+ * Counted from a structural index without parsing; 0 for a scalar or an empty container.
+ */
+size_t topLevelElementCount(std::string_view body, const std::vector<uint32_t>& structurals);
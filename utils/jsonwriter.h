@@ -0,0 +1,133 @@
+#pragma once
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Append-only JSON primitives used by the generated model writers
+ * (models/ModelJsonWriters.h).
+ *
+ * Output matches what drogon produces for a Json::Value with its default writer
+ * settings (no indentation, emitUTF8 on, 17 significant digits), so responses built
+ * with these helpers are byte-identical to newHttpJsonResponse(model.toJson()).
+ * If `enable_unicode_escaping_in_json` is turned on in config.json, drogon escapes
+ * non-ASCII characters and the two outputs no longer match.
+ */
+
+template <size_t N>
+inline void appendJsonRaw(std::string& out, const char (&literal)[N]) {
+    out.append(literal, N - 1);
+}
+
+inline void appendJsonNull(std::string& out) {
+    out.append("null", 4);
+}
+
+inline void appendJsonBool(std::string& out, bool value) {
+    if (value) {
+        out.append("true", 4);
+    } else {
+        out.append("false", 5);
+    }
+}
+
+inline void appendJsonInt(std::string& out, int64_t value) {
+    char buf[24];
+    auto res = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, static_cast<size_t>(res.ptr - buf));
+}
+
+inline void appendJsonDouble(std::string& out, double value) {
+    if (!std::isfinite(value)) {
+        // jsoncpp's spelling when special floats are disabled
+        if (std::isnan(value)) {
+            appendJsonNull(out);
+        } else {
+            out.append(value < 0 ? "-1e+9999" : "1e+9999");
+        }
+        return;
+    }
+    char buf[40];
+    int len = std::snprintf(buf, sizeof(buf), "%.17g", value);
+    bool hasDotOrExp = false;
+    for (int i = 0; i < len; ++i) {
+        if (buf[i] == ',') {
+            buf[i] = '.';  // locale decimal separator
+        }
+        if (buf[i] == '.' || buf[i] == 'e') {
+            hasDotOrExp = true;
+        }
+    }
+    out.append(buf, static_cast<size_t>(len));
+    if (!hasDotOrExp) {
+        out.append(".0", 2);
+    }
+}
+
+inline void appendJsonString(std::string& out, std::string_view value) {
+    static const char kHex[] = "0123456789abcdef";
+    out += '"';
+    const char* runStart = value.data();
+    const char* end = value.data() + value.size();
+    for (const char* p = runStart; p != end; ++p) {
+        const unsigned char c = static_cast<unsigned char>(*p);
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        out.append(runStart, static_cast<size_t>(p - runStart));
+        runStart = p + 1;
+        switch (c) {
+            case '"':
+                out.append("\\\"", 2);
+                break;
+            case '\\':
+                out.append("\\\\", 2);
+                break;
+            case '\b':
+                out.append("\\b", 2);
+                break;
+            case '\f':
+                out.append("\\f", 2);
+                break;
+            case '\n':
+                out.append("\\n", 2);
+                break;
+            case '\r':
+                out.append("\\r", 2);
+                break;
+            case '\t':
+                out.append("\\t", 2);
+                break;
+            default: {
+                const char escaped[6] = {'\\', 'u', '0', '0', kHex[c >> 4], kHex[c & 0xF]};
+                out.append(escaped, 6);
+                break;
+            }
+        }
+    }
+    out.append(runStart, static_cast<size_t>(end - runStart));
+    out += '"';
+}
+
+/// Append a JSON array of models; appendJson(out, item) is found by ADL
+template <typename T>
+void appendJsonArray(std::string& out, const T* items, size_t count) {
+    out += '[';
+    for (size_t i = 0; i < count; ++i) {
+        if (i > 0) {
+            out += ',';
+        }
+        appendJson(out, items[i]);
+    }
+    out += ']';
+}
+
+template <typename T>
+void appendJsonArray(std::string& out, const std::vector<T>& items) {
+    appendJsonArray(out, items.data(), items.size());
+}
@@ -0,0 +1,97 @@
+#include "pagination.h"
+#include <drogon/utils/Utilities.h>
+#include <cerrno>
+#include <cstdlib>
+
+namespace {
+// Bumped if the cursor layout ever changes so old tokens are rejected cleanly
+const std::string kCursorPrefix = "p1:";
+
+bool parseInt64(const std::string& text, int64_t& out) {
+    if (text.empty() || text.size() > 19) {
+        return false;
+    }
+    for (char c : text) {
+        if (c < '0' || c > '9') {
+            return false;
+        }
+    }
+    errno = 0;
+    char* end = nullptr;
+    long long value = std::strtoll(text.c_str(), &end, 10);
+    if (errno == ERANGE || *end != '\0') {
+        return false;
+    }
+    out = static_cast<int64_t>(value);
+    return true;
+}
+}  // namespace
+
+bool parsePageLimit(const std::string& value, size_t& limit, std::string& error) {
+    if (value.empty()) {
+        limit = kDefaultPageLimit;
+        return true;
+    }
+
+    int64_t parsed = 0;
+    if (!parseInt64(value, parsed) || parsed < 1 ||
+        parsed > static_cast<int64_t>(kMaxPageLimit)) {
+        error = "limit must be an integer between 1 and " + std::to_string(kMaxPageLimit);
+        return false;
+    }
+    limit = static_cast<size_t>(parsed);
+    return true;
+}
+
+std::string encodeProductCursor(int64_t lastProductId) {
+    const std::string raw = kCursorPrefix + std::to_string(lastProductId);
+    std::string token = drogon::utils::base64Encode(
+        reinterpret_cast<const unsigned char*>(raw.data()), raw.size(), true);
+    // Padding is redundant for decoding and would need escaping in a query string
+    while (!token.empty() && token.back() == '=') {
+        token.pop_back();
+    }
+    return token;
+}
+
+bool decodeProductCursor(const std::string& token, int64_t& lastProductId, std::string& error) {
+    if (token.empty()) {
+        lastProductId = 0;
+        return true;
+    }
+
+    const std::string raw = drogon::utils::base64Decode(token);
+    if (raw.compare(0, kCursorPrefix.size(), kCursorPrefix) != 0 ||
+        !parseInt64(raw.substr(kCursorPrefix.size()), lastProductId)) {
+        error = "Invalid pagination cursor";
+        return false;
+    }
+    return true;
+}
+
+bool parseIntParameter(const std::string& value, const char* name, int64_t& out, bool& present,
+                       std::string& error) {
+    present = !value.empty();
+    if (!present) {
+        return true;
+    }
+    if (!parseInt64(value, out)) {
+        error = std::string(name) + " must be a non-negative integer";
+        return false;
+    }
+    return true;
+}
+
+bool parseBoolParameter(const std::string& value, const char* name, bool& out,
+                        std::string& error) {
+    if (value.empty() || value == "false" || value == "0") {
+        out = false;
+        return true;
+    }
+    if (value == "true" || value == "1") {
+        out = true;
+        return true;
+    }
+    error = std::string(name) + " must be true or false";
+    return false;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/// Page size used by list endpoints when the client does not pass `limit`
+constexpr size_t kDefaultPageLimit = 100;
+/// Upper bound on `limit` so a single page always stays small
+constexpr size_t kMaxPageLimit = 1000;
+
+/**
+ * @brief Parse the `limit` query parameter of a paginated list endpoint
+ *
+ * An empty value selects kDefaultPageLimit. Anything that is not an integer
+ * in [1, kMaxPageLimit] is rejected.
+ *
+ * @return true on success, false with @p error set otherwise
+ */
+bool parsePageLimit(const std::string& value, size_t& limit, std::string& error);
+
+/**
+ * @brief Encode the keyset position after @p lastProductId as an opaque cursor
+ *
+ * The token is URL-safe so it can be passed back verbatim in `?after=`.
+ */
+std::string encodeProductCursor(int64_t lastProductId);
+
+/**
+ * @brief Decode a cursor produced by encodeProductCursor()
+ *
+ * An empty token means "start from the beginning" and yields 0.
+ *
+ * @return true on success, false with @p error set if the token is malformed
+ */
+bool decodeProductCursor(const std::string& token, int64_t& lastProductId, std::string& error);
+
+/**
+ * @brief Parse an optional non-negative integer query parameter such as `supplier_id`
+ *
+ * @param present Set to whether the parameter was given at all
+ * @return true on success or when empty, false with @p error naming @p name otherwise
+ */
+bool parseIntParameter(const std::string& value, const char* name, int64_t& out, bool& present,
+                       std::string& error);
+
+/**
+ * @brief Parse an optional boolean query parameter (`true`/`false`/`1`/`0`)
+ *
+ * An empty value yields false.
+ */
+bool parseBoolParameter(const std::string& value, const char* name, bool& out,
+                        std::string& error);
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+/**
+ * Column projection helpers for `?fields=` on model reads.
+ *
+ * A projection is a bitmask over a drogon_ctl model's columns where bit i stands
+ * for getColumnName(i), i.e. the metaData_ order. Column names in generated SQL
+ * only ever come from the model metadata, never from the request.
+ */
+
+/// Mask selecting every column of model T
+template <typename T>
+uint64_t allColumnsMask() {
+    const size_t n = T::getColumnNumber();
+    return n >= 64 ? ~uint64_t{0} : (uint64_t{1} << n) - 1;
+}
+
+/// Bit of column @p name of model T, 0 if T has no such column
+template <typename T>
+uint64_t columnMask(const std::string& name) {
+    for (size_t i = 0; i < T::getColumnNumber() && i < 64; ++i) {
+        if (T::getColumnName(i) == name) {
+            return uint64_t{1} << i;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Parse a comma separated `fields` parameter into a column mask for T
+ *
+ * An empty parameter selects all columns.
+ *
+ * @return true on success, false with @p error naming the unknown field otherwise
+ */
+template <typename T>
+bool parseFieldMask(const std::string& fields, uint64_t& mask, std::string& error) {
+    if (fields.empty()) {
+        mask = allColumnsMask<T>();
+        return true;
+    }
+
+    mask = 0;
+    size_t pos = 0;
+    while (pos <= fields.size()) {
+        size_t end = fields.find(',', pos);
+        if (end == std::string::npos) {
+            end = fields.size();
+        }
+        size_t b = fields.find_first_not_of(' ', pos);
+        size_t e = fields.find_last_not_of(' ', end == 0 ? 0 : end - 1);
+        if (b < end && e != std::string::npos && e >= b) {
+            const size_t len = e - b + 1;
+            bool found = false;
+            for (size_t i = 0; i < T::getColumnNumber(); ++i) {
+                const std::string& column = T::getColumnName(i);
+                if (column.size() == len && fields.compare(b, len, column) == 0) {
+                    mask |= uint64_t{1} << i;
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) {
+                error = "Unknown field '" + fields.substr(b, len) + "'";
+                return false;
+            }
+        }
+        pos = end + 1;
+    }
+    if (mask == 0) {
+        error = "fields must name at least one column";
+        return false;
+    }
+    return true;
+}
+
+/// Comma separated column list for a SELECT, in the model's metaData_ order
+template <typename T>
+std::string projectionSelectList(uint64_t mask) {
+    std::string list;
+    for (size_t i = 0; i < T::getColumnNumber(); ++i) {
+        if (mask & (uint64_t{1} << i)) {
+            if (!list.empty()) {
+                list += ',';
+            }
+            list += T::getColumnName(i);
+        }
+    }
+    return list;
+}
@@ -0,0 +1,51 @@
+#include "requestjson.h"
+#include "jsonprescan.h"
+
+std::shared_ptr<Json::Value> parseJsonBody(std::string_view body, std::string* error,
+                                           const JsonPrescan* prescanned) {
+    // Malformed, deeply nested or non-UTF-8 bodies are refused before any DOM is built
+    JsonPrescan prescan;
+    if (!prescanned) {
+        prescanJson(body, prescan);
+        prescanned = &prescan;
+    }
+    if (!prescanned->error.empty()) {
+        if (error) {
+            *error = prescanned->error + " at byte " + std::to_string(prescanned->errorOffset);
+        }
+        return nullptr;
+    }
+    // Building a reader copies the builder settings, so each thread keeps one
+    thread_local const std::unique_ptr<Json::CharReader> reader = []() {
+        Json::CharReaderBuilder builder;
+        return std::unique_ptr<Json::CharReader>(builder.newCharReader());
+    }();
+    auto json = std::make_shared<Json::Value>();
+    std::string errors;
+    if (!reader->parse(body.data(), body.data() + body.size(), json.get(), &errors)) {
+        if (error) {
+            *error = std::move(errors);
+        }
+        return nullptr;
+    }
+    return json;
+}
+
+std::shared_ptr<Json::Value> parseRequestBody(const drogon::HttpRequestPtr& req,
+                                              const JsonPrescan* prescanned) {
+    const auto& attributes = req->getAttributes();
+    if (attributes->find(kParsedJsonAttribute)) {
+        return attributes->get<std::shared_ptr<Json::Value>>(kParsedJsonAttribute);
+    }
+    auto json = parseJsonBody(req->getBody(), nullptr, prescanned);
+    attributes->insert(kParsedJsonAttribute, json);
+    return json;
+}
+
+std::shared_ptr<Json::Value> requestJson(const drogon::HttpRequestPtr& req) {
+    const auto& attributes = req->getAttributes();
+    if (attributes->find(kParsedJsonAttribute)) {
+        return attributes->get<std::shared_ptr<Json::Value>>(kParsedJsonAttribute);
+    }
+    return req->getJsonObject();
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <drogon/HttpRequest.h>
+#include <json/json.h>
+#include <memory>
+#include <string>
+#include <string_view>
+
+struct JsonPrescan;
+
+/**
+ * @brief One JSON parse per request body
+ *
+ * The pre-routing validation parses the body with parseRequestBody(), which keeps the
+ * document as a request attribute. ValidationMiddleware and the controllers read it
+ * back with requestJson() instead of parsing the body again.
+ */
+
+/// Request attribute holding the std::shared_ptr<Json::Value> of the parsed body
+constexpr const char* kParsedJsonAttribute = "parsed_json";
+
+/**
+ * @brief Parse @p body; nullptr, with the reason in @p error if given, when it is not JSON
+ *
+ * The body goes through prescanJson() first, so one that is malformed in structure or
+ * nested too deeply is refused without building a document. A caller that already
+ * prescanned it with the default depth passes that result as @p prescanned, and the
+ * body is not scanned again.
+ */
+std::shared_ptr<Json::Value> parseJsonBody(std::string_view body, std::string* error = nullptr,
+                                           const JsonPrescan* prescanned = nullptr);
+
+/**
+ * @brief Parse the body of @p req once and keep the result on the request
+ *
+ * Later calls return the stored document without parsing. A body that is not JSON is
+ * remembered as nullptr, so it is not parsed twice either. @p prescanned is passed on
+ * to parseJsonBody().
+ */
+std::shared_ptr<Json::Value> parseRequestBody(const drogon::HttpRequestPtr& req,
+                                              const JsonPrescan* prescanned = nullptr);
+
+/// The document parseRequestBody() stored, or req->getJsonObject() if nothing parsed it yet
+std::shared_ptr<Json::Value> requestJson(const drogon::HttpRequestPtr& req);
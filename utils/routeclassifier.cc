@@ -0,0 +1,191 @@
+#include "routeclassifier.h"
+#include <array>
+#include <limits>
+#include <utility>
+
+namespace {
+constexpr std::array<std::pair<std::string_view, ApiResource>, 5> kResources{{
+    {"products", ApiResource::Products},
+    {"suppliers", ApiResource::Suppliers},
+    {"warehouses", ApiResource::Warehouses},
+    {"purchase_orders", ApiResource::PurchaseOrders},
+    {"cache", ApiResource::Cache},
+}};
+
+/// Fixed segments directly under /api/products
+constexpr std::array<std::pair<std::string_view, RouteKind>, 5> kProductActions{{
+    {"bulk", RouteKind::ProductBulk},
+    {"by-sku", RouteKind::ProductBySku},
+    {"adjust", RouteKind::ProductAdjustBatch},
+    {"export", RouteKind::ProductExport},
+    {"low-stock", RouteKind::ProductLowStock},
+}};
+
+/// Segments after /api/products/{id}
+constexpr std::array<std::pair<std::string_view, RouteKind>, 3> kProductItemActions{{
+    {"adjust", RouteKind::ProductAdjust},
+    {"availability", RouteKind::ProductAvailability},
+    {"reservations", RouteKind::ProductReserve},
+}};
+
+template <size_t N>
+RouteKind lookup(const std::array<std::pair<std::string_view, RouteKind>, N>& table,
+                 std::string_view segment) {
+    for (const auto& [name, kind] : table) {
+        if (name == segment) {
+            return kind;
+        }
+    }
+    return RouteKind::Unknown;
+}
+
+/// Splits a path into segments; a trailing slash does not add an empty one
+class Segments {
+  public:
+    explicit Segments(std::string_view path) : path_(path) {}
+
+    /// False once the path is exhausted
+    bool next(std::string_view& segment) {
+        if (pos_ >= path_.size()) {
+            return false;
+        }
+        const size_t end = path_.find('/', pos_);
+        if (end == std::string_view::npos) {
+            segment = path_.substr(pos_);
+            pos_ = path_.size();
+        } else {
+            segment = path_.substr(pos_, end - pos_);
+            pos_ = end + 1;
+        }
+        return true;
+    }
+
+    bool done() const {
+        return pos_ >= path_.size();
+    }
+
+  private:
+    std::string_view path_;
+    size_t pos_{0};
+};
+
+/// False if @p segment is not all digits; otherwise sets the id and its status
+bool parseIdSegment(std::string_view segment, RouteMatch& match) {
+    if (segment.empty()) {
+        return false;
+    }
+    constexpr int64_t kMax = std::numeric_limits<int64_t>::max();
+    int64_t value = 0;
+    bool overflow = false;
+    for (char c : segment) {
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        const int digit = c - '0';
+        if (!overflow && value > (kMax - digit) / 10) {
+            overflow = true;
+        }
+        value = overflow ? 0 : value * 10 + digit;
+    }
+    if (overflow) {
+        match.idStatus = RouteIdStatus::OutOfRange;
+    } else if (segment[0] == '0') {
+        match.idStatus = RouteIdStatus::Malformed;
+    } else {
+        match.idStatus = RouteIdStatus::Valid;
+        match.id = value;
+    }
+    return true;
+}
+
+RouteMatch unknown() {
+    return RouteMatch{};
+}
+
+/// The part of a products path after /api/products/
+RouteMatch classifyProducts(Segments& segments, RouteMatch match) {
+    std::string_view segment;
+    segments.next(segment);
+    if (segment == "reservations") {
+        // /api/products/reservations/{id}[/commit]
+        if (!segments.next(segment) || !parseIdSegment(segment, match)) {
+            return unknown();
+        }
+        match.kind = RouteKind::Reservation;
+        if (segments.next(segment)) {
+            if (segment != "commit" || !segments.done()) {
+                return unknown();
+            }
+            match.kind = RouteKind::ReservationCommit;
+        }
+        return match;
+    }
+    if (parseIdSegment(segment, match)) {
+        match.kind = RouteKind::Item;
+        if (segments.next(segment)) {
+            match.kind = lookup(kProductItemActions, segment);
+            if (match.kind == RouteKind::Unknown || !segments.done()) {
+                return unknown();
+            }
+        }
+        return match;
+    }
+    match.kind = lookup(kProductActions, segment);
+    if (match.kind == RouteKind::Unknown || !segments.done()) {
+        return unknown();
+    }
+    return match;
+}
+}  // namespace
+
+RouteMatch classifyRoute(std::string_view path) noexcept {
+    Segments segments(path);
+    std::string_view segment;
+    // The leading slash yields an empty first segment
+    if (!segments.next(segment) || !segment.empty() || !segments.next(segment) ||
+        segment != "api") {
+        return unknown();
+    }
+    RouteMatch match;
+    if (!segments.next(segment)) {
+        match.kind = RouteKind::ApiIndex;
+        return match;
+    }
+    if (segment == "products:batchGet") {
+        if (!segments.done()) {
+            return unknown();
+        }
+        match.resource = ApiResource::Products;
+        match.kind = RouteKind::ProductBatchGet;
+        return match;
+    }
+    for (const auto& [name, resource] : kResources) {
+        if (name == segment) {
+            match.resource = resource;
+        }
+    }
+    if (match.resource == ApiResource::None) {
+        return unknown();
+    }
+
+    if (match.resource == ApiResource::Cache) {
+        if (segments.next(segment) && segment == "stats" && segments.done()) {
+            match.kind = RouteKind::CacheStats;
+            return match;
+        }
+        return unknown();
+    }
+    if (segments.done()) {
+        match.kind = RouteKind::Collection;
+        return match;
+    }
+    if (match.resource == ApiResource::Products) {
+        return classifyProducts(segments, match);
+    }
+    // Suppliers, warehouses and purchase orders only have /{id} below the collection
+    if (!segments.next(segment) || !parseIdSegment(segment, match) || !segments.done()) {
+        return unknown();
+    }
+    match.kind = RouteKind::Item;
+    return match;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+/// Resource named by the second segment of an /api path
+enum class ApiResource : uint8_t { None, Products, Suppliers, Warehouses, PurchaseOrders, Cache };
+
+/// Endpoint an /api path names, independent of the HTTP method
+enum class RouteKind : uint8_t {
+    Unknown,              // not a route the server registers
+    ApiIndex,             // /api
+    Collection,           // /api/{resource}
+    Item,                 // /api/{resource}/{id}
+    CacheStats,           // /api/cache/stats
+    ProductBatchGet,      // /api/products:batchGet
+    ProductBulk,          // /api/products/bulk
+    ProductBySku,         // /api/products/by-sku
+    ProductAdjustBatch,   // /api/products/adjust
+    ProductExport,        // /api/products/export
+    ProductLowStock,      // /api/products/low-stock
+    ProductAdjust,        // /api/products/{id}/adjust
+    ProductAvailability,  // /api/products/{id}/availability
+    ProductReserve,       // /api/products/{id}/reservations
+    Reservation,          // /api/products/reservations/{id}
+    ReservationCommit,    // /api/products/reservations/{id}/commit
+};
+
+/// How the numeric segment of a route parsed
+enum class RouteIdStatus : uint8_t {
+    None,        // the route has no id segment
+    Valid,       // id holds a positive integer
+    Malformed,   // zero or a leading zero
+    OutOfRange,  // more digits than an int64 holds
+};
+
+struct RouteMatch {
+    ApiResource resource{ApiResource::None};
+    RouteKind kind{RouteKind::Unknown};
+    RouteIdStatus idStatus{RouteIdStatus::None};
+    /// Product, supplier, warehouse, purchase order or reservation id when idStatus is Valid
+    int64_t id{0};
+};
+
+/**
+ * @brief Classify an /api request path in one pass, without allocating
+ *
+ * Replaces matching the path against std::regex patterns once per check. A single
+ * trailing slash is accepted, as the routes accept it. A segment that must be an id
+ * and is not all digits makes the path Unknown.
+ */
+RouteMatch classifyRoute(std::string_view path) noexcept;
@@ -0,0 +1,49 @@
+#include "rowversion.h"
+#include <cstdio>
+#include <cstdlib>
+
+std::string makeRowEtag(int64_t productId, int64_t version) {
+    char buf[48];
+    std::snprintf(buf, sizeof(buf), "\"p%lldv%lld\"", static_cast<long long>(productId),
+                  static_cast<long long>(version));
+    return buf;
+}
+
+bool parseIfMatch(const std::string& header, int64_t productId, bool& any,
+                  std::vector<int64_t>& versions) {
+    any = false;
+    versions.clear();
+    if (header.find_first_not_of(" \t") == std::string::npos) {
+        return false;
+    }
+    const std::string prefix = "\"p" + std::to_string(productId) + "v";
+    size_t pos = 0;
+    while (pos < header.size()) {
+        size_t end = header.find(',', pos);
+        if (end == std::string::npos) {
+            end = header.size();
+        }
+        const size_t b = header.find_first_not_of(" \t", pos);
+        const size_t e = header.find_last_not_of(" \t", end - 1);
+        pos = end + 1;
+        if (b == std::string::npos || b >= end || e < b) {
+            continue;
+        }
+        const std::string candidate = header.substr(b, e - b + 1);
+        if (candidate == "*") {
+            any = true;
+            continue;
+        }
+        if (candidate.size() <= prefix.size() + 1 ||
+            candidate.compare(0, prefix.size(), prefix) != 0 || candidate.back() != '"') {
+            continue;
+        }
+        const std::string digits =
+            candidate.substr(prefix.size(), candidate.size() - prefix.size() - 1);
+        if (digits.size() > 18 || digits.find_first_not_of("0123456789") != std::string::npos) {
+            continue;
+        }
+        versions.push_back(std::strtoll(digits.c_str(), nullptr, 10));
+    }
+    return true;
+}
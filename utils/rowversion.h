@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Strong ETag of one product row at @p version, e.g. "p42v7"
+ *
+ * products.version only ever grows, so the tag stays unique across restarts. A product
+ * re-created under a deleted id continues from the deleted row's version (see the
+ * product_tombstones triggers in createSchema()), so its tags do not repeat either.
+ * The version SQLite returns from the INSERT itself predates that trigger; read it back.
+ */
+std::string makeRowEtag(int64_t productId, int64_t version);
+
+/**
+ * @brief Parse an If-Match header sent for product @p productId
+ *
+ * If-Match uses the strong comparison: weak tags (W/...) and tags of other products
+ * or other resources never match and are skipped.
+ *
+ * @param any Set if the header is "*", which matches any existing row
+ * @param versions Row versions named by the header
+ * @return false if the header is empty (no precondition)
+ */
+bool parseIfMatch(const std::string& header, int64_t productId, bool& any,
+                  std::vector<int64_t>& versions);
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Thread-safe LRU cache split into independently locked shards
+ *
+ * Keys are spread over the shards by hash, each shard has its own mutex, LRU list
+ * and share of the capacity, so lookups from different IO threads rarely contend.
+ * Entries optionally expire after a fixed TTL.
+ *
+ * Read-through callers should take a fill token with fillToken() before going to
+ * the database and pass it to insert(). Any erase() in the same shard in between
+ * bumps the shard generation and the stale fill is dropped, so a slow read cannot
+ * resurrect a row that a concurrent write just invalidated.
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class ShardedLruCache {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Stats {
+        uint64_t hits{0};
+        uint64_t misses{0};
+        uint64_t insertions{0};
+        uint64_t evictions{0};
+        uint64_t expirations{0};
+        uint64_t invalidations{0};
+        uint64_t staleFills{0};
+        size_t size{0};
+        size_t capacity{0};
+    };
+
+    /**
+     * @param capacity Maximum number of entries across all shards
+     * @param ttl Entry lifetime; zero disables expiry
+     * @param shardCount Number of independently locked shards (at least 1)
+     */
+    ShardedLruCache(size_t capacity, std::chrono::milliseconds ttl, size_t shardCount)
+        : ttl_(ttl), shards_(shardCount == 0 ? 1 : shardCount) {
+        const size_t n = shards_.size();
+        perShardCapacity_ = capacity == 0 ? 1 : (capacity + n - 1) / n;
+    }
+
+    ShardedLruCache(const ShardedLruCache&) = delete;
+    ShardedLruCache& operator=(const ShardedLruCache&) = delete;
+
+    /// Look up @p key, refreshing its LRU position on a hit
+    bool find(const Key& key, Value& out) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if (it == shard.index.end()) {
+            misses_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (isExpired(*it->second)) {
+            shard.lru.erase(it->second);
+            shard.index.erase(it);
+            expirations_.fetch_add(1, std::memory_order_relaxed);
+            misses_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        out = it->second->value;
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /// Token to pass to insert() for a read-through fill of @p key
+    uint64_t fillToken(const Key& key) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.generation;
+    }
+
+    /**
+     * @brief Insert the result of a read-through fill
+     * @return false if the key was invalidated since @p token was taken
+     */
+    bool insert(const Key& key, Value value, uint64_t token) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (shard.generation != token) {
+            staleFills_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        insertLocked(shard, key, std::move(value));
+        return true;
+    }
+
+    /// Insert or replace unconditionally (for values produced by the writer itself)
+    void insert(const Key& key, Value value) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        insertLocked(shard, key, std::move(value));
+    }
+
+    /// Drop @p key and fence off in-flight fills for its shard
+    void erase(const Key& key) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        ++shard.generation;
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) {
+            shard.lru.erase(it->second);
+            shard.index.erase(it);
+        }
+        invalidations_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void clear() {
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            ++shard.generation;
+            shard.index.clear();
+            shard.lru.clear();
+        }
+    }
+
+    Stats stats() const {
+        Stats s;
+        s.hits = hits_.load(std::memory_order_relaxed);
+        s.misses = misses_.load(std::memory_order_relaxed);
+        s.insertions = insertions_.load(std::memory_order_relaxed);
+        s.evictions = evictions_.load(std::memory_order_relaxed);
+        s.expirations = expirations_.load(std::memory_order_relaxed);
+        s.invalidations = invalidations_.load(std::memory_order_relaxed);
+        s.staleFills = staleFills_.load(std::memory_order_relaxed);
+        s.capacity = perShardCapacity_ * shards_.size();
+        for (const auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            s.size += shard.index.size();
+        }
+        return s;
+    }
+
+  private:
+    struct Entry {
+        Key key;
+        Value value;
+        Clock::time_point expiresAt;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::list<Entry> lru;  // most recently used first
+        std::unordered_map<Key, typename std::list<Entry>::iterator, Hash> index;
+        uint64_t generation{0};
+    };
+
+    Shard& shardFor(const Key& key) {
+        // Mix the hash so sequential integer ids do not all land in neighbouring shards
+        uint64_t h = static_cast<uint64_t>(Hash{}(key));
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return shards_[h % shards_.size()];
+    }
+
+    bool isExpired(const Entry& entry) const {
+        return ttl_.count() > 0 && Clock::now() >= entry.expiresAt;
+    }
+
+    void insertLocked(Shard& shard, const Key& key, Value&& value) {
+        const auto expiresAt = Clock::now() + ttl_;
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) {
+            it->second->value = std::move(value);
+            it->second->expiresAt = expiresAt;
+            shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+            return;
+        }
+        shard.lru.push_front(Entry{key, std::move(value), expiresAt});
+        shard.index.emplace(key, shard.lru.begin());
+        insertions_.fetch_add(1, std::memory_order_relaxed);
+        while (shard.index.size() > perShardCapacity_) {
+            shard.index.erase(shard.lru.back().key);
+            shard.lru.pop_back();
+            evictions_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    const std::chrono::milliseconds ttl_;
+    size_t perShardCapacity_;
+    std::vector<Shard> shards_;
+
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> insertions_{0};
+    std::atomic<uint64_t> evictions_{0};
+    std::atomic<uint64_t> expirations_{0};
+    std::atomic<uint64_t> invalidations_{0};
+    std::atomic<uint64_t> staleFills_{0};
+};
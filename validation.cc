@@ -1,20 +1,49 @@
 #include "validation.h"
 #include <json/json.h>
-#include <vector>
 #include <string>
+#include "models/ModelFieldRules.h"
+#include "plugins/RequestLog.h"
+#include "utils/jsonprescan.h"
+#include "utils/requestjson.h"
+#include "utils/routeclassifier.h"
+
+namespace {
+/// Product routes whose POST, PUT or PATCH carries a JSON body; the others have none to check
+bool takesJsonBody(RouteKind kind) {
+    switch (kind) {
+        case RouteKind::Collection:
+        case RouteKind::Item:
+        case RouteKind::ProductBatchGet:
+        case RouteKind::ProductBulk:
+        case RouteKind::ProductBySku:
+        case RouteKind::ProductAdjustBatch:
+        case RouteKind::ProductAdjust:
+        case RouteKind::ProductReserve:
+            return true;
+        default:
+            return false;
+    }
+}
+}  // namespace
+
+bool validateProductData(const Json::Value& json, std::string& message) {
+    return validateFields(drogon_model::sqlite3::kProductsFieldRules, json, FieldCheck::Create,
+                          message);
+}
 
 drogon::HttpResponsePtr validateProductRequest(const drogon::HttpRequestPtr& req) {
     const auto method = req->getMethod();
     const auto path = req->getPath();
     
-    if ((method == drogon::Post || method == drogon::Put) && path.find("/api/products") == 0) {
-        LOG_INFO << "Validating " << req->getMethodString() << " " << path;
-        
-        const auto bodyView = req->getBody();
-        std::string body(bodyView.data(), bodyView.size());
-        
-        if (body.empty()) {
-            LOG_INFO << "Empty request body, returning 400";
+    if (method != drogon::Post && method != drogon::Put && method != drogon::Patch) {
+        return nullptr;
+    }
+    const auto route = classifyRoute(path);
+    // Body-less writes such as a reservation commit, and unknown paths, go straight on
+    if (route.resource == ApiResource::Products && takesJsonBody(route.kind)) {
+        const auto kind = route.kind;
+        if (req->getBody().empty()) {
+            REQUEST_LOG(Warn, RequestLogEvent::Rejected, req, kind, 400, "Empty body");
             Json::Value response;
             response["error"] = true;
             response["message"] = "Request body cannot be empty";
@@ -23,10 +52,30 @@ drogon::HttpResponsePtr validateProductRequest(const drogon::HttpRequestPtr& req
             return httpResp;
         }
         
-        Json::Value json;
-        Json::Reader reader;
-        if (!reader.parse(body, json)) {
-            LOG_INFO << "Invalid JSON format, returning 400";
+        // Oversized bulk arrays are counted from the structural index and refused unparsed
+        JsonPrescan prescan;
+        const bool bulk = kind == RouteKind::ProductBulk || kind == RouteKind::ProductBySku;
+        if (bulk) {
+            JsonPrescanOptions options;
+            options.buildIndex = true;
+            if (prescanJson(req->getBody(), prescan, options) &&
+                topLevelElementCount(req->getBody(), prescan.structurals) > kMaxBulkItems) {
+                REQUEST_LOG(Warn, RequestLogEvent::Rejected, req, kind, 400, "Too many items");
+                Json::Value response;
+                response["error"] = true;
+                response["message"] =
+                    "Body must be an array of 1 to " + std::to_string(kMaxBulkItems) + " products";
+                auto httpResp = drogon::HttpResponse::newHttpJsonResponse(response);
+                httpResp->setStatusCode(drogon::k400BadRequest);
+                return httpResp;
+            }
+        }
+
+        // The one parse of this body, reusing the bulk prescan; everything after routing
+        // reads it with requestJson()
+        const auto parsed = parseRequestBody(req, bulk ? &prescan : nullptr);
+        if (!parsed) {
+            REQUEST_LOG(Warn, RequestLogEvent::Rejected, req, kind, 400, "Invalid JSON");
             Json::Value response;
             response["error"] = true;
             response["message"] = "Invalid JSON format";
@@ -37,36 +86,19 @@ drogon::HttpResponsePtr validateProductRequest(const drogon::HttpRequestPtr& req
         
         // Validate required fields for POST to /api/products
         if (method == drogon::Post && path == "/api/products") {
-            const std::vector<std::string> requiredFields = {"sku", "name", "unit_price", "quantity_in_stock", "reorder_threshold"};
-            
-            for (const auto& field : requiredFields) {
-                if (!json.isMember(field)) {
-                    LOG_INFO << "Missing required field: " << field;
-                    Json::Value response;
-                    response["error"] = true;
-                    response["message"] = "Missing required field: " + field;
-                    auto httpResp = drogon::HttpResponse::newHttpJsonResponse(response);
-                    httpResp->setStatusCode(drogon::k400BadRequest);
-                    return httpResp;
-                }
-            }
-            
-            // Validate unit_price is positive
-            if (json.isMember("unit_price") && json["unit_price"].isDouble()) {
-                double price = json["unit_price"].asDouble();
-                if (price < 0) {
-                    LOG_INFO << "Invalid negative price: " << price;
-                    Json::Value response;
-                    response["error"] = true;
-                    response["message"] = "Unit price must be a positive number";
-                    auto httpResp = drogon::HttpResponse::newHttpJsonResponse(response);
-                    httpResp->setStatusCode(drogon::k400BadRequest);
-                    return httpResp;
-                }
+            std::string message;
+            if (!validateProductData(*parsed, message)) {
+                REQUEST_LOG(Warn, RequestLogEvent::Rejected, req, kind, 400, message);
+                Json::Value response;
+                response["error"] = true;
+                response["message"] = message;
+                auto httpResp = drogon::HttpResponse::newHttpJsonResponse(response);
+                httpResp->setStatusCode(drogon::k400BadRequest);
+                return httpResp;
             }
         }
         
-        LOG_INFO << "Validation passed";
+        REQUEST_LOG(Info, RequestLogEvent::Passed, req, kind, 0);
     }
     
     return nullptr; // No error, continue processing
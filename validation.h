@@ -3,6 +3,9 @@
 
 #include <drogon/drogon.h>
 
+/// Largest array accepted by POST /api/products/bulk and PUT /api/products/by-sku
+constexpr size_t kMaxBulkItems = 10000;
+
 /**
  * Validates incoming HTTP requests for the inventory system
  * @param req The HTTP request to validate
@@ -10,4 +13,12 @@
  */
 drogon::HttpResponsePtr validateProductRequest(const drogon::HttpRequestPtr& req);
 
+/**
+ * Checks the required fields and value rules of a single product object
+ * @param json The product as sent by the client
+ * @param message Set to the reason when validation fails
+ * @return true if the product may be created
+ */
+bool validateProductData(const Json::Value& json, std::string& message);
+
 #endif // VALIDATION_H
\ No newline at end of file